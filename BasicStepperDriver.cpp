@@ -193,18 +193,19 @@ void BasicStepperDriver::stop(void){
 /*
  * Return calculated time to complete the given move
  */
-long BasicStepperDriver::getTimeForMove(long steps){
-    long t;
+uint64_t BasicStepperDriver::getTimeForMove(long steps){
+    uint64_t t;
     switch (profile.mode){
         case LINEAR_SPEED:
             startMove(steps);
-            t = sqrt(2 * steps_to_cruise / profile.accel) + 
-                (steps_remaining - steps_to_cruise - steps_to_brake) * STEP_PULSE(rpm, motor_steps, microsteps) +
-                sqrt(2 * steps_to_brake / profile.decel);
+            // accel and decel are given in full steps/s^2, the ramps in microsteps
+            t = (uint64_t)((1e+6) * (sqrt(2.0 * steps_to_cruise / microsteps / profile.accel) +
+                                     sqrt(2.0 * steps_to_brake / microsteps / profile.decel))) +
+                (uint64_t)(steps_remaining - steps_to_cruise - steps_to_brake) * STEP_PULSE(rpm, motor_steps, microsteps);
             break;
         case CONSTANT_SPEED:
         default:
-            t = STEP_PULSE(rpm, motor_steps, microsteps);
+            t = (uint64_t)abs(steps) * STEP_PULSE(rpm, motor_steps, microsteps);
     }
     return t;
 }
@@ -275,7 +276,7 @@ long BasicStepperDriver::nextAction(void){
         };
         digitalWrite(step_pin, LOW);
         // account for calcStepPulse() execution time; sets ceiling for max rpm on slower MCUs
-        last_action_end = micros();
+        last_action_end = Monotonic.Micros();
         next_action_interval = (pulse > m) ? pulse - m : 1;
     } else {
         // end of move
@@ -10,6 +10,7 @@
 #ifndef STEPPER_DRIVER_BASE_H
 #define STEPPER_DRIVER_BASE_H
 #include <Arduino.h>
+#include "MonotonicClock.h"
 
 // used internally by the library to mark unconnected pins
 #define PIN_UNCONNECTED -1
@@ -37,23 +38,25 @@ public:
         short accel = 1000;     // acceleration [steps/s^2]
         short decel = 1000;     // deceleration [steps/s^2]    
     };
-    static inline void delayMicros(unsigned long delay_us, unsigned long start_us = 0){
+    /*
+     * Times are taken from the 64-bit Monotonic clock, so a start time never wraps around
+     */
+    static inline void delayMicros(unsigned long delay_us, uint64_t start_us = 0){
         if (delay_us){
             if (!start_us){
-                start_us = micros();
+                start_us = Monotonic.Micros();
             }
             if (delay_us > MIN_YIELD_MICROS){
                 yield();
             }
-            // See https://www.gammon.com.au/millis
-            while (micros() - start_us < delay_us);
+            while (Monotonic.Micros() - start_us < delay_us);
         }
     }
 
 private:
     // calculation remainder to be fed into successive steps to increase accuracy (Atmel DOC8017)
     long rest;
-    unsigned long last_action_end = 0;
+    uint64_t last_action_end = 0;
     unsigned long next_action_interval = 0;
 
 protected:
@@ -87,7 +90,7 @@ protected:
     struct Profile profile;
 
     long step_count;        // current position
-    long steps_remaining;   // to complete the current move (absolute value)
+    long steps_remaining = 0;   // to complete the current move (absolute value), startMove() alters a running move if not 0
     long steps_to_cruise;   // steps to reach cruising (max) rpm
     long steps_to_brake;    // steps needed to come to a full stop
     long step_pulse;        // step pulse duration (microseconds)
@@ -206,9 +209,9 @@ public:
     enum State getCurrentState(void);
 
     /*
-     * Return calculated time to complete the given move
+     * Return calculated time to complete the given move (micros), 64-bit so day long moves fit
      */
-    long getTimeForMove(long steps);
+    uint64_t getTimeForMove(long steps);
     /*
      * Calculate steps needed to rotate requested angle, given in degrees
      */
@@ -0,0 +1,74 @@
+//
+//  CaliberPresets.cpp - Turns per day and turning direction of common calibers, kept in flash.
+//  License: MIT
+//
+
+#include "CaliberPresets.h"
+
+constexpr uint8_t CaliberSlot(uint32_t hash)
+{
+    return (uint8_t)((hash ^ (hash >> 16)) & (CALIBER_SLOTS - 1));
+}
+
+#define CALIBER_ENTRY(id, name, turns_per_day, turning_direction) { name, turns_per_day, turning_direction },
+
+// Every case label is a compile-time constant, a seed giving two names the same slot does not compile
+#define CALIBER_CASE(id, name, turns_per_day, turning_direction) \
+    case CaliberSlot(Fnv1a(name, CALIBER_SEED)):                 \
+        found = CALIBER_##id;                                    \
+        break;
+
+static const CaliberPreset kCaliberPresets[CALIBER_COUNT] PROGMEM =
+{
+    CALIBER_PRESETS(CALIBER_ENTRY)
+};
+
+// The hash of the name picks the only preset it can be, one name comparison in flash confirms it.
+// Returns the CaliberId or -1 if the name is not a preset, names are case sensitive.
+int FindCaliberPreset(const char* name)
+{
+    int found;
+    switch (CaliberSlot(Fnv1a(name, strlen(name), CALIBER_SEED)))
+    {
+        CALIBER_PRESETS(CALIBER_CASE)
+    default:
+        return -1;
+    }
+    return (strncmp_P(name, kCaliberPresets[found].name, sizeof(kCaliberPresets[found].name)) == 0) ? found : -1;
+}
+
+// Copies only the one preset out of flash
+void ReadCaliberPreset(uint8_t id, CaliberPreset& preset)
+{
+    memcpy_P(&preset, &kCaliberPresets[id], sizeof(preset));
+}
+
+// Case insensitive prefix match, compared in flash
+bool MatchCaliberPreset(uint8_t id, const char* prefix)
+{
+    const char* name = kCaliberPresets[id].name;
+    for (size_t idx = 0; prefix[idx] != '\0'; idx++)
+    {
+        char c = (char)pgm_read_byte(name + idx);
+        if (c == '\0' || tolower((unsigned char)c) != tolower((unsigned char)prefix[idx]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sets turns per day and direction of the preset, the name of the watch is kept
+bool ApplyCaliberPreset(const char* name, WatchRequirement& requirement)
+{
+    int id = FindCaliberPreset(name);
+    if (id < 0)
+    {
+        return false;
+    }
+    CaliberPreset preset;
+    ReadCaliberPreset(id, preset);
+    requirement.SetRevolutionsPerDay(preset.turns_per_day);
+    requirement.SetTurningDirection((TurningDirection)preset.turning_direction);
+    return true;
+}
@@ -0,0 +1,66 @@
+//
+//  CaliberPresets.h - Turns per day and turning direction of common calibers, kept in flash.
+//  License: MIT
+//
+#ifndef CALIBERPRESETS_H
+#define CALIBERPRESETS_H
+
+#include <Arduino.h>
+
+#include "Fnv1a.h"
+#include "WatchRequirement.h"
+
+#define CALIBER_SLOTS 64             // size of the lookup switch in FindCaliberPreset(), power of two
+#define CALIBER_SEED  0x811C9E43UL   // FNV-1a seed for which no two caliber names share a slot
+#define WATCH_DEFAULT_TURNS_PER_DAY 720  // for watches of unknown caliber, seems to be a good value according to http://people.timezone.com/msandler/Articles/ArnsteinWinder/Winder2.html
+#define WATCH_MAX_TURNS_PER_DAY     1440 // one turn per minute, as on the watches page
+
+// X(id, name, turns per day, turning direction) - typical values as published by winder makers,
+// the manual of the watch takes precedence. A new name may need a new CALIBER_SEED.
+#define CALIBER_PRESETS(X)                                               \
+    X(ETA_2824_2,       "ETA 2824-2",       650, BOTHDIRECTIONS)         \
+    X(ETA_2836_2,       "ETA 2836-2",       650, BOTHDIRECTIONS)         \
+    X(ETA_2892_A2,      "ETA 2892-A2",      650, BOTHDIRECTIONS)         \
+    X(ETA_2893_2,       "ETA 2893-2",       650, BOTHDIRECTIONS)         \
+    X(ETA_7750,         "ETA 7750",         800, CLOCKWISEONLY)          \
+    X(ETA_7753,         "ETA 7753",         800, CLOCKWISEONLY)          \
+    X(SELLITA_SW200_1,  "Sellita SW200-1",  650, BOTHDIRECTIONS)         \
+    X(SELLITA_SW220_1,  "Sellita SW220-1",  650, BOTHDIRECTIONS)         \
+    X(SELLITA_SW300_1,  "Sellita SW300-1",  650, BOTHDIRECTIONS)         \
+    X(SELLITA_SW500,    "Sellita SW500",    800, CLOCKWISEONLY)          \
+    X(ROLEX_3035,       "Rolex 3035",       650, BOTHDIRECTIONS)         \
+    X(ROLEX_3135,       "Rolex 3135",       650, BOTHDIRECTIONS)         \
+    X(ROLEX_3186,       "Rolex 3186",       650, BOTHDIRECTIONS)         \
+    X(ROLEX_3235,       "Rolex 3235",       650, BOTHDIRECTIONS)         \
+    X(ROLEX_4130,       "Rolex 4130",       650, BOTHDIRECTIONS)         \
+    X(OMEGA_1120,       "Omega 1120",       650, BOTHDIRECTIONS)         \
+    X(OMEGA_2500,       "Omega 2500",       650, BOTHDIRECTIONS)         \
+    X(OMEGA_8500,       "Omega 8500",       800, BOTHDIRECTIONS)         \
+    X(OMEGA_8900,       "Omega 8900",       800, BOTHDIRECTIONS)         \
+    X(SEIKO_7S26,       "Seiko 7S26",       650, BOTHDIRECTIONS)         \
+    X(SEIKO_4R36,       "Seiko 4R36",       650, BOTHDIRECTIONS)         \
+    X(SEIKO_6R15,       "Seiko 6R15",       650, BOTHDIRECTIONS)         \
+    X(SEIKO_NH35,       "Seiko NH35",       650, BOTHDIRECTIONS)         \
+    X(SEIKO_NH36,       "Seiko NH36",       650, BOTHDIRECTIONS)
+
+#define CALIBER_ID(id, name, turns_per_day, turning_direction) CALIBER_##id,
+
+enum CaliberId
+{
+    CALIBER_PRESETS(CALIBER_ID)
+    CALIBER_COUNT
+};
+
+struct CaliberPreset
+{
+    char name[WATCH_NAME_MAX_LEN + 1];
+    uint16_t turns_per_day;
+    uint8_t turning_direction;     // TurningDirection
+};
+
+int FindCaliberPreset(const char* name);
+void ReadCaliberPreset(uint8_t id, CaliberPreset& preset);
+bool MatchCaliberPreset(uint8_t id, const char* prefix);
+bool ApplyCaliberPreset(const char* name, WatchRequirement& requirement);
+
+#endif // #ifndef CALIBERPRESETS_H
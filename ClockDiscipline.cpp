@@ -0,0 +1,227 @@
+//
+//  ClockDiscipline.cpp - Drift compensated, slewed millisecond clock.
+//  License: MIT
+//
+
+#include "ClockDiscipline.h"
+
+ClockDiscipline SystemClock;
+
+ClockDiscipline::ClockDiscipline()
+    : is_set_(false),
+      is_provisional_(false),
+      raw_millis_(0),
+      epoch_millis_(0),
+      drift_ppb_(0),
+      drift_residue_(0),
+      pending_offset_ms_(0),
+      slew_credit_(0),
+      anchor_reference_millis_(0),
+      anchor_raw_millis_(0),
+      error_ms_(0),
+      error_raw_millis_(0),
+      last_offset_ms_(0),
+      poll_interval_(CLOCK_UNSYNCED_POLL_INTERVAL),
+      next_poll_raw_millis_(0)
+{
+}
+
+// Makes this clock the sync provider of the Time library. The Time library then
+// takes its whole seconds from here once per second instead of counting millis() itself.
+void ClockDiscipline::Begin()
+{
+    setSyncInterval(1);
+    setSyncProvider(SyncProvider);
+}
+
+bool ClockDiscipline::IsSet()
+{
+    return is_set_;
+}
+
+bool ClockDiscipline::IsProvisional()
+{
+    return is_provisional_;
+}
+
+// Starts the clock from a persisted time, e.g. across a reset, until the first reference arrives
+void ClockDiscipline::SetProvisional(uint64_t epoch_millis, uint32_t error_ms)
+{
+    Advance();
+    epoch_millis_ = epoch_millis;
+    pending_offset_ms_ = 0;
+    error_ms_ = error_ms;
+    error_raw_millis_ = raw_millis_;
+    is_set_ = true;
+    is_provisional_ = true;
+}
+
+// Maximum difference to the reference, grows with the time since the last reference
+uint32_t ClockDiscipline::GetErrorBoundMillis()
+{
+    Advance();
+    return error_ms_ + (uint32_t)((raw_millis_ - error_raw_millis_) * CLOCK_ERROR_GROWTH_PPM / 1000000UL);
+}
+
+uint64_t ClockDiscipline::NowMillis()
+{
+    Advance();
+    return epoch_millis_;
+}
+
+time_t ClockDiscipline::Now()
+{
+    return (time_t)(NowMillis() / 1000);
+}
+
+void ClockDiscipline::Advance()
+{
+    uint64_t current_millis = Monotonic.Millis();
+    uint32_t elapsed = (uint32_t)(current_millis - raw_millis_);
+    if (elapsed == 0)
+    {
+        return;
+    }
+    raw_millis_ = current_millis;
+
+    // Frequency correction, the sub-millisecond remainder is carried over to the next call
+    int64_t scaled = (int64_t)elapsed * drift_ppb_ + drift_residue_;
+    int64_t correction = scaled / 1000000000LL;
+    drift_residue_ = scaled - correction * 1000000000LL;
+
+    // Slew the pending offset at no more than CLOCK_MAX_SLEW_PPM, so the clock never jumps or runs backwards
+    int32_t slew = 0;
+    if (pending_offset_ms_ != 0)
+    {
+        slew_credit_ += (uint64_t)elapsed * CLOCK_MAX_SLEW_PPM;
+        uint32_t magnitude = pending_offset_ms_ > 0 ? pending_offset_ms_ : -pending_offset_ms_;
+        uint64_t allowed = slew_credit_ / 1000000UL;
+        if (allowed > magnitude)
+        {
+            allowed = magnitude;
+        }
+        slew_credit_ -= allowed * 1000000UL;
+        slew = pending_offset_ms_ > 0 ? (int32_t)allowed : -(int32_t)allowed;
+        pending_offset_ms_ -= slew;
+    }
+    else
+    {
+        slew_credit_ = 0;
+    }
+
+    epoch_millis_ += (int64_t)elapsed + correction + slew;
+}
+
+// Feeds one reference time (milliseconds since 1 jan 1970) into the clock and schedules the next poll
+void ClockDiscipline::Discipline(uint64_t reference_millis, uint32_t error_ms)
+{
+    Advance();
+    Correct(reference_millis);
+    error_ms_ = error_ms + (uint32_t)(pending_offset_ms_ > 0 ? pending_offset_ms_ : -pending_offset_ms_);
+    error_raw_millis_ = raw_millis_;
+    next_poll_raw_millis_ = raw_millis_ + 1000UL * poll_interval_;
+}
+
+// Sets the clock to the reference and starts a new drift baseline
+void ClockDiscipline::Restart(uint64_t reference_millis)
+{
+    epoch_millis_ = reference_millis;
+    pending_offset_ms_ = 0;
+    anchor_reference_millis_ = reference_millis;
+    anchor_raw_millis_ = raw_millis_;
+    poll_interval_ = CLOCK_MIN_POLL_INTERVAL;
+    is_set_ = true;
+}
+
+void ClockDiscipline::Correct(uint64_t reference_millis)
+{
+    if (!is_set_)
+    {
+        Restart(reference_millis);
+        last_offset_ms_ = 0;
+        return;
+    }
+
+    int64_t offset = (int64_t)(reference_millis - epoch_millis_);
+    last_offset_ms_ = (int32_t)(offset > INT32_MAX ? INT32_MAX : (offset < INT32_MIN ? INT32_MIN : offset));
+    if (offset > CLOCK_STEP_THRESHOLD_MS || offset < -CLOCK_STEP_THRESHOLD_MS)
+    {
+        // Too far off to slew in reasonable time
+        Restart(reference_millis);
+        is_provisional_ = false;
+        return;
+    }
+    if (is_provisional_)
+    {
+        // Close enough to slew, but the persisted time is no base for a drift estimate
+        anchor_reference_millis_ = reference_millis;
+        anchor_raw_millis_ = raw_millis_;
+        poll_interval_ = CLOCK_MIN_POLL_INTERVAL;
+        pending_offset_ms_ = (int32_t)offset;
+        is_provisional_ = false;
+        return;
+    }
+
+    pending_offset_ms_ = (int32_t)offset;
+
+    // Drift of the crystal against the reference over the whole baseline, the longer the
+    // baseline the less the jitter of a single measurement matters
+    uint64_t baseline = raw_millis_ - anchor_raw_millis_;
+    bool drift_known = false;
+    if (baseline >= CLOCK_MIN_DRIFT_BASELINE_MS)
+    {
+        int64_t reference_elapsed = (int64_t)(reference_millis - anchor_reference_millis_);
+        int64_t drift = (reference_elapsed - (int64_t)baseline) * 1000000000LL / (int64_t)baseline;
+        if (drift <= CLOCK_MAX_DRIFT_PPB && drift >= -CLOCK_MAX_DRIFT_PPB)
+        {
+            drift_ppb_ = (int32_t)drift;
+            drift_known = true;
+        }
+    }
+
+    // Poll less often while the clock keeps up with the reference
+    if (drift_known && offset < CLOCK_STABLE_OFFSET_MS && offset > -CLOCK_STABLE_OFFSET_MS)
+    {
+        poll_interval_ = min(poll_interval_ * 2, (uint32_t)CLOCK_MAX_POLL_INTERVAL);
+    }
+    else if (offset >= CLOCK_STABLE_OFFSET_MS || offset <= -CLOCK_STABLE_OFFSET_MS)
+    {
+        poll_interval_ = max(poll_interval_ / 2, (uint32_t)CLOCK_MIN_POLL_INTERVAL);
+    }
+}
+
+// True once the reference should be asked again
+bool ClockDiscipline::IsPollDue()
+{
+    Advance();
+    return raw_millis_ >= next_poll_raw_millis_;
+}
+
+// No reference could be reached, try again after a short while
+void ClockDiscipline::PollFailed()
+{
+    Advance();
+    bool confirmed = is_set_ && !is_provisional_;
+    next_poll_raw_millis_ = raw_millis_ + 1000UL * (confirmed ? CLOCK_MIN_POLL_INTERVAL : CLOCK_UNSYNCED_POLL_INTERVAL);
+}
+
+// Sync provider of the Time library, called about once per second from now()
+time_t ClockDiscipline::SyncProvider()
+{
+    return SystemClock.IsSet() ? SystemClock.Now() : 0;
+}
+
+int32_t ClockDiscipline::GetDriftPPB()
+{
+    return drift_ppb_;
+}
+
+int32_t ClockDiscipline::GetLastOffsetMillis()
+{
+    return last_offset_ms_;
+}
+
+uint32_t ClockDiscipline::GetPollInterval()
+{
+    return poll_interval_;
+}
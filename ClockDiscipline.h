@@ -0,0 +1,71 @@
+//
+//  ClockDiscipline.h - Drift compensated, slewed millisecond clock.
+//  License: MIT
+//
+#ifndef CLOCKDISCIPLINE_H
+#define CLOCKDISCIPLINE_H
+
+#include <Arduino.h>
+#include "TimeLib.h"
+#include "MonotonicClock.h"
+
+#define CLOCK_STEP_THRESHOLD_MS     2000      // larger offsets are stepped, smaller ones are slewed
+#define CLOCK_MAX_SLEW_PPM          500       // maximum slew rate, 0.5 ms per second
+#define CLOCK_MAX_DRIFT_PPB         500000L   // crystal drift estimates beyond this are ignored
+#define CLOCK_MIN_DRIFT_BASELINE_MS 3600000UL // measure drift over at least one hour of raw elapsed time
+#define CLOCK_MIN_POLL_INTERVAL     300       // seconds, the former fixed polling interval
+#define CLOCK_MAX_POLL_INTERVAL     14400     // seconds
+#define CLOCK_UNSYNCED_POLL_INTERVAL 5        // seconds, used until the clock has been set once
+#define CLOCK_STABLE_OFFSET_MS      250       // offsets below this lengthen the polling interval
+#define CLOCK_ERROR_GROWTH_PPM      100       // assumed worst case frequency error for the error bound
+
+class ClockDiscipline
+{
+public:
+    ClockDiscipline();
+
+    void Begin();
+    bool IsSet();
+    uint64_t NowMillis();
+    time_t Now();
+    void Discipline(uint64_t reference_millis, uint32_t error_ms = 0);
+    void SetProvisional(uint64_t epoch_millis, uint32_t error_ms);
+    bool IsProvisional();
+    uint32_t GetErrorBoundMillis();
+    bool IsPollDue();
+    void PollFailed();
+
+    int32_t GetDriftPPB();
+    int32_t GetLastOffsetMillis();
+    uint32_t GetPollInterval();
+
+private:
+    void Advance();
+    void Correct(uint64_t reference_millis);
+    void Restart(uint64_t reference_millis);
+    static time_t SyncProvider();
+
+    bool is_set_;
+    bool is_provisional_;          // set from a persisted time, not yet confirmed by a reference
+    uint64_t raw_millis_;          // uncorrected milliseconds since boot at the last Advance(), Monotonic.Millis()
+    uint64_t epoch_millis_;        // disciplined time in milliseconds since 1 jan 1970
+
+    int32_t drift_ppb_;            // frequency correction applied to the crystal
+    int64_t drift_residue_;        // sub-millisecond remainder of the frequency correction
+    int32_t pending_offset_ms_;    // offset still to be slewed
+    uint64_t slew_credit_;         // slew allowance in milliseconds * 1e6
+
+    uint64_t anchor_reference_millis_; // reference time at the start of the drift baseline
+    uint64_t anchor_raw_millis_;       // raw time at the start of the drift baseline
+
+    uint32_t error_ms_;                // error bound at error_raw_millis_
+    uint64_t error_raw_millis_;
+
+    int32_t last_offset_ms_;
+    uint32_t poll_interval_;       // seconds
+    uint64_t next_poll_raw_millis_;
+};
+
+extern ClockDiscipline SystemClock;
+
+#endif // #ifndef CLOCKDISCIPLINE_H
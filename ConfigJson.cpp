@@ -0,0 +1,310 @@
+//
+//  ConfigJson.cpp - Bounded streaming reader and writer for the flat JSON object of the WiFi configuration.
+//  License: MIT
+//
+
+#include "ConfigJson.h"
+
+static bool IsWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+ConfigReader::ConfigReader(ConfigField* fields, uint8_t field_count)
+    : fields_(fields),
+      field_count_(field_count),
+      state_(EXPECT_OBJECT),
+      escaped_(false),
+      key_length_(0),
+      key_overflow_(false),
+      value_length_(0),
+      value_overflow_(false)
+{
+    key_[0] = '\0';
+    value_[0] = '\0';
+}
+
+void ConfigReader::Feed(const char* data, size_t length)
+{
+    for (size_t idx = 0; idx < length && state_ != SYNTAX_ERROR; idx++)
+    {
+        Consume(data[idx]);
+    }
+}
+
+bool ConfigReader::IsComplete()
+{
+    return state_ == COMPLETE;
+}
+
+bool ConfigReader::HasError()
+{
+    return state_ == SYNTAX_ERROR;
+}
+
+void ConfigReader::Consume(char c)
+{
+    switch (state_)
+    {
+    case EXPECT_OBJECT:
+        if (c == '{')
+        {
+            state_ = EXPECT_KEY;
+        }
+        else if (!IsWhitespace(c))
+        {
+            state_ = SYNTAX_ERROR;
+        }
+        break;
+
+    case EXPECT_KEY:
+        if (c == '"')
+        {
+            key_length_ = 0;
+            key_[0] = '\0';
+            key_overflow_ = false;
+            state_ = IN_KEY;
+        }
+        else if (c == '}')
+        {
+            state_ = COMPLETE;
+        }
+        else if (!IsWhitespace(c))
+        {
+            state_ = SYNTAX_ERROR;
+        }
+        break;
+
+    case IN_KEY:
+        if (escaped_)
+        {
+            escaped_ = false;
+            Append(key_, key_length_, CONFIG_JSON_MAX_KEY_LEN, key_overflow_, c);
+        }
+        else if (c == '\\')
+        {
+            escaped_ = true;
+        }
+        else if (c == '"')
+        {
+            state_ = EXPECT_COLON;
+        }
+        else
+        {
+            Append(key_, key_length_, CONFIG_JSON_MAX_KEY_LEN, key_overflow_, c);
+        }
+        break;
+
+    case EXPECT_COLON:
+        if (c == ':')
+        {
+            state_ = EXPECT_VALUE;
+        }
+        else if (!IsWhitespace(c))
+        {
+            state_ = SYNTAX_ERROR;
+        }
+        break;
+
+    case EXPECT_VALUE:
+        if (c == '"')
+        {
+            value_length_ = 0;
+            value_[0] = '\0';
+            value_overflow_ = false;
+            state_ = IN_VALUE;
+        }
+        else if (c == '{' || c == '[' || c == ',' || c == '}')
+        {
+            state_ = SYNTAX_ERROR;
+        }
+        else if (!IsWhitespace(c))
+        {
+            state_ = IN_LITERAL; // number, true, false or null
+        }
+        break;
+
+    case IN_VALUE:
+        if (escaped_)
+        {
+            escaped_ = false;
+            switch (c)
+            {
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'u': value_overflow_ = true; break; // no unicode escapes in these fields, the hex digits follow as text
+            default: break;
+            }
+            Append(value_, value_length_, CONFIG_JSON_MAX_VALUE_LEN, value_overflow_, c);
+        }
+        else if (c == '\\')
+        {
+            escaped_ = true;
+        }
+        else if (c == '"')
+        {
+            TakeValue();
+            state_ = EXPECT_NEXT;
+        }
+        else
+        {
+            Append(value_, value_length_, CONFIG_JSON_MAX_VALUE_LEN, value_overflow_, c);
+        }
+        break;
+
+    case IN_LITERAL:
+        if (c == ',')
+        {
+            state_ = EXPECT_KEY;
+        }
+        else if (c == '}')
+        {
+            state_ = COMPLETE;
+        }
+        else if (IsWhitespace(c))
+        {
+            state_ = EXPECT_NEXT;
+        }
+        break;
+
+    case EXPECT_NEXT:
+        if (c == ',')
+        {
+            state_ = EXPECT_KEY;
+        }
+        else if (c == '}')
+        {
+            state_ = COMPLETE;
+        }
+        else if (!IsWhitespace(c))
+        {
+            state_ = SYNTAX_ERROR;
+        }
+        break;
+
+    case COMPLETE:
+        if (!IsWhitespace(c))
+        {
+            state_ = SYNTAX_ERROR;
+        }
+        break;
+
+    case SYNTAX_ERROR:
+        break;
+    }
+}
+
+void ConfigReader::Append(char* text, uint8_t& length, uint8_t max_length, bool& overflow, char c)
+{
+    if (length < max_length)
+    {
+        text[length++] = c;
+        text[length] = '\0';
+    }
+    else
+    {
+        overflow = true;
+    }
+}
+
+// Values that do not fit into their field are dropped instead of truncated
+void ConfigReader::TakeValue()
+{
+    if (key_overflow_ || value_overflow_)
+    {
+        return;
+    }
+    for (uint8_t idx = 0; idx < field_count_; idx++)
+    {
+        if (strcmp(fields_[idx].name, key_) == 0 && value_length_ < fields_[idx].size)
+        {
+            memcpy(fields_[idx].value, value_, value_length_ + 1);
+        }
+    }
+}
+
+ConfigWriter::ConfigWriter(Print& out)
+    : out_(out),
+      first_(true)
+{
+}
+
+void ConfigWriter::Add(const char* name, const char* value)
+{
+    out_.print(first_ ? '{' : ',');
+    first_ = false;
+    WriteJsonString(out_, name);
+    out_.print(':');
+    WriteJsonString(out_, value);
+}
+
+void ConfigWriter::End()
+{
+    if (first_)
+    {
+        out_.print('{');
+    }
+    out_.print('}');
+}
+
+void WriteJsonString(Print& out, const char* text)
+{
+    out.print('"');
+    for (const char* p = text; *p != '\0'; p++)
+    {
+        switch (*p)
+        {
+        case '"':  out.print("\\\""); break;
+        case '\\': out.print("\\\\"); break;
+        case '\n': out.print("\\n"); break;
+        case '\r': out.print("\\r"); break;
+        case '\t': out.print("\\t"); break;
+        default:
+            if ((uint8_t)*p < 0x20)
+            {
+                out.printf("\\u%04x", (uint8_t)*p);
+            }
+            else
+            {
+                out.print(*p);
+            }
+            break;
+        }
+    }
+    out.print('"');
+}
+
+ConfigBuffer::ConfigBuffer()
+    : length_(0),
+      overflow_(false)
+{
+}
+
+size_t ConfigBuffer::write(uint8_t c)
+{
+    if (length_ >= sizeof(data_))
+    {
+        overflow_ = true;
+        return 0;
+    }
+    data_[length_++] = (char)c;
+    return 1;
+}
+
+const char* ConfigBuffer::GetData()
+{
+    return data_;
+}
+
+size_t ConfigBuffer::GetLength()
+{
+    return length_;
+}
+
+bool ConfigBuffer::HasOverflow()
+{
+    return overflow_;
+}
@@ -0,0 +1,99 @@
+//
+//  ConfigJson.h - Bounded streaming reader and writer for the flat JSON object of the WiFi configuration.
+//  License: MIT
+//
+#ifndef CONFIGJSON_H
+#define CONFIGJSON_H
+
+#include <Arduino.h>
+
+#define CONFIG_JSON_MAX_KEY_LEN    15
+#define CONFIG_JSON_MAX_VALUE_LEN  63
+#define CONFIG_JSON_CHUNK          32   // bytes read from the source per Feed(), a multiple of 4 for LogStore::Read()
+#define CONFIG_JSON_MAX_SIZE       256  // bytes of a written configuration
+
+// A string member of the object, copied to value if it fits into size bytes including the terminator
+struct ConfigField
+{
+    const char* name;
+    char* value;
+    size_t size;
+};
+
+// Push parser, the source is fed in chunks of any size. Only string values are taken, other
+// values and unknown keys are skipped. Nested objects and arrays are a syntax error.
+class ConfigReader
+{
+public:
+    ConfigReader(ConfigField* fields, uint8_t field_count);
+
+    void Feed(const char* data, size_t length);
+    bool IsComplete();
+    bool HasError();
+
+private:
+    enum State
+    {
+        EXPECT_OBJECT,
+        EXPECT_KEY,
+        IN_KEY,
+        EXPECT_COLON,
+        EXPECT_VALUE,
+        IN_VALUE,
+        IN_LITERAL,
+        EXPECT_NEXT,
+        COMPLETE,
+        SYNTAX_ERROR
+    };
+
+    void Consume(char c);
+    void Append(char* text, uint8_t& length, uint8_t max_length, bool& overflow, char c);
+    void TakeValue();
+
+    ConfigField* fields_;
+    uint8_t field_count_;
+    State state_;
+    bool escaped_;
+    char key_[CONFIG_JSON_MAX_KEY_LEN + 1];
+    uint8_t key_length_;
+    bool key_overflow_;
+    char value_[CONFIG_JSON_MAX_VALUE_LEN + 1];
+    uint8_t value_length_;
+    bool value_overflow_;     // too long or not representable, the field keeps its value
+};
+
+// Writes members as they are added, nothing is assembled in memory
+class ConfigWriter
+{
+public:
+    ConfigWriter(Print& out);
+
+    void Add(const char* name, const char* value);
+    void End();
+
+private:
+    Print& out_;
+    bool first_;
+};
+
+// Writes text as a quoted JSON string with the needed escapes
+void WriteJsonString(Print& out, const char* text);
+
+// Fixed buffer to write a configuration into, excess bytes are dropped and flagged
+class ConfigBuffer : public Print
+{
+public:
+    ConfigBuffer();
+
+    size_t write(uint8_t c) override;
+    const char* GetData();
+    size_t GetLength();
+    bool HasOverflow();
+
+private:
+    char data_[CONFIG_JSON_MAX_SIZE];
+    size_t length_;
+    bool overflow_;
+};
+
+#endif // #ifndef CONFIGJSON_H
@@ -0,0 +1,27 @@
+//
+//  Crc32.cpp - CRC-32 (IEEE 802.3) for checking persisted records.
+//  License: MIT
+//
+
+#include "Crc32.h"
+
+// One entry per nibble keeps the table at 64 bytes
+static const uint32_t kcrc32_nibble_table[16] =
+{
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+uint32_t Crc32(const void* data, size_t length, uint32_t crc)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = kcrc32_nibble_table[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+        crc = kcrc32_nibble_table[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
@@ -0,0 +1,14 @@
+//
+//  Crc32.h - CRC-32 (IEEE 802.3) for checking persisted records.
+//  License: MIT
+//
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Pass the result of a previous call as crc to continue over several buffers
+uint32_t Crc32(const void* data, size_t length, uint32_t crc = 0);
+
+#endif // #ifndef CRC32_H
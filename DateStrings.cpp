@@ -22,8 +22,7 @@
 #include <string.h> // for strcpy_P or strcpy
 #include "TimeLib.h"
  
-// the short strings for each day or month must be exactly dt_SHORT_STR_LEN
-#define dt_SHORT_STR_LEN  3 // the length of short strings
+// the short strings for each day or month must be exactly dt_SHORT_STR_LEN (see TimeLib.h)
 
 static char buffer[dt_MAX_STRING_LEN+1];  // must be big enough for longest string and the terminating null
 
@@ -67,31 +66,61 @@ const char dayShortNames_P[] PROGMEM = "ErrSunMonTueWedThuFriSat";
 
 /* functions to return date strings */
 
+const char* monthStr_P(uint8_t month)
+{
+    return (PGM_P)pgm_read_word(&(monthNames_P[month]));
+}
+
+const char* dayStr_P(uint8_t day)
+{
+    return (PGM_P)pgm_read_word(&(dayNames_P[day]));
+}
+
+char* monthStr(uint8_t month, char* buf)
+{
+    strcpy_P(buf, monthStr_P(month));
+    return buf;
+}
+
+char* monthShortStr(uint8_t month, char* buf)
+{
+   for (int i=0; i < dt_SHORT_STR_LEN; i++)      
+      buf[i] = pgm_read_byte(&(monthShortNames_P[i+ (month*dt_SHORT_STR_LEN)]));  
+   buf[dt_SHORT_STR_LEN] = 0;
+   return buf;
+}
+
+char* dayStr(uint8_t day, char* buf) 
+{
+   strcpy_P(buf, dayStr_P(day));
+   return buf;
+}
+
+char* dayShortStr(uint8_t day, char* buf) 
+{
+   uint8_t index = day*dt_SHORT_STR_LEN;
+   for (int i=0; i < dt_SHORT_STR_LEN; i++)      
+      buf[i] = pgm_read_byte(&(dayShortNames_P[index + i]));  
+   buf[dt_SHORT_STR_LEN] = 0; 
+   return buf;
+}
+
 char* monthStr(uint8_t month)
 {
-    strcpy_P(buffer, (PGM_P)pgm_read_word(&(monthNames_P[month])));
-    return buffer;
+    return monthStr(month, buffer);
 }
 
 char* monthShortStr(uint8_t month)
 {
-   for (int i=0; i < dt_SHORT_STR_LEN; i++)      
-      buffer[i] = pgm_read_byte(&(monthShortNames_P[i+ (month*dt_SHORT_STR_LEN)]));  
-   buffer[dt_SHORT_STR_LEN] = 0;
-   return buffer;
+   return monthShortStr(month, buffer);
 }
 
 char* dayStr(uint8_t day) 
 {
-   strcpy_P(buffer, (PGM_P)pgm_read_word(&(dayNames_P[day])));
-   return buffer;
+   return dayStr(day, buffer);
 }
 
 char* dayShortStr(uint8_t day) 
 {
-   uint8_t index = day*dt_SHORT_STR_LEN;
-   for (int i=0; i < dt_SHORT_STR_LEN; i++)      
-      buffer[i] = pgm_read_byte(&(dayShortNames_P[index + i]));  
-   buffer[dt_SHORT_STR_LEN] = 0; 
-   return buffer;
+   return dayShortStr(day, buffer);
 }
@@ -0,0 +1,30 @@
+//
+//  Fnv1a.h - FNV-1a hashing usable at compile time.
+//  License: MIT
+//
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FNV1A_OFFSET_BASIS 2166136261UL
+#define FNV1A_PRIME        16777619UL
+
+// Written as a single return statement so it stays a C++11 constexpr (e.g. for case labels)
+constexpr uint32_t Fnv1a(const char* str, uint32_t hash = FNV1A_OFFSET_BASIS)
+{
+    return (*str == '\0') ? hash : Fnv1a(str + 1, (uint32_t)((hash ^ (uint8_t)*str) * FNV1A_PRIME));
+}
+
+// Run-time variant for buffers that are not null-terminated
+inline uint32_t Fnv1a(const char* data, size_t length, uint32_t hash)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (uint32_t)((hash ^ (uint8_t)data[i]) * FNV1A_PRIME);
+    }
+    return hash;
+}
+
+#endif // #ifndef FNV1A_H
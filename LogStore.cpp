@@ -0,0 +1,436 @@
+//
+//  LogStore.cpp - Wear leveled key/record store, appended to a ring of reserved flash sectors.
+//  License: MIT
+//
+
+#include "LogStore.h"
+
+extern "C" uint32_t _SPIFFS_start;
+
+LogStore FlashLog;
+
+static uint32_t RecordSize(uint16_t length)
+{
+    return sizeof(LogRecordHeader) + ((length + 3) & ~3);
+}
+
+LogStore::LogStore()
+    : base_address_(0),
+      mounted_(false),
+      active_sector_(0),
+      write_offset_(0),
+      entry_count_(0)
+{
+    memset(sequences_, 0, sizeof(sequences_));
+}
+
+// Scans the region once: sectors with a broken header (interrupted erase or header write) are
+// erased, interrupted and corrupt records are skipped, and the index points to the newest record of each key
+bool LogStore::Mount()
+{
+    base_address_ = ((uint32_t)(uintptr_t)&_SPIFFS_start - 0x40200000UL) - LOGSTORE_SECTORS * SPI_FLASH_SEC_SIZE;
+    entry_count_ = 0;
+    mounted_ = false;
+
+    for (uint8_t sector = 0; sector < LOGSTORE_SECTORS; sector++)
+    {
+        LogSectorHeader header;
+        if (!ESP.flashRead(GetSectorAddress(sector), (uint32_t*)&header, sizeof(header)))
+        {
+            return false;
+        }
+        sequences_[sector] = 0;
+        if (header.magic == LOGSTORE_SECTOR_MAGIC && header.sequence != 0 && header.sequence != 0xFFFFFFFFUL)
+        {
+            sequences_[sector] = header.sequence;
+        }
+        else if (!IsErased(sector) && !ESP.flashEraseSector(GetSectorAddress(sector) / SPI_FLASH_SEC_SIZE))
+        {
+            return false;
+        }
+    }
+
+    // oldest sector first, so later records replace earlier ones in the index
+    uint32_t previous_sequence = 0;
+    int8_t newest = -1;
+    for (uint8_t count = 0; count < LOGSTORE_SECTORS; count++)
+    {
+        int8_t next = -1;
+        for (uint8_t sector = 0; sector < LOGSTORE_SECTORS; sector++)
+        {
+            if (sequences_[sector] > previous_sequence && (next < 0 || sequences_[sector] < sequences_[next]))
+            {
+                next = sector;
+            }
+        }
+        if (next < 0)
+        {
+            break;
+        }
+        previous_sequence = sequences_[next];
+        newest = next;
+        active_sector_ = next;
+        ScanSector(next);
+    }
+
+    mounted_ = (newest >= 0) || StartSector(0);
+    return mounted_;
+}
+
+bool LogStore::IsMounted()
+{
+    return mounted_;
+}
+
+// Appends a new version of the record, the previous one stays valid until the new one is committed
+bool LogStore::Write(uint16_t key, const void* data, uint16_t length)
+{
+    if (!mounted_ || key == 0xFFFF || length > LOGSTORE_MAX_RECORD_SIZE)
+    {
+        return false;
+    }
+    if (FindEntry(key) == nullptr && entry_count_ >= LOGSTORE_MAX_KEYS)
+    {
+        return false;
+    }
+
+    for (uint8_t attempt = 0; attempt <= LOGSTORE_SECTORS; attempt++)
+    {
+        if (Append(key, data, length, 0))
+        {
+            return true;
+        }
+        // the active sector is full, continue in an erased one and keep one erased sector in reserve
+        int8_t sector = FindErasedSector();
+        if (sector < 0 || !StartSector(sector))
+        {
+            return false;
+        }
+        if (FindErasedSector() < 0 && !Reclaim())
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+// Copies up to max_length bytes of the record from offset on into data and returns the full length
+// of the record, -1 if there is none. The offset has to be a multiple of 4, records are read in parts with it.
+int LogStore::Read(uint16_t key, void* data, uint16_t max_length, uint16_t offset)
+{
+    LogIndexEntry* entry = FindEntry(key);
+    if (entry == nullptr || (offset & 3) != 0)
+    {
+        return -1;
+    }
+    uint32_t chunk[LOGSTORE_COPY_CHUNK / 4];
+    uint16_t length = (offset < entry->length) ? min((uint16_t)(entry->length - offset), max_length) : 0;
+    for (uint16_t done = 0; done < length; done += sizeof(chunk))
+    {
+        uint16_t part = min((uint16_t)(length - done), (uint16_t)sizeof(chunk));
+        if (!ESP.flashRead(entry->address + offset + done, chunk, (part + 3) & ~3))
+        {
+            return -1;
+        }
+        memcpy((uint8_t*)data + done, chunk, part);
+    }
+    return entry->length;
+}
+
+int LogStore::GetLength(uint16_t key)
+{
+    LogIndexEntry* entry = FindEntry(key);
+    return (entry == nullptr) ? -1 : entry->length;
+}
+
+// Background compaction from the main loop: once only one erased sector is left, the oldest
+// sector is emptied, as long as its live records fit into the active sector without taking the reserve
+void LogStore::Step()
+{
+    if (!mounted_)
+    {
+        return;
+    }
+    uint8_t erased = 0;
+    for (uint8_t sector = 0; sector < LOGSTORE_SECTORS; sector++)
+    {
+        erased += (sequences_[sector] == 0) ? 1 : 0;
+    }
+    int8_t oldest = FindOldestSector();
+    if (erased > 1 || oldest < 0)
+    {
+        return;
+    }
+
+    uint32_t oldest_begin = GetSectorAddress(oldest);
+    uint32_t live = 0;
+    for (uint8_t idx = 0; idx < entry_count_; idx++)
+    {
+        if (entries_[idx].address >= oldest_begin && entries_[idx].address < oldest_begin + SPI_FLASH_SEC_SIZE)
+        {
+            live += RecordSize(entries_[idx].length);
+        }
+    }
+    if (write_offset_ + live <= SPI_FLASH_SEC_SIZE)
+    {
+        Reclaim();
+    }
+}
+
+uint32_t LogStore::GetFreeBytes()
+{
+    uint32_t free_bytes = SPI_FLASH_SEC_SIZE - write_offset_;
+    for (uint8_t sector = 0; sector < LOGSTORE_SECTORS; sector++)
+    {
+        if (sequences_[sector] == 0)
+        {
+            free_bytes += SPI_FLASH_SEC_SIZE - sizeof(LogSectorHeader);
+        }
+    }
+    return free_bytes;
+}
+
+uint32_t LogStore::GetSectorAddress(uint8_t sector)
+{
+    return base_address_ + sector * SPI_FLASH_SEC_SIZE;
+}
+
+bool LogStore::IsErased(uint8_t sector)
+{
+    uint32_t chunk[LOGSTORE_COPY_CHUNK / 4];
+    for (uint32_t offset = 0; offset < SPI_FLASH_SEC_SIZE; offset += sizeof(chunk))
+    {
+        if (!ESP.flashRead(GetSectorAddress(sector) + offset, chunk, sizeof(chunk)))
+        {
+            return false;
+        }
+        for (uint8_t i = 0; i < LOGSTORE_COPY_CHUNK / 4; i++)
+        {
+            if (chunk[i] != 0xFFFFFFFFUL)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Indexes the committed records of a sector and leaves write_offset_ behind the last record
+void LogStore::ScanSector(uint8_t sector)
+{
+    uint32_t sector_address = GetSectorAddress(sector);
+    uint32_t offset = sizeof(LogSectorHeader);
+    while (offset + sizeof(LogRecordHeader) <= SPI_FLASH_SEC_SIZE)
+    {
+        LogRecordHeader header;
+        if (!ESP.flashRead(sector_address + offset, (uint32_t*)&header, sizeof(header)))
+        {
+            offset = SPI_FLASH_SEC_SIZE;
+            break;
+        }
+        if (header.key == 0xFFFF && header.length == 0xFFFF)
+        {
+            break; // erased, the free space starts here
+        }
+        if (header.length > LOGSTORE_MAX_RECORD_SIZE || offset + RecordSize(header.length) > SPI_FLASH_SEC_SIZE)
+        {
+            offset = SPI_FLASH_SEC_SIZE; // no way to find the next record, the rest of the sector is not used
+            break;
+        }
+
+        uint32_t payload_address = sector_address + offset + sizeof(header);
+        if (header.commit == LOGSTORE_COMMITTED)
+        {
+            uint32_t chunk[LOGSTORE_COPY_CHUNK / 4];
+            uint32_t crc = 0;
+            bool readable = true;
+            for (uint16_t done = 0; done < header.length && readable; done += sizeof(chunk))
+            {
+                uint16_t part = min((uint16_t)(header.length - done), (uint16_t)sizeof(chunk));
+                readable = ESP.flashRead(payload_address + done, chunk, (part + 3) & ~3);
+                crc = Crc32(chunk, part, crc);
+            }
+            LogIndexEntry* entry = FindEntry(header.key);
+            if (readable && crc == header.crc && (entry != nullptr || entry_count_ < LOGSTORE_MAX_KEYS))
+            {
+                if (entry == nullptr)
+                {
+                    entry = &entries_[entry_count_++];
+                    entry->key = header.key;
+                }
+                entry->length = header.length;
+                entry->address = payload_address;
+            }
+        }
+        offset += RecordSize(header.length);
+    }
+    write_offset_ = offset;
+}
+
+bool LogStore::StartSector(uint8_t sector)
+{
+    uint32_t sequence = 0;
+    for (uint8_t idx = 0; idx < LOGSTORE_SECTORS; idx++)
+    {
+        sequence = max(sequence, sequences_[idx]);
+    }
+    // the magic is written last, a header interrupted before it is erased again at Mount()
+    LogSectorHeader header;
+    header.magic = LOGSTORE_SECTOR_MAGIC;
+    header.sequence = sequence + 1;
+    if (!ESP.flashWrite(GetSectorAddress(sector) + offsetof(LogSectorHeader, sequence), &header.sequence, sizeof(header.sequence)) ||
+        !ESP.flashWrite(GetSectorAddress(sector) + offsetof(LogSectorHeader, magic), &header.magic, sizeof(header.magic)))
+    {
+        return false;
+    }
+    sequences_[sector] = header.sequence;
+    active_sector_ = sector;
+    write_offset_ = sizeof(header);
+    return true;
+}
+
+// Writes header, payload and finally the commit word. The payload comes from data, or from
+// source_address in flash if data is null (records moved by Reclaim()).
+bool LogStore::Append(uint16_t key, const void* data, uint16_t length, uint32_t source_address)
+{
+    if (write_offset_ + RecordSize(length) > SPI_FLASH_SEC_SIZE)
+    {
+        return false;
+    }
+    uint32_t address = GetSectorAddress(active_sector_) + write_offset_;
+    uint32_t chunk[LOGSTORE_COPY_CHUNK / 4];
+
+    LogRecordHeader header;
+    header.key = key;
+    header.length = length;
+    header.commit = 0xFFFFFFFFUL;
+    if (data != nullptr)
+    {
+        header.crc = Crc32(data, length);
+    }
+    else
+    {
+        header.crc = 0;
+        for (uint16_t done = 0; done < length; done += sizeof(chunk))
+        {
+            uint16_t part = min((uint16_t)(length - done), (uint16_t)sizeof(chunk));
+            if (!ESP.flashRead(source_address + done, chunk, (part + 3) & ~3))
+            {
+                return false;
+            }
+            header.crc = Crc32(chunk, part, header.crc);
+        }
+    }
+
+    // from here on the space is used, even if writing fails
+    write_offset_ += RecordSize(length);
+    if (!ESP.flashWrite(address, (uint32_t*)&header, sizeof(header)))
+    {
+        return false;
+    }
+    for (uint16_t done = 0; done < length; done += sizeof(chunk))
+    {
+        uint16_t part = min((uint16_t)(length - done), (uint16_t)sizeof(chunk));
+        uint16_t padded = (part + 3) & ~3;
+        if (data != nullptr)
+        {
+            chunk[(padded / 4) - 1] = 0xFFFFFFFFUL;
+            memcpy(chunk, (const uint8_t*)data + done, part);
+        }
+        else if (!ESP.flashRead(source_address + done, chunk, padded))
+        {
+            return false;
+        }
+        if (!ESP.flashWrite(address + sizeof(header) + done, chunk, padded))
+        {
+            return false;
+        }
+    }
+    uint32_t commit = LOGSTORE_COMMITTED;
+    if (!ESP.flashWrite(address + offsetof(LogRecordHeader, commit), &commit, sizeof(commit)))
+    {
+        return false;
+    }
+
+    LogIndexEntry* entry = FindEntry(key);
+    if (entry == nullptr)
+    {
+        entry = &entries_[entry_count_++];
+        entry->key = key;
+    }
+    entry->length = length;
+    entry->address = address + sizeof(header);
+    return true;
+}
+
+// Moves the live records of the oldest sector to the active one and erases it. A reset in between
+// leaves both copies, the newer one wins at Mount().
+bool LogStore::Reclaim()
+{
+    int8_t oldest = FindOldestSector();
+    if (oldest < 0)
+    {
+        return false;
+    }
+    uint32_t oldest_begin = GetSectorAddress(oldest);
+    for (uint8_t idx = 0; idx < entry_count_; idx++)
+    {
+        LogIndexEntry entry = entries_[idx];
+        if (entry.address < oldest_begin || entry.address >= oldest_begin + SPI_FLASH_SEC_SIZE)
+        {
+            continue;
+        }
+        if (!Append(entry.key, nullptr, entry.length, entry.address))
+        {
+            int8_t sector = FindErasedSector();
+            if (sector < 0 || !StartSector(sector) || !Append(entry.key, nullptr, entry.length, entry.address))
+            {
+                return false;
+            }
+        }
+    }
+    if (!ESP.flashEraseSector(oldest_begin / SPI_FLASH_SEC_SIZE))
+    {
+        return false;
+    }
+    sequences_[oldest] = 0;
+    return true;
+}
+
+int8_t LogStore::FindErasedSector()
+{
+    for (uint8_t sector = 0; sector < LOGSTORE_SECTORS; sector++)
+    {
+        if (sequences_[sector] == 0)
+        {
+            return sector;
+        }
+    }
+    return -1;
+}
+
+// Oldest sector in use besides the active one, -1 if there is none
+int8_t LogStore::FindOldestSector()
+{
+    int8_t oldest = -1;
+    for (uint8_t sector = 0; sector < LOGSTORE_SECTORS; sector++)
+    {
+        if (sequences_[sector] != 0 && sector != active_sector_ && (oldest < 0 || sequences_[sector] < sequences_[oldest]))
+        {
+            oldest = sector;
+        }
+    }
+    return oldest;
+}
+
+LogIndexEntry* LogStore::FindEntry(uint16_t key)
+{
+    for (uint8_t idx = 0; idx < entry_count_; idx++)
+    {
+        if (entries_[idx].key == key)
+        {
+            return &entries_[idx];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,87 @@
+//
+//  LogStore.h - Wear leveled key/record store, appended to a ring of reserved flash sectors.
+//  License: MIT
+//
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+#include <Arduino.h>
+
+#include "Crc32.h"
+
+// The region are the sectors right below SPIFFS. Without OTA updates nothing else uses them,
+// an OTA image large enough to reach them destroys the records, which are then dropped at Mount().
+#define LOGSTORE_SECTORS          4
+#define LOGSTORE_SECTOR_MAGIC     0x57574C53UL  // "WWLS"
+#define LOGSTORE_COMMITTED        0x00000000UL  // commit word of a complete record, erased flash reads 0xFFFFFFFF
+#define LOGSTORE_MAX_KEYS         16
+#define LOGSTORE_MAX_RECORD_SIZE  1024          // payload bytes
+#define LOGSTORE_COPY_CHUNK       64            // bytes, stack buffer for flash access
+
+// Keys of the records, never reuse a number for something else
+#define LOGSTORE_KEY_SETTINGS     1  // first slot of the settings
+#define LOGSTORE_KEY_WIFI_CONFIG  2
+#define LOGSTORE_KEY_SETTINGS_B   3  // second slot of the settings
+#define LOGSTORE_KEY_HISTORY      4  // closed days, written once per day
+#define LOGSTORE_KEY_HISTORY_DAY  5  // entries of the running day
+
+struct LogSectorHeader
+{
+    uint32_t magic;
+    uint32_t sequence;    // increases with every sector taken into use, the highest one is written to
+};
+
+// Followed by the payload, padded to a multiple of 4 bytes. The commit word is written last,
+// a record without it was interrupted by a reset and is skipped.
+struct LogRecordHeader
+{
+    uint16_t key;
+    uint16_t length;
+    uint32_t crc;         // of the payload
+    uint32_t commit;
+};
+
+struct LogIndexEntry
+{
+    uint16_t key;
+    uint16_t length;
+    uint32_t address;     // of the payload
+};
+
+class LogStore
+{
+public:
+    LogStore();
+
+    bool Mount();
+    bool IsMounted();
+    bool Write(uint16_t key, const void* data, uint16_t length);
+    int Read(uint16_t key, void* data, uint16_t max_length, uint16_t offset = 0);
+    int GetLength(uint16_t key);
+    void Step();
+    uint32_t GetFreeBytes();
+
+private:
+    uint32_t GetSectorAddress(uint8_t sector);
+    bool IsErased(uint8_t sector);
+    void ScanSector(uint8_t sector);
+    bool StartSector(uint8_t sector);
+    bool Append(uint16_t key, const void* data, uint16_t length, uint32_t source_address);
+    bool Reclaim();
+    int8_t FindErasedSector();
+    int8_t FindOldestSector();
+    LogIndexEntry* FindEntry(uint16_t key);
+
+    uint32_t base_address_;
+    bool mounted_;
+    uint32_t sequences_[LOGSTORE_SECTORS];  // 0 for an erased sector
+    uint8_t active_sector_;
+    uint32_t write_offset_;                  // within the active sector
+
+    LogIndexEntry entries_[LOGSTORE_MAX_KEYS];
+    uint8_t entry_count_;
+};
+
+extern LogStore FlashLog;
+
+#endif // #ifndef LOGSTORE_H
@@ -0,0 +1,49 @@
+//
+//  MonotonicClock.cpp - 64-bit microseconds since boot, the one place where the wrap around of micros() is handled.
+//  License: MIT
+//
+
+#include "MonotonicClock.h"
+
+MonotonicClock Monotonic;
+
+MonotonicClock::MonotonicClock()
+    : last_raw_micros_(0),
+      wraps_(0)
+{
+}
+
+// A wrap around is only noticed if micros() is read at least once per wrap. The ticker makes sure
+// of that even while the main loop is blocked, e.g. by the configuration portal of WiFiManager.
+// Ticker callbacks run in the system task, never in the middle of the main loop.
+void MonotonicClock::Begin()
+{
+    Micros();
+    ticker_.attach(MONOTONIC_TICK_SECONDS, Tick);
+}
+
+uint64_t MonotonicClock::Micros()
+{
+    return Extend(micros());
+}
+
+uint64_t MonotonicClock::Millis()
+{
+    return Micros() / 1000;
+}
+
+// Extends a raw 32-bit micros() reading, readings have to be passed in the order they were taken
+uint64_t MonotonicClock::Extend(uint32_t raw_micros)
+{
+    if (raw_micros < last_raw_micros_)
+    {
+        wraps_++;
+    }
+    last_raw_micros_ = raw_micros;
+    return (uint64_t)wraps_ << 32 | raw_micros;
+}
+
+void MonotonicClock::Tick()
+{
+    Monotonic.Micros();
+}
@@ -0,0 +1,33 @@
+//
+//  MonotonicClock.h - 64-bit microseconds since boot, the one place where the wrap around of micros() is handled.
+//  License: MIT
+//
+#ifndef MONOTONICCLOCK_H
+#define MONOTONICCLOCK_H
+
+#include <Arduino.h>
+#include <Ticker.h>
+
+#define MONOTONIC_TICK_SECONDS 60  // well below the ~71.6 minutes after which micros() wraps around
+
+class MonotonicClock
+{
+public:
+    MonotonicClock();
+
+    void Begin();
+    uint64_t Micros();
+    uint64_t Millis();
+    uint64_t Extend(uint32_t raw_micros);
+
+private:
+    static void Tick();
+
+    Ticker ticker_;
+    uint32_t last_raw_micros_;
+    uint32_t wraps_;
+};
+
+extern MonotonicClock Monotonic;
+
+#endif // #ifndef MONOTONICCLOCK_H
@@ -0,0 +1,125 @@
+//
+//  MovementPlanner.cpp - Spreads the daily turns of every supplier over the allowed time of the week.
+//  License: MIT
+//
+
+#include "MovementPlanner.h"
+
+MovementPlanner::MovementPlanner()
+    : allowed_minutes_per_week_(0),
+      last_accrual_millis_(0),
+      accruing_(false)
+{
+}
+
+// Called from the main loop. Turns are owed at a constant rate while allowed, so that a week of allowed
+// time gives seven times the turns per day however the windows are laid out, and are paid in bursts.
+// Bursts are stepped with nextAction() only when the next step is due, so the loop never waits for the stepper.
+void MovementPlanner::Step(std::vector<WatchMovementSupplier>& suppliers, bool allowed, uint16_t allowed_minutes_per_week)
+{
+    if (plans_.size() != suppliers.size())
+    {
+        plans_.resize(suppliers.size(), SupplierPlan());
+    }
+    requirements_.Update(suppliers);
+    if (allowed_minutes_per_week != allowed_minutes_per_week_)
+    {
+        // the scale of the owed turns changes with the schedule
+        for (auto& plan : plans_)
+        {
+            plan.owed = (allowed_minutes_per_week_ == 0) ? 0 : plan.owed * allowed_minutes_per_week / allowed_minutes_per_week_;
+        }
+        allowed_minutes_per_week_ = allowed_minutes_per_week;
+    }
+
+    uint64_t current_millis = Monotonic.Millis();
+    uint64_t elapsed = accruing_ ? current_millis - last_accrual_millis_ : 0;
+    last_accrual_millis_ = current_millis;
+    accruing_ = allowed && allowed_minutes_per_week_ > 0;
+
+    uint64_t burst = (uint64_t)PLANNER_TURNS_PER_BURST * 1000 * allowed_minutes_per_week_ * SECS_PER_MIN;
+    for (size_t idx = 0; idx < suppliers.size(); idx++)
+    {
+        WatchMovementSupplier& supplier = suppliers[idx];
+        SupplierPlan& plan = plans_[idx];
+        if (supplier.GetStepper().getSteps() == 0)
+        {
+            continue; // placeholder stepper without a motor, it can not be timed
+        }
+
+        plan.owed += elapsed * DAYS_PER_WEEK * requirements_.GetTurnsPerDay(idx);
+        plan.owed = min(plan.owed, burst * PLANNER_MAX_OWED_BURSTS);
+
+        if (plan.moving)
+        {
+            // a burst running when the window closes is finished
+            Drive(supplier, plan);
+        }
+        else if (accruing_ && plan.owed >= burst)
+        {
+            plan.owed -= burst;
+            StartBurst(supplier, plan, idx);
+        }
+    }
+}
+
+bool MovementPlanner::IsMoving()
+{
+    for (auto& plan : plans_)
+    {
+        if (plan.moving)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// nullptr until the supplier has been seen by Step()
+const SupplierPlan* MovementPlanner::GetPlan(size_t idx)
+{
+    return (idx < plans_.size()) ? &plans_[idx] : nullptr;
+}
+
+// To be called after the requirements or the gear ratio of a supplier were changed, they are
+// read from the suppliers again in the next Step()
+void MovementPlanner::RequirementsChanged(size_t supplier)
+{
+    requirements_.Invalidate(supplier);
+}
+
+void MovementPlanner::StartBurst(WatchMovementSupplier& supplier, SupplierPlan& plan, size_t idx)
+{
+    int direction = requirements_.GetRequiredDirection(idx);
+    if (direction == 0)
+    {
+        direction = plan.clockwise_next ? 1 : -1;
+        plan.clockwise_next = !plan.clockwise_next;
+    }
+    double degrees = direction * 360.0 * PLANNER_TURNS_PER_BURST * requirements_.GetGearRatio(idx);
+
+    supplier.GetStepper().enable();
+    supplier.GetStepper().startRotate(degrees);
+    plan.moving = true;
+    plan.direction = direction;
+    plan.last_action_micros = Monotonic.Micros();
+    plan.burst_start_micros = plan.last_action_micros;
+    plan.next_action_interval = 0;
+}
+
+void MovementPlanner::Drive(WatchMovementSupplier& supplier, SupplierPlan& plan)
+{
+    if (Monotonic.Micros() - plan.last_action_micros < plan.next_action_interval)
+    {
+        return;
+    }
+    plan.next_action_interval = supplier.GetStepper().nextAction();
+    plan.last_action_micros = Monotonic.Micros();
+    if (plan.next_action_interval == 0)
+    {
+        plan.moving = false;
+        supplier.GetStepper().disable();
+        (plan.direction > 0 ? plan.turns_clockwise : plan.turns_counterclockwise) += PLANNER_TURNS_PER_BURST;
+        plan.motor_micros += plan.last_action_micros - plan.burst_start_micros;
+    }
+}
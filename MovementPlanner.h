@@ -0,0 +1,56 @@
+//
+//  MovementPlanner.h - Spreads the daily turns of every supplier over the allowed time of the week.
+//  License: MIT
+//
+#ifndef MOVEMENTPLANNER_H
+#define MOVEMENTPLANNER_H
+
+#include <Arduino.h>
+#include <vector>
+
+#include "TimeLib.h"
+#include "MonotonicClock.h"
+#include "WatchMovementSupplier.h"
+#include "RequirementTable.h"
+
+#define PLANNER_TURNS_PER_BURST  10  // watch turns per run of the stepper, about half a minute at 19 rpm
+#define PLANNER_MAX_OWED_BURSTS  2   // turns owed beyond this are dropped, e.g. while the stepper is too slow
+
+struct SupplierPlan
+{
+    uint64_t owed;              // watch turns owed, scaled by 1000 * allowed seconds per week
+    bool moving;
+    bool clockwise_next;        // stepper direction of the next burst if the watches allow both
+    uint64_t last_action_micros;
+    uint32_t next_action_interval;
+    int8_t direction;           // of the stepper in the running burst, 1 is clockwise
+    uint64_t burst_start_micros;
+
+    // totals since boot, read by WindingHistory
+    uint32_t turns_clockwise;   // watch turns of finished bursts, by stepper direction
+    uint32_t turns_counterclockwise;
+    uint64_t motor_micros;
+};
+
+class MovementPlanner
+{
+public:
+    MovementPlanner();
+
+    void Step(std::vector<WatchMovementSupplier>& suppliers, bool allowed, uint16_t allowed_minutes_per_week);
+    bool IsMoving();
+    const SupplierPlan* GetPlan(size_t idx);
+    void RequirementsChanged(size_t supplier = REQUIREMENTS_ALL_SUPPLIERS);
+
+private:
+    void StartBurst(WatchMovementSupplier& supplier, SupplierPlan& plan, size_t idx);
+    void Drive(WatchMovementSupplier& supplier, SupplierPlan& plan);
+
+    std::vector<SupplierPlan> plans_;
+    RequirementTable requirements_;
+    uint16_t allowed_minutes_per_week_;
+    uint64_t last_accrual_millis_;
+    bool accruing_;
+};
+
+#endif // #ifndef MOVEMENTPLANNER_H
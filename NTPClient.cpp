@@ -107,22 +107,66 @@ void NTPClient::setPollingInterval(unsigned int interval) {
 
 unsigned int NTPClient::getPollingInterval() { return long_interval; }
 
+tz_utc_offsets_t NTPClient::getUtcOffset() { return utc_offset; }
+
 time_t NTPClient::getLastSync() { return last_poll; }
 
 time_t NTPClient::getFirstSync() { return first_poll; }
 
-const char *NTPClient::getTimeDate(time_t tm) {
-  char *dt = new char[20];
-  char buf[20];
+size_t NTPClient::formatTime(char *buf, size_t len, time_t _time, ntp_time_format_t format) {
+  tmElements_t tm;
+  char weekday[dt_SHORT_STR_LEN + 1];
+  char month[dt_SHORT_STR_LEN + 1];
+  int written;
+
+  if (0 == len) {
+    return 0;
+  }
+
+  breakTime(_time, tm);
+  switch (format) {
+  case NTP_FORMAT_DATE:
+    written = snprintf(buf, len, "%d-%02d-%02d", tmYearToCalendar(tm.Year), tm.Month, tm.Day);
+    break;
+  case NTP_FORMAT_TIME:
+    written = snprintf(buf, len, "%02d:%02d:%02d", tm.Hour, tm.Minute, tm.Second);
+    break;
+  case NTP_FORMAT_READABLE:
+    written = snprintf(buf, len, "%s, %d %s %d %02d:%02d:%02d", dayShortStr(tm.Wday, weekday), tm.Day,
+                       monthShortStr(tm.Month, month), tmYearToCalendar(tm.Year), tm.Hour, tm.Minute, tm.Second);
+    break;
+  case NTP_FORMAT_ISO8601:
+  default:
+    written = snprintf(buf, len, "%d-%02d-%02dT%02d:%02d:%02d", tmYearToCalendar(tm.Year), tm.Month,
+                       tm.Day, tm.Hour, tm.Minute, tm.Second);
+    break;
+  }
+
+  if (written < 0) {
+    buf[0] = 0;
+    return 0;
+  }
+  return min((size_t)written, len - 1);
+}
 
-  snprintf(buf, sizeof(buf), "%d-%02d-%02dT%02d:%02d:%02d", year(tm), month(tm),
-           day(tm), hour(tm), minute(tm), second(tm));
-  strcpy(dt, buf);
+const char *NTPClient::getTimeDate(time_t tm) {
+  static char dt[NTP_TIME_STRING_LEN];
 
+  formatTime(dt, sizeof(dt), tm);
   return dt;
 }
 
-time_t NTPClient::s_getTime() { return NTP.getTime(); }
+time_t NTPClient::s_getTime() {
+  time_t timestamp = NTP.getTime();
+
+  if (timestamp) {
+    setSyncInterval(NTP.getPollingInterval()); // Regular polling interval
+  } else {
+    setSyncInterval(NTP_SHORT_INTERVAL); // Get synchronized immediately
+  }
+
+  return timestamp;
+}
 
 time_t NTPClient::getTime() {
   if (!WiFi.isConnected()) {
@@ -134,7 +178,6 @@ time_t NTPClient::getTime() {
   uint32_t timestamp = sntp_get_current_timestamp();
 
   if (timestamp) {
-    setSyncInterval(NTP.getPollingInterval()); // Regular polling interval
     timestamp += utc_offset;                   // Adjust time with UTC Offset
 
     last_poll = timestamp;
@@ -157,8 +200,6 @@ time_t NTPClient::getTime() {
     if (onNTPSyncEvent != NULL) {
       onNTPSyncEvent(NTP_EVENT_NO_RESPONSE);
     }
-
-    setSyncInterval(NTP_SHORT_INTERVAL); // Get synchronized immediately
   }
 
   return timestamp;
@@ -11,7 +11,7 @@
 #define _NTPClient_h
 
 #ifndef ESP8266
-#error “This library only supports boards with the ESP8266 MCU.”
+#error "This library only supports boards with the ESP8266 MCU."
 #endif
 
 #include "TimeLib.h"
@@ -41,6 +41,16 @@ typedef enum {
 
 typedef std::function<void (NTPSyncEvent_t)> onSyncEvent_t;
 
+// Formats for rendering a time in human readable format
+typedef enum {
+        NTP_FORMAT_ISO8601, // 2018-07-14T21:05:09
+        NTP_FORMAT_DATE, // 2018-07-14
+        NTP_FORMAT_TIME, // 21:05:09
+        NTP_FORMAT_READABLE, // Sat, 14 Jul 2018 21:05:09
+} ntp_time_format_t;
+
+#define NTP_TIME_STRING_LEN 26 // Buffer size that fits every ntp_time_format_t, including the terminating null
+
 // Timezones by UTC-offset (in seconds). The underscore represents negative
 // mark, as hyphens can not be used.
 typedef enum __attribute__((packed)) {
@@ -159,6 +169,13 @@ public:
          */
         unsigned int getPollingInterval();
 
+        /**
+         * @brief Gets the UTC Offset (i.e. timezone) given to init().
+         *
+         * @return the UTC Offset in seconds.
+         */
+        tz_utc_offsets_t getUtcOffset();
+
         /**
          * @brief Gets last succesful synchronization time.
          *
@@ -175,34 +192,52 @@ public:
          */
         time_t getFirstSync();
 
+        /**
+         * @brief Renders a time in human readable format into a caller supplied buffer.
+         *
+         * This function does not allocate memory. The result is truncated if
+         * the buffer is too small, a buffer of NTP_TIME_STRING_LEN always fits.
+         *
+         * @param  buf    buffer receiving the null terminated string
+         * @param  len    size of buf in bytes
+         * @param  _time  the time element to be displayed in text format
+         * @param  format the format to render, ISO8601 (yyyy-mm-ddThh:mm:ss) by default
+         * @return        length of the formatted string (excluding the terminating null)
+         */
+        size_t formatTime(char *buf, size_t len, time_t _time, ntp_time_format_t format = NTP_FORMAT_ISO8601);
+
         /**
          * @brief Helper function to display date/time in human readable format.
          *
          * This function is used to present a time in human readable format.
-         * Time and date are rendered in ISO8601 format (yyyy/mm/ddThh:mm:ss)
+         * Time and date are rendered in ISO8601 format (yyyy-mm-ddThh:mm:ss)
+         * into a static buffer, which is overwritten by the next call. Use
+         * formatTime() to keep the result.
          *
          * @param  _time the time element to be displayed in text format
-         * @return       Time and date rendered in ISO8601 format (yyyy/mm/ddThh:mm:ss)
+         * @return       Time and date rendered in ISO8601 format (yyyy-mm-ddThh:mm:ss)
          */
         const char* getTimeDate(time_t _time);
 
-private:
-        unsigned int long_interval; // Polling interval for periodic time synchronization
-        tz_utc_offsets_t utc_offset; // UTC Offset. Defaults to UTC
-        time_t last_poll; // Time of last succesfull poll
-        time_t first_poll; // Time of first successful poll after boot
-        onSyncEvent_t onNTPSyncEvent; // Event handler callback function
-
         /**
          * @brief Sends a request to the NTP server.
          *
          * This function sends a request to the configured NTP Server. It will
-         * return a time in UNIX time format.
+         * return a time in UNIX time format. Unlike the synchronization handler
+         * it does not change the synchronization interval of the Time Library,
+         * so a clock layer on top of this library can poll it on its own schedule.
          *
-         * @return time in UNIX time format.
+         * @return time in UNIX time format, 0 if no time was received.
          */
         time_t getTime();
 
+private:
+        unsigned int long_interval; // Polling interval for periodic time synchronization
+        tz_utc_offsets_t utc_offset; // UTC Offset. Defaults to UTC
+        time_t last_poll; // Time of last succesfull poll
+        time_t first_poll; // Time of first successful poll after boot
+        onSyncEvent_t onNTPSyncEvent; // Event handler callback function
+
         /**
          * @brief Gets the time from an NTP server.
          *
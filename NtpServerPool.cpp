@@ -0,0 +1,296 @@
+//
+//  NtpServerPool.cpp - Non-blocking SNTP client that prefers the fastest healthy server.
+//  License: MIT
+//
+
+#include "NtpServerPool.h"
+
+NtpServerPool NtpServers;
+
+// NTP timestamp (seconds and fraction since 1900, big endian) to milliseconds since 1970
+static int64_t NtpTimestampToUnixMillis(const uint8_t* timestamp)
+{
+    uint32_t seconds  = (uint32_t)timestamp[0] << 24 | (uint32_t)timestamp[1] << 16 | (uint32_t)timestamp[2] << 8 | timestamp[3];
+    uint32_t fraction = (uint32_t)timestamp[4] << 24 | (uint32_t)timestamp[5] << 16 | (uint32_t)timestamp[6] << 8 | timestamp[7];
+    return ((int64_t)seconds - (int64_t)NTP_UNIX_OFFSET) * 1000 + (int64_t)(((uint64_t)fraction * 1000) >> 32);
+}
+
+NtpServerPool::NtpServerPool()
+    : server_count_(0),
+      request_pending_(false),
+      request_server_(0),
+      request_sent_millis_(0),
+      request_sent_epoch_millis_(0),
+      last_sync_(0)
+{
+}
+
+// Takes the servers configured in NTPClient (index 0 ~ 2)
+void NtpServerPool::Begin()
+{
+    server_count_ = 0;
+    for (uint8_t idx = 0; idx < NTP_SERVERS_MAXIMUM; idx++)
+    {
+        const char* name = NTP.getNTPServer(idx);
+        if (name == nullptr || name[0] == '\0')
+        {
+            continue;
+        }
+        NtpServerStats& server = servers_[server_count_++];
+        server.name = name;
+        server.address = IPAddress(0, 0, 0, 0);
+        server.resolve_state = NTP_RESOLVE_IDLE;
+        server.resolve_started_millis = 0;
+        server.rtt_ms = 0;
+        server.offset_ms = 0;
+        server.failures = 0;
+        server.retry_after_millis = millis();
+    }
+    udp_.begin(NTP_LOCAL_PORT);
+}
+
+// Called from the main loop, never waits for the network. Names are resolved in the background,
+// a request goes out in the first Step() after the address is known.
+void NtpServerPool::Step()
+{
+    for (uint8_t idx = 0; idx < server_count_; idx++)
+    {
+        NtpServerStats& server = servers_[idx];
+        if (server.resolve_state == NTP_RESOLVE_PENDING && millis() - server.resolve_started_millis >= NTP_RESOLVE_TIMEOUT_MS)
+        {
+            server.resolve_state = NTP_RESOLVE_FAILED;
+        }
+        if (server.resolve_state == NTP_RESOLVE_FAILED)
+        {
+            Serial.printf("NTP server %s not resolved.\n", server.name);
+            ServerFailed(idx);
+        }
+    }
+
+    if (request_pending_)
+    {
+        ReceiveReply();
+        return;
+    }
+    if (server_count_ == 0 || !WiFi.isConnected() || !SystemClock.IsPollDue())
+    {
+        return;
+    }
+
+    int idx = SelectServer();
+    if (idx < 0)
+    {
+        // every server is backing off
+        SystemClock.PollFailed();
+        return;
+    }
+    if ((uint32_t)servers_[idx].address == 0)
+    {
+        Resolve(idx);
+        if ((uint32_t)servers_[idx].address == 0)
+        {
+            return; // the request goes out once DnsFound() has the address
+        }
+    }
+    if (!SendRequest(idx))
+    {
+        ServerFailed(idx);
+    }
+}
+
+// Servers without a measurement are tried first, otherwise the healthy server with the lowest round trip time wins
+int NtpServerPool::SelectServer()
+{
+    int best = -1;
+    uint32_t current_millis = millis();
+    for (uint8_t idx = 0; idx < server_count_; idx++)
+    {
+        if ((int32_t)(current_millis - servers_[idx].retry_after_millis) < 0)
+        {
+            continue;
+        }
+        if (best < 0 || servers_[idx].rtt_ms < servers_[best].rtt_ms)
+        {
+            best = idx;
+        }
+    }
+    return best;
+}
+
+// Starts the lookup of the name unless one is running, lwIP answers from its cache right away
+void NtpServerPool::Resolve(uint8_t idx)
+{
+    NtpServerStats& server = servers_[idx];
+    if (server.resolve_state == NTP_RESOLVE_PENDING)
+    {
+        return;
+    }
+    ip_addr_t address;
+    server.resolve_state = NTP_RESOLVE_PENDING;
+    server.resolve_started_millis = millis();
+    err_t err = dns_gethostbyname(server.name, &address, &NtpServerPool::DnsFound, &server);
+    if (err == ERR_OK)
+    {
+        server.address = IPAddress(&address);
+        server.resolve_state = NTP_RESOLVE_IDLE;
+    }
+    else if (err != ERR_INPROGRESS)
+    {
+        server.resolve_state = NTP_RESOLVE_FAILED;
+    }
+}
+
+// Runs in the lwIP context, only the address and the state of the server are written here
+#if LWIP_VERSION_MAJOR == 1
+void NtpServerPool::DnsFound(const char* name, ip_addr_t* ipaddr, void* arg)
+#else
+void NtpServerPool::DnsFound(const char* name, const ip_addr_t* ipaddr, void* arg)
+#endif
+{
+    (void)name;
+    NtpServerStats* server = static_cast<NtpServerStats*>(arg);
+    if (server->resolve_state != NTP_RESOLVE_PENDING)
+    {
+        return; // timed out in Step() before
+    }
+    if (ipaddr != nullptr)
+    {
+        server->address = IPAddress(ipaddr);
+        server->resolve_state = NTP_RESOLVE_IDLE;
+    }
+    else
+    {
+        server->resolve_state = NTP_RESOLVE_FAILED;
+    }
+}
+
+bool NtpServerPool::SendRequest(uint8_t idx)
+{
+    NtpServerStats& server = servers_[idx];
+
+    // drop late replies of earlier requests, every parsePacket() discards the previous packet
+    while (udp_.parsePacket() > 0)
+    {
+    }
+
+    uint8_t packet[NTP_PACKET_SIZE];
+    memset(packet, 0, sizeof(packet));
+    packet[0] = 0x23; // LI 0, version 4, mode 3 (client)
+
+    // The transmit timestamp only identifies the request, the server echoes it as originate timestamp
+    request_sent_millis_ = millis();
+    request_sent_epoch_millis_ = SystemClock.NowMillis();
+    uint32_t nonce_seconds  = (uint32_t)(request_sent_epoch_millis_ / 1000);
+    uint32_t nonce_fraction = request_sent_millis_ ^ ESP.getCycleCount();
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        request_transmit_[i]     = nonce_seconds >> (24 - 8 * i);
+        request_transmit_[i + 4] = nonce_fraction >> (24 - 8 * i);
+    }
+    memcpy(packet + 40, request_transmit_, sizeof(request_transmit_));
+
+    if (!udp_.beginPacket(server.address, NTP_PORT))
+    {
+        return false;
+    }
+    udp_.write(packet, sizeof(packet));
+    if (!udp_.endPacket())
+    {
+        return false;
+    }
+
+    request_server_ = idx;
+    request_pending_ = true;
+    return true;
+}
+
+void NtpServerPool::ReceiveReply()
+{
+    if (udp_.parsePacket() >= NTP_PACKET_SIZE)
+    {
+        uint8_t packet[NTP_PACKET_SIZE];
+        udp_.read(packet, sizeof(packet));
+        uint64_t received_epoch_millis = SystemClock.NowMillis();
+
+        uint8_t mode    = packet[0] & 0x07;
+        uint8_t stratum = packet[1];
+        if (mode == 4 && stratum > 0 && stratum < 16 && memcmp(packet + 24, request_transmit_, sizeof(request_transmit_)) == 0)
+        {
+            // Server timestamps are UTC, shifted by the offset given to NTPClient (UTC unless configured otherwise)
+            int64_t utc_offset_ms = (int64_t)NTP.getUtcOffset() * 1000;
+            int64_t t1 = (int64_t)request_sent_epoch_millis_;
+            int64_t t2 = NtpTimestampToUnixMillis(packet + 32) + utc_offset_ms;
+            int64_t t3 = NtpTimestampToUnixMillis(packet + 40) + utc_offset_ms;
+            int64_t t4 = (int64_t)received_epoch_millis;
+
+            int64_t offset = ((t2 - t1) + (t3 - t4)) / 2;
+            int64_t rtt = (t4 - t1) - (t3 - t2);
+            if (rtt < 1)
+            {
+                rtt = 1;
+            }
+
+            NtpServerStats& server = servers_[request_server_];
+            server.rtt_ms = server.rtt_ms == 0 ? (uint32_t)rtt : (3 * server.rtt_ms + (uint32_t)rtt) / 4;
+            server.offset_ms = (int32_t)(offset > INT32_MAX ? INT32_MAX : (offset < INT32_MIN ? INT32_MIN : offset));
+            server.failures = 0;
+            request_pending_ = false;
+
+            SystemClock.Discipline((uint64_t)(t4 + offset), (uint32_t)rtt / 2);
+            last_sync_ = SystemClock.Now();
+
+            char time_string[NTP_TIME_STRING_LEN];
+            NTP.formatTime(time_string, sizeof(time_string), last_sync_);
+            Serial.printf("Got NTP time from %s: %s UTC (offset %d ms, rtt %u ms)\n", server.name, time_string, server.offset_ms, server.rtt_ms);
+            return;
+        }
+        // not the answer to this request, or a kiss-o'-death, keep waiting until the timeout
+    }
+
+    if (millis() - request_sent_millis_ >= NTP_REPLY_TIMEOUT_MS)
+    {
+        request_pending_ = false;
+        Serial.printf("NTP server %s not reachable.\n", servers_[request_server_].name);
+        ServerFailed(request_server_);
+    }
+}
+
+// Exponential backoff, starting at NTP_SHORT_INTERVAL and doubling up to NTP_MAX_BACKOFF
+void NtpServerPool::ServerFailed(uint8_t idx)
+{
+    NtpServerStats& server = servers_[idx];
+    if (server.failures < 16)
+    {
+        server.failures++;
+    }
+    uint32_t backoff = NTP_SHORT_INTERVAL;
+    for (uint8_t i = 1; i < server.failures && backoff < NTP_MAX_BACKOFF; i++)
+    {
+        backoff *= 2;
+    }
+    backoff = min(backoff, (uint32_t)NTP_MAX_BACKOFF);
+    server.retry_after_millis = millis() + backoff * 1000UL;
+    server.address = IPAddress(0, 0, 0, 0); // resolve again in the background, pool names rotate their addresses
+    server.resolve_state = NTP_RESOLVE_IDLE;
+}
+
+uint8_t NtpServerPool::GetServerCount()
+{
+    return server_count_;
+}
+
+const NtpServerStats& NtpServerPool::GetServer(uint8_t idx)
+{
+    return servers_[idx];
+}
+
+// Index of the server the next request goes to, -1 if all are backing off
+int NtpServerPool::GetPreferredServer()
+{
+    return SelectServer();
+}
+
+time_t NtpServerPool::GetLastSync()
+{
+    return last_sync_;
+}
@@ -0,0 +1,83 @@
+//
+//  NtpServerPool.h - Non-blocking SNTP client that prefers the fastest healthy server.
+//  License: MIT
+//
+#ifndef NTPSERVERPOOL_H
+#define NTPSERVERPOOL_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+
+#include "NTPClient.h"
+#include "ClockDiscipline.h"
+
+#define NTP_PACKET_SIZE      48
+#define NTP_PORT             123
+#define NTP_LOCAL_PORT       2390
+#define NTP_REPLY_TIMEOUT_MS 1500
+#define NTP_RESOLVE_TIMEOUT_MS 15000       // lwIP gives up earlier and reports the failure, this is only a safety net
+#define NTP_MAX_BACKOFF      3600          // seconds, upper bound of the retry delay of a failing server
+#define NTP_UNIX_OFFSET      2208988800UL  // seconds from 1 jan 1900 to 1 jan 1970
+
+enum NtpResolveState
+{
+    NTP_RESOLVE_IDLE = 0,      // address is valid, or no lookup was started yet
+    NTP_RESOLVE_PENDING,       // waiting for DnsFound()
+    NTP_RESOLVE_FAILED
+};
+
+struct NtpServerStats
+{
+    const char* name;
+    IPAddress address;
+    volatile uint8_t resolve_state;   // NtpResolveState, written by DnsFound() from the lwIP context
+    uint32_t resolve_started_millis;
+    uint32_t rtt_ms;           // smoothed round trip time, 0 until the first reply
+    int32_t offset_ms;         // offset of the last reply against SystemClock
+    uint8_t failures;          // consecutive failures, drives the backoff
+    uint32_t retry_after_millis;
+};
+
+class NtpServerPool
+{
+public:
+    NtpServerPool();
+
+    void Begin();
+    void Step();
+
+    uint8_t GetServerCount();
+    const NtpServerStats& GetServer(uint8_t idx);
+    int GetPreferredServer();
+    time_t GetLastSync();
+
+private:
+    int SelectServer();
+    void Resolve(uint8_t idx);
+    bool SendRequest(uint8_t idx);
+    void ReceiveReply();
+    void ServerFailed(uint8_t idx);
+#if LWIP_VERSION_MAJOR == 1
+    static void DnsFound(const char* name, ip_addr_t* ipaddr, void* arg);
+#else
+    static void DnsFound(const char* name, const ip_addr_t* ipaddr, void* arg);
+#endif
+
+    WiFiUDP udp_;
+    NtpServerStats servers_[NTP_SERVERS_MAXIMUM];
+    uint8_t server_count_;
+
+    bool request_pending_;
+    uint8_t request_server_;
+    uint32_t request_sent_millis_;
+    uint64_t request_sent_epoch_millis_;
+    uint8_t request_transmit_[8];  // transmit timestamp of the request, the reply must echo it
+
+    time_t last_sync_;
+};
+
+extern NtpServerPool NtpServers;
+
+#endif // #ifndef NTPSERVERPOOL_H
@@ -0,0 +1,138 @@
+//
+//  RequirementTable.cpp - Planner-side copy of the watch requirements in packed parallel arrays.
+//  License: MIT
+//
+
+#include "RequirementTable.h"
+
+RequirementTable::RequirementTable()
+    : all_dirty_(true),
+      pending_(true)
+{
+}
+
+void RequirementTable::Invalidate(size_t supplier)
+{
+    if (supplier < dirty_.size())
+    {
+        dirty_[supplier] = true;
+    }
+    else
+    {
+        all_dirty_ = true;
+    }
+    pending_ = true;
+}
+
+// Called before every scan, it returns at once if nothing changed
+void RequirementTable::Update(std::vector<WatchMovementSupplier>& suppliers)
+{
+    if (first_watch_.size() != suppliers.size() + 1)
+    {
+        all_dirty_ = true;
+    }
+    else if (!pending_)
+    {
+        return;
+    }
+
+    for (size_t idx = 0; idx < suppliers.size() && !all_dirty_; idx++)
+    {
+        if (dirty_[idx] && suppliers[idx].GetAllRequirements().size() != (size_t)(first_watch_[idx + 1] - first_watch_[idx]))
+        {
+            all_dirty_ = true; // the slices of the following suppliers move
+        }
+    }
+
+    if (all_dirty_)
+    {
+        Rebuild(suppliers);
+    }
+    else
+    {
+        for (size_t idx = 0; idx < suppliers.size(); idx++)
+        {
+            if (dirty_[idx])
+            {
+                RebuildSupplier(suppliers[idx], idx);
+            }
+        }
+    }
+    pending_ = false;
+}
+
+// Turns of the most demanding watch, the stepper has to provide them
+uint16_t RequirementTable::GetTurnsPerDay(size_t supplier)
+{
+    return supplier_turns_per_day_[supplier];
+}
+
+// 1 if the stepper has to turn clockwise, -1 if counterclockwise and 0 if it may alternate
+int8_t RequirementTable::GetRequiredDirection(size_t supplier)
+{
+    return required_direction_[supplier];
+}
+
+double RequirementTable::GetGearRatio(size_t supplier)
+{
+    return gear_ratio_[supplier];
+}
+
+void RequirementTable::Rebuild(std::vector<WatchMovementSupplier>& suppliers)
+{
+    size_t watch_count = 0;
+    first_watch_.resize(suppliers.size() + 1);
+    for (size_t idx = 0; idx < suppliers.size(); idx++)
+    {
+        first_watch_[idx] = (uint16_t)watch_count;
+        watch_count += suppliers[idx].GetAllRequirements().size();
+    }
+    first_watch_[suppliers.size()] = (uint16_t)watch_count;
+
+    turns_per_day_.resize(watch_count);
+    turning_direction_.resize(watch_count);
+    turning_like_stepper_.resize(watch_count);
+    gear_ratio_.resize(suppliers.size());
+    supplier_turns_per_day_.resize(suppliers.size());
+    required_direction_.resize(suppliers.size());
+    dirty_.assign(suppliers.size(), false);
+    for (size_t idx = 0; idx < suppliers.size(); idx++)
+    {
+        RebuildSupplier(suppliers[idx], idx);
+    }
+    all_dirty_ = false;
+}
+
+// Copies the requirements of one supplier into its slice and derives what the planner reads.
+// Watches not turning like the stepper turn the other way, contradicting requirements alternate.
+void RequirementTable::RebuildSupplier(WatchMovementSupplier& supplier, size_t idx)
+{
+    uint16_t turns_per_day = 0;
+    int8_t direction = 0;
+    bool contradicting = false;
+    size_t watch = first_watch_[idx];
+    for (auto& requirement : supplier.GetAllRequirements())
+    {
+        turns_per_day_[watch] = (uint16_t)constrain(requirement.first.GetRevolutionsPerDay(), 0, 0xFFFF);
+        turning_direction_[watch] = (uint8_t)requirement.first.GetTurningDirection();
+        turning_like_stepper_[watch] = requirement.second;
+        watch++;
+    }
+
+    for (watch = first_watch_[idx]; watch < first_watch_[idx + 1]; watch++)
+    {
+        turns_per_day = max(turns_per_day, turns_per_day_[watch]);
+        if (turning_direction_[watch] == BOTHDIRECTIONS)
+        {
+            continue;
+        }
+        int8_t stepper_direction = ((turning_direction_[watch] == CLOCKWISEONLY) == turning_like_stepper_[watch]) ? 1 : -1;
+        contradicting = contradicting || (direction != 0 && direction != stepper_direction);
+        direction = stepper_direction;
+    }
+
+    gear_ratio_[idx] = supplier.GetGearRatio();
+    supplier_turns_per_day_[idx] = turns_per_day;
+    required_direction_[idx] = contradicting ? 0 : direction;
+    dirty_[idx] = false;
+}
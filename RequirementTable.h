@@ -0,0 +1,49 @@
+//
+//  RequirementTable.h - Planner-side copy of the watch requirements in packed parallel arrays.
+//  License: MIT
+//
+#ifndef REQUIREMENTTABLE_H
+#define REQUIREMENTTABLE_H
+
+#include <Arduino.h>
+#include <vector>
+
+#include "WatchMovementSupplier.h"
+
+#define REQUIREMENTS_ALL_SUPPLIERS ((size_t)-1)  // Invalidate() argument for a change of every supplier
+
+// The planner scans only these arrays, never the requirement vectors with their inline names.
+// Watches of supplier s are at [first_watch_[s], first_watch_[s + 1]). Suppliers are rebuilt by
+// Update() once they have been invalidated, all of them if the number of suppliers or watches changed.
+class RequirementTable
+{
+public:
+    RequirementTable();
+
+    void Invalidate(size_t supplier);
+    void Update(std::vector<WatchMovementSupplier>& suppliers);
+
+    uint16_t GetTurnsPerDay(size_t supplier);
+    int8_t GetRequiredDirection(size_t supplier);
+    double GetGearRatio(size_t supplier);
+
+private:
+    void Rebuild(std::vector<WatchMovementSupplier>& suppliers);
+    void RebuildSupplier(WatchMovementSupplier& supplier, size_t idx);
+
+    // per watch
+    std::vector<uint16_t> turns_per_day_;
+    std::vector<uint8_t> turning_direction_;   // TurningDirection
+    std::vector<bool> turning_like_stepper_;   // one bit per watch
+
+    // per supplier
+    std::vector<uint16_t> first_watch_;        // one more entry than suppliers
+    std::vector<double> gear_ratio_;
+    std::vector<uint16_t> supplier_turns_per_day_;
+    std::vector<int8_t> required_direction_;
+    std::vector<bool> dirty_;
+    bool all_dirty_;
+    bool pending_;                              // anything invalidated since the last Update()
+};
+
+#endif // #ifndef REQUIREMENTTABLE_H
@@ -0,0 +1,46 @@
+//
+//  ResponseBufferPool.cpp - Shared fixed-size chunks for assembling HTTP responses.
+//  License: MIT
+//
+
+#include "ResponseBufferPool.h"
+
+ResponseBufferPool ResponsePool;
+
+ResponseBufferPool::ResponseBufferPool()
+{
+    for (size_t i = 0; i < RESPONSE_CHUNK_COUNT; i++)
+    {
+        in_use_[i] = false;
+    }
+}
+
+// Returns a free chunk or nullptr if all chunks are held
+char* ResponseBufferPool::Acquire()
+{
+    for (size_t i = 0; i < RESPONSE_CHUNK_COUNT; i++)
+    {
+        if (!in_use_[i])
+        {
+            in_use_[i] = true;
+            return chunks_[i];
+        }
+    }
+    return nullptr;
+}
+
+void ResponseBufferPool::Release(char* chunk)
+{
+    for (size_t i = 0; i < RESPONSE_CHUNK_COUNT; i++)
+    {
+        if (chunks_[i] == chunk)
+        {
+            in_use_[i] = false;
+        }
+    }
+}
+
+size_t ResponseBufferPool::GetChunkSize()
+{
+    return RESPONSE_CHUNK_SIZE;
+}
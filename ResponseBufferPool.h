@@ -0,0 +1,29 @@
+//
+//  ResponseBufferPool.h - Shared fixed-size chunks for assembling HTTP responses.
+//  License: MIT
+//
+#ifndef RESPONSEBUFFERPOOL_H
+#define RESPONSEBUFFERPOOL_H
+
+#include <Arduino.h>
+
+#define RESPONSE_CHUNK_SIZE  1460 // TCP MSS of the ESP8266 lwIP stack, so every flushed chunk fills one segment
+#define RESPONSE_CHUNK_COUNT 2
+
+class ResponseBufferPool
+{
+public:
+    ResponseBufferPool();
+
+    char* Acquire();
+    void Release(char* chunk);
+    size_t GetChunkSize();
+
+private:
+    char chunks_[RESPONSE_CHUNK_COUNT][RESPONSE_CHUNK_SIZE];
+    bool in_use_[RESPONSE_CHUNK_COUNT];
+};
+
+extern ResponseBufferPool ResponsePool;
+
+#endif // #ifndef RESPONSEBUFFERPOOL_H
@@ -0,0 +1,40 @@
+//
+//  ResponseCache.cpp - Serialized response of a dynamic endpoint together with its ETag.
+//  License: MIT
+//
+
+#include "ResponseCache.h"
+
+ResponseCache::ResponseCache()
+    : valid_(false)
+{
+}
+
+bool ResponseCache::IsValid()
+{
+    return valid_;
+}
+
+// Called by every mutator of the underlying data, the next request serializes again
+void ResponseCache::Invalidate()
+{
+    valid_ = false;
+}
+
+void ResponseCache::Store(const String& body)
+{
+    body_ = body;
+    // Derived from the content, so it stays valid across reboots as long as the data is unchanged
+    etag_ = "\"" + String(Fnv1a(body_.c_str(), body_.length(), FNV1A_OFFSET_BASIS), HEX) + "\"";
+    valid_ = true;
+}
+
+const String& ResponseCache::GetBody()
+{
+    return body_;
+}
+
+const String& ResponseCache::GetETag()
+{
+    return etag_;
+}
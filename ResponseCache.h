@@ -0,0 +1,29 @@
+//
+//  ResponseCache.h - Serialized response of a dynamic endpoint together with its ETag.
+//  License: MIT
+//
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <Arduino.h>
+
+#include "Fnv1a.h"
+
+class ResponseCache
+{
+public:
+    ResponseCache();
+
+    bool IsValid();
+    void Invalidate();
+    void Store(const String& body);
+    const String& GetBody();
+    const String& GetETag();
+
+private:
+    String body_;
+    String etag_;
+    bool valid_;
+};
+
+#endif // #ifndef RESPONSECACHE_H
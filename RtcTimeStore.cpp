@@ -0,0 +1,67 @@
+//
+//  RtcTimeStore.cpp - Last known time kept in RTC memory across resets.
+//  License: MIT
+//
+
+#include "RtcTimeStore.h"
+#include "Crc32.h"
+
+extern "C" {
+    #include "user_interface.h"
+}
+
+RtcTimeStore RtcTime;
+
+RtcTimeStore::RtcTimeStore()
+    : last_save_millis_(0)
+{
+}
+
+// RTC memory only survives resets, after power loss or deep sleep the time in between is unknown
+bool RtcTimeStore::IsMemoryKept()
+{
+    uint32_t reason = ESP.getResetInfoPtr()->reason;
+    return reason != REASON_DEFAULT_RST && reason != REASON_DEEP_SLEEP_AWAKE;
+}
+
+// Gives the time at this moment and its error bound if the previous run left a valid record
+bool RtcTimeStore::Restore(uint64_t& epoch_millis, uint32_t& error_ms)
+{
+    if (!IsMemoryKept())
+    {
+        return false;
+    }
+
+    RtcTimeRecord record;
+    if (!ESP.rtcUserMemoryRead(RTC_TIME_RECORD_OFFSET, (uint32_t*)&record, sizeof(record)))
+    {
+        return false;
+    }
+    if (record.magic != RTC_TIME_RECORD_MAGIC || record.crc != Crc32(&record, offsetof(RtcTimeRecord, crc)))
+    {
+        return false;
+    }
+
+    epoch_millis = ((uint64_t)record.epoch_millis_high << 32 | record.epoch_millis_low) + millis();
+    error_ms     = record.error_ms + RTC_TIME_SAVE_INTERVAL + RTC_TIME_BOOT_ERROR_MS;
+    return true;
+}
+
+// Cheap enough to ask every loop
+bool RtcTimeStore::IsSaveDue()
+{
+    return last_save_millis_ == 0 || millis() - last_save_millis_ >= RTC_TIME_SAVE_INTERVAL;
+}
+
+void RtcTimeStore::Save(uint64_t epoch_millis, uint32_t error_ms)
+{
+    last_save_millis_ = millis();
+
+    RtcTimeRecord record;
+    record.magic             = RTC_TIME_RECORD_MAGIC;
+    record.epoch_millis_low  = (uint32_t)epoch_millis;
+    record.epoch_millis_high = (uint32_t)(epoch_millis >> 32);
+    record.error_ms          = error_ms;
+    record.crc               = Crc32(&record, offsetof(RtcTimeRecord, crc));
+    ESP.rtcUserMemoryWrite(RTC_TIME_RECORD_OFFSET, (uint32_t*)&record, sizeof(record));
+}
@@ -0,0 +1,40 @@
+//
+//  RtcTimeStore.h - Last known time kept in RTC memory across resets.
+//  License: MIT
+//
+#ifndef RTCTIMESTORE_H
+#define RTCTIMESTORE_H
+
+#include <Arduino.h>
+
+#define RTC_TIME_RECORD_OFFSET   32    // in 4 byte blocks, the first 128 bytes of RTC user memory belong to OTA
+#define RTC_TIME_RECORD_MAGIC    0x57575443UL
+#define RTC_TIME_SAVE_INTERVAL   1000  // ms between two saves, the time lost at a reset is at most this
+#define RTC_TIME_BOOT_ERROR_MS   1000  // allowance for the reset itself and the boot ROM, before millis() starts
+
+struct RtcTimeRecord
+{
+    uint32_t magic;
+    uint32_t epoch_millis_low;
+    uint32_t epoch_millis_high;
+    uint32_t error_ms;
+    uint32_t crc;
+};
+
+class RtcTimeStore
+{
+public:
+    RtcTimeStore();
+
+    bool IsMemoryKept();
+    bool Restore(uint64_t& epoch_millis, uint32_t& error_ms);
+    bool IsSaveDue();
+    void Save(uint64_t epoch_millis, uint32_t error_ms);
+
+private:
+    uint32_t last_save_millis_;
+};
+
+extern RtcTimeStore RtcTime;
+
+#endif // #ifndef RTCTIMESTORE_H
@@ -0,0 +1,195 @@
+//
+//  SettingsStore.cpp - Versioned settings record with CRC in two alternating slots, read and committed as a whole.
+//  License: MIT
+//
+
+#include "SettingsStore.h"
+
+static_assert(sizeof(SettingsHeader) + sizeof(SettingsRecord) <= LOGSTORE_MAX_RECORD_SIZE, "SettingsRecord does not fit into a log record");
+
+SettingsStore Settings;
+
+SettingsStore::SettingsStore()
+    : valid_(false),
+      loaded_version_(0),
+      generation_(0),
+      active_slot_(0)
+{
+    memset(&record_, 0, sizeof(record_));
+}
+
+// The record lives in two slots of the flash log, a commit always writes the slot not holding the
+// current record. Only the headers are read to find the newest slot, the older one is the fallback
+// if the newest does not pass its CRC. Settings written by firmware before the flash log are still in
+// the EEPROM sector, they are imported once. Returns false and leaves a zeroed record if nothing valid is stored.
+bool SettingsStore::Load()
+{
+    SettingsHeader headers[SETTINGS_SLOT_COUNT];
+    bool present[SETTINGS_SLOT_COUNT];
+    for (uint8_t slot = 0; slot < SETTINGS_SLOT_COUNT; slot++)
+    {
+        present[slot] = ReadSlotHeader(slot, headers[slot]);
+    }
+
+    valid_ = false;
+    generation_ = 0;
+    uint8_t newest = (present[1] && (!present[0] || headers[1].generation > headers[0].generation)) ? 1 : 0;
+    uint8_t order[SETTINGS_SLOT_COUNT] = { newest, (uint8_t)(1 - newest) };
+    for (uint8_t slot : order)
+    {
+        SettingsHeader header;
+        if (present[slot] && ReadSlot(slot, header, record_))
+        {
+            valid_ = true;
+            loaded_version_ = header.version;
+            generation_ = header.generation;
+            active_slot_ = slot;
+            break;
+        }
+    }
+
+    if (!present[0] && !present[1])
+    {
+        SettingsHeader header;
+        EEPROM.begin(SETTINGS_STORE_SIZE);
+        valid_ = Parse(EEPROM.getConstDataPtr(), SETTINGS_STORE_SIZE, header, record_);
+        EEPROM.end();
+        loaded_version_ = valid_ ? header.version : 0;
+        if (valid_ && Commit())
+        {
+            Serial.println("Settings imported from EEPROM");
+        }
+    }
+    if (!valid_)
+    {
+        memset(&record_, 0, sizeof(record_));
+        loaded_version_ = 0;
+    }
+
+    if (valid_ && loaded_version_ != SETTINGS_STORE_VERSION)
+    {
+        Serial.printf("Settings of version %u migrated to version %u\n", loaded_version_, SETTINGS_STORE_VERSION);
+    }
+    return valid_;
+}
+
+// Writes the slot not holding the current record. The current one stays untouched, so it is still
+// there for Load() if the new one is lost, and for Rollback().
+bool SettingsStore::Commit()
+{
+    uint8_t slot = valid_ ? 1 - active_slot_ : active_slot_;
+    uint8_t image[sizeof(SettingsHeader) + sizeof(SettingsRecord)];
+    SettingsHeader header;
+    header.magic = SETTINGS_SLOT_MAGIC;
+    header.version = SETTINGS_STORE_VERSION;
+    header.size = sizeof(record_);
+    header.crc = Crc32(&record_, sizeof(record_));
+    header.generation = generation_ + 1;
+    memcpy(image, &header, sizeof(header));
+    memcpy(image + sizeof(header), &record_, sizeof(record_));
+
+    bool committed = FlashLog.Write(GetSlotKey(slot), image, sizeof(image));
+    if (committed)
+    {
+        valid_ = true;
+        loaded_version_ = SETTINGS_STORE_VERSION;
+        generation_ = header.generation;
+        active_slot_ = slot;
+    }
+    return committed;
+}
+
+// Makes the record before the last commit current again by committing it once more. A second
+// rollback thus returns to the record that was rolled back.
+bool SettingsStore::Rollback()
+{
+    SettingsHeader header;
+    SettingsRecord previous;
+    if (!valid_ || !ReadSlot(1 - active_slot_, header, previous))
+    {
+        return false;
+    }
+    record_ = previous;
+    return Commit();
+}
+
+bool SettingsStore::IsValid()
+{
+    return valid_;
+}
+
+uint16_t SettingsStore::GetLoadedVersion()
+{
+    return loaded_version_;
+}
+
+uint32_t SettingsStore::GetGeneration()
+{
+    return generation_;
+}
+
+SettingsRecord& SettingsStore::GetRecord()
+{
+    return record_;
+}
+
+uint16_t SettingsStore::GetSlotKey(uint8_t slot)
+{
+    return (slot == 0) ? LOGSTORE_KEY_SETTINGS : LOGSTORE_KEY_SETTINGS_B;
+}
+
+// Reads only the header, a header without generation counts as generation 0
+bool SettingsStore::ReadSlotHeader(uint8_t slot, SettingsHeader& header)
+{
+    int length = FlashLog.Read(GetSlotKey(slot), &header, sizeof(header));
+    if (length < (int)offsetof(SettingsHeader, generation))
+    {
+        return false;
+    }
+    if (header.magic == SETTINGS_STORE_MAGIC)
+    {
+        header.generation = 0;
+        return true;
+    }
+    return header.magic == SETTINGS_SLOT_MAGIC && length >= (int)sizeof(header);
+}
+
+bool SettingsStore::ReadSlot(uint8_t slot, SettingsHeader& header, SettingsRecord& record)
+{
+    int length = FlashLog.GetLength(GetSlotKey(slot));
+    if (length < 0)
+    {
+        return false;
+    }
+    uint8_t* image = new uint8_t[length];
+    FlashLog.Read(GetSlotKey(slot), image, length);
+    bool valid = Parse(image, length, header, record);
+    delete[] image;
+    return valid;
+}
+
+// Validates header and CRC of an image of length bytes and copies the record out of it
+bool SettingsStore::Parse(const uint8_t* image, size_t length, SettingsHeader& header, SettingsRecord& record)
+{
+    memset(&record, 0, sizeof(record));
+    if (length < sizeof(header.magic))
+    {
+        return false;
+    }
+    memcpy(&header.magic, image, sizeof(header.magic));
+    size_t header_size = (header.magic == SETTINGS_SLOT_MAGIC)  ? sizeof(header) :
+                         (header.magic == SETTINGS_STORE_MAGIC) ? offsetof(SettingsHeader, generation) : 0;
+    if (header_size == 0 || length < header_size)
+    {
+        return false;
+    }
+    header.generation = 0;
+    memcpy(&header, image, header_size);
+    if (header.size > length - header_size || header.crc != Crc32(image + header_size, header.size))
+    {
+        return false;
+    }
+    // a newer firmware may have appended fields, they are dropped
+    memcpy(&record, image + header_size, min((size_t)header.size, sizeof(record)));
+    return true;
+}
@@ -0,0 +1,107 @@
+//
+//  SettingsStore.h - Versioned settings record with CRC in two alternating slots, read and committed as a whole.
+//  License: MIT
+//
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "Crc32.h"
+#include "LogStore.h"
+#include "TimeZone.h"
+#include "WeeklySchedule.h"
+#include "WatchRequirement.h"
+
+#define SETTINGS_STORE_MAGIC    0x57575353UL  // "WWSS", header without generation as in EEPROM and the first flash log records
+#define SETTINGS_SLOT_MAGIC     0x57575347UL  // "WWSG", header with generation
+#define SETTINGS_SLOT_COUNT     2
+#define SETTINGS_STORE_VERSION  2
+#define SETTINGS_STORE_SIZE     512           // bytes of EEPROM emulation used before the flash log, only read to import
+#define SETTINGS_MAX_SUPPLIERS  2
+#define SETTINGS_MAX_WATCHES    3             // per supplier
+
+struct __attribute__((packed)) SettingsHeader
+{
+    uint32_t magic;
+    uint16_t version;   // SETTINGS_STORE_VERSION of the firmware that wrote the record
+    uint16_t size;      // bytes of SettingsRecord that follow the header
+    uint32_t crc;       // over those bytes
+    uint32_t generation; // incremented with every commit, the slot with the highest one is current. Only with SETTINGS_SLOT_MAGIC.
+};
+
+struct __attribute__((packed)) StoredScheduleWindow
+{
+    uint8_t weekdays;
+    uint16_t from;
+    uint16_t to;
+};
+
+struct __attribute__((packed)) StoredTimesettings
+{
+    char timezone[TIMEZONE_POSIX_MAX_LEN + 1];
+    uint8_t window_count;
+    StoredScheduleWindow windows[SCHEDULE_MAX_WINDOWS];
+};
+
+struct __attribute__((packed)) StoredWatch
+{
+    char name[WATCH_NAME_MAX_LEN + 1];
+    uint16_t revolutions_per_day;
+    uint8_t turning_direction;      // TurningDirection
+    uint8_t turning_like_stepper;
+};
+
+struct __attribute__((packed)) StoredSupplier
+{
+    int16_t rpm;
+    uint8_t watch_count;
+    StoredWatch watches[SETTINGS_MAX_WATCHES];
+};
+
+// supplier_count 0 means the built-in configuration of SetDefaultWatches() is used
+struct __attribute__((packed)) StoredWatches
+{
+    uint8_t supplier_count;
+    StoredSupplier suppliers[SETTINGS_MAX_SUPPLIERS];
+};
+
+// Fields are only ever appended and SETTINGS_STORE_VERSION is bumped with them. A record written by
+// an older version is read up to its size, the fields it does not know are zero, which every
+// owner of a section has to treat as "use the defaults".
+struct __attribute__((packed)) SettingsRecord
+{
+    StoredTimesettings timesettings;      // since version 1
+    StoredWatches watches;                // since version 2
+};
+
+class SettingsStore
+{
+public:
+    SettingsStore();
+
+    bool Load();
+    bool Commit();
+    bool Rollback();
+    bool IsValid();
+    uint16_t GetLoadedVersion();
+    uint32_t GetGeneration();
+    SettingsRecord& GetRecord();
+
+private:
+    static uint16_t GetSlotKey(uint8_t slot);
+    bool ReadSlotHeader(uint8_t slot, SettingsHeader& header);
+    bool ReadSlot(uint8_t slot, SettingsHeader& header, SettingsRecord& record);
+    static bool Parse(const uint8_t* image, size_t length, SettingsHeader& header, SettingsRecord& record);
+
+    SettingsRecord record_;
+    bool valid_;
+    uint16_t loaded_version_;
+    uint32_t generation_;
+    uint8_t active_slot_;
+};
+
+extern SettingsStore Settings;
+
+#endif // #ifndef SETTINGSSTORE_H
@@ -143,20 +143,19 @@ int year(time_t t) { // the year for the given time
 /* functions to convert to and from system time */
 /* These are for interfacing with time serivces and are not normally needed in a sketch */
 
-// leap year calulator expects year argument as years offset from 1970
-#define LEAP_YEAR(Y)     ( ((1970+(Y))>0) && !((1970+(Y))%4) && ( ((1970+(Y))%100) || !((1970+(Y))%400) ) )
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "leap day of a year divisible by 400");
+static_assert(daysFromCivil(2106, 2, 7) == 49710, "last day representable in 32 bit seconds");
+static_assert(yearFromDays(11016) == 2000 && monthFromDays(11016) == 2 && dayFromDays(11016) == 29, "29 feb 2000");
+static_assert(monthFromDays(47540) == 2 && dayFromDays(47540) == 28 && monthFromDays(47541) == 3 && dayFromDays(47541) == 1, "no leap day in 2100");
 
-static  const uint8_t monthDays[]={31,28,31,30,31,30,31,31,30,31,30,31}; // API starts months from 1, this array starts from 0
- 
 void breakTime(time_t timeInput, tmElements_t &tm){
 // break the given time_t into time components
 // this is a more compact version of the C library localtime function
 // note that year is offset from 1970 !!!
 
-  uint8_t year;
-  uint8_t month, monthLength;
   uint32_t time;
-  unsigned long days;
+  uint32_t dayOfEra, yearOfEra, marchDay;
 
   time = (uint32_t)timeInput;
   tm.Second = time % 60;
@@ -166,39 +165,14 @@ void breakTime(time_t timeInput, tmElements_t &tm){
   tm.Hour = time % 24;
   time /= 24; // now it is days
   tm.Wday = ((time + 4) % 7) + 1;  // Sunday is day 1 
-  
-  year = 0;  
-  days = 0;
-  while((unsigned)(days += (LEAP_YEAR(year) ? 366 : 365)) <= time) {
-    year++;
-  }
-  tm.Year = year; // year is offset from 1970 
-  
-  days -= LEAP_YEAR(year) ? 366 : 365;
-  time  -= days; // now it is days in this year, starting at 0
-  
-  days=0;
-  month=0;
-  monthLength=0;
-  for (month=0; month<12; month++) {
-    if (month==1) { // february
-      if (LEAP_YEAR(year)) {
-        monthLength=29;
-      } else {
-        monthLength=28;
-      }
-    } else {
-      monthLength = monthDays[month];
-    }
-    
-    if (time >= monthLength) {
-      time -= monthLength;
-    } else {
-        break;
-    }
-  }
-  tm.Month = month + 1;  // jan is month 1  
-  tm.Day = time + 1;     // day of month
+
+  // same steps as yearFromDays() and friends, without recomputing the shared parts
+  dayOfEra  = civilDayOfEra(time);
+  yearOfEra = civilYearOfEra(dayOfEra);
+  marchDay  = civilDayOfYearOfEra(dayOfEra, yearOfEra);
+  tm.Month  = civilMonthFromMarchDay(marchDay);  // jan is month 1
+  tm.Day    = civilDayFromMarchDay(marchDay);    // day of month
+  tm.Year   = CalendarYrToTm((time + 719468UL) / 146097UL * 400 + yearOfEra + (tm.Month <= 2)); // year is offset from 1970
 }
 
 time_t makeTime(const tmElements_t &tm){   
@@ -206,26 +180,9 @@ time_t makeTime(const tmElements_t &tm){
 // note year argument is offset from 1970 (see macros in time.h to convert to other formats)
 // previous version used full four digit year (or digits since 2000),i.e. 2009 was 2009 or 9
   
-  int i;
   uint32_t seconds;
 
-  // seconds from 1970 till 1 jan 00:00:00 of the given year
-  seconds= tm.Year*(SECS_PER_DAY * 365);
-  for (i = 0; i < tm.Year; i++) {
-    if (LEAP_YEAR(i)) {
-      seconds +=  SECS_PER_DAY;   // add extra days for leap years
-    }
-  }
-  
-  // add days for this year, months start from 1
-  for (i = 1; i < tm.Month; i++) {
-    if ( (i == 2) && LEAP_YEAR(tm.Year)) { 
-      seconds += SECS_PER_DAY * 29;
-    } else {
-      seconds += SECS_PER_DAY * monthDays[i-1];  //monthDay array starts from 0
-    }
-  }
-  seconds+= (tm.Day-1) * SECS_PER_DAY;
+  seconds = daysFromCivil(tmYearToCalendar(tm.Year), tm.Month, tm.Day) * SECS_PER_DAY;
   seconds+= tm.Hour * SECS_PER_HOUR;
   seconds+= tm.Minute * SECS_PER_MIN;
   seconds+= tm.Second;
@@ -249,12 +206,15 @@ time_t sysUnsyncedTime = 0; // the time sysTime unadjusted by sync
 
 time_t now() {
     // calculate number of seconds passed since last call to now()
-  while (millis() - prevMillis >= 1000) {
-        // millis() and prevMillis are both unsigned ints thus the subtraction will always be the absolute value of the difference
-    sysTime++;
-    prevMillis += 1000;    
+    // millis() and prevMillis are both unsigned ints thus the subtraction will always be the absolute value of the difference
+  uint32_t elapsedMillis = millis() - prevMillis;
+  if (elapsedMillis >= 1000) {
+        // a single division regardless of how long the last call is ago, the remaining milliseconds stay in prevMillis
+    uint32_t elapsedSecs = elapsedMillis / 1000;
+    sysTime += elapsedSecs;
+    prevMillis += elapsedSecs * 1000;
 #ifdef TIME_DRIFT_INFO
-    sysUnsyncedTime++; // this can be compared to the synced time to measure long term drift     
+    sysUnsyncedTime += elapsedSecs; // this can be compared to the synced time to measure long term drift     
 #endif
   }
   if (nextSyncTime <= sysTime) {
@@ -271,6 +231,10 @@ time_t now() {
   return (time_t)sysTime;
 }
 
+time_t nowCached() {
+  return (time_t)sysTime;
+}
+
 void setTime(time_t t) { 
 #ifdef TIME_DRIFT_INFO
  if(sysUnsyncedTime == 0) 
@@ -118,16 +118,24 @@ int     year();            // the full four digit year: (2009, 2010 etc)
 int     year(time_t t);    // the year for the given time
 
 time_t now();              // return the current time as seconds since Jan 1 1970 
+time_t nowCached();        // the time as of the last call to now(), without advancing the clock or syncing
 void    setTime(time_t t);
 void    setTime(int hr,int min,int sec,int day, int month, int yr);
 void    adjustTime(long adjustment);
 
 /* date strings */ 
 #define dt_MAX_STRING_LEN 9 // length of longest date string (excluding terminating null)
-char* monthStr(uint8_t month);
-char* dayStr(uint8_t day);
+#define dt_SHORT_STR_LEN  3 // length of the short strings (excluding terminating null)
+char* monthStr(uint8_t month);      // these four share one static buffer, the result is
+char* dayStr(uint8_t day);          // overwritten by the next call of any of them
 char* monthShortStr(uint8_t month);
 char* dayShortStr(uint8_t day);
+char* monthStr(uint8_t month, char* buf);      // buf must hold dt_MAX_STRING_LEN+1 chars
+char* dayStr(uint8_t day, char* buf);
+char* monthShortStr(uint8_t month, char* buf); // buf must hold dt_SHORT_STR_LEN+1 chars
+char* dayShortStr(uint8_t day, char* buf);
+const char* monthStr_P(uint8_t month);         // the string in flash, read it with the *_P functions
+const char* dayStr_P(uint8_t day);
     
 /* time sync functions    */
 timeStatus_t timeStatus(); // indicates if time has been set and recently synchronized
@@ -138,6 +146,51 @@ void    setSyncInterval(time_t interval); // set the number of seconds between r
 void breakTime(time_t time, tmElements_t &tm);  // break time_t into elements
 time_t makeTime(const tmElements_t &tm);  // convert time elements into time_t
 
+/* constant time civil calendar conversion (proleptic gregorian, 1970 to 2106)  */
+/* days are counted from 1 jan 1970, years are full four digit years            */
+/* internally years start on 1 march, so the leap day is the last day of a year */
+/* all of them are constexpr and can be checked at compile time                 */
+constexpr uint32_t civilDayOfMarchYear(uint8_t month, uint8_t day) {
+  return (153UL * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+}
+constexpr uint32_t civilDaysFromMarchYear(uint32_t marchYear, uint8_t month, uint8_t day) {
+  return (marchYear / 400) * 146097UL  // days of full 400 year eras
+       + (marchYear % 400) * 365 + (marchYear % 400) / 4 - (marchYear % 400) / 100
+       + civilDayOfMarchYear(month, day)
+       - 719468UL;                     // days from 1 mar 0000 to 1 jan 1970
+}
+constexpr uint32_t daysFromCivil(uint16_t year, uint8_t month, uint8_t day) {
+  return civilDaysFromMarchYear(year - (month <= 2), month, day);
+}
+
+constexpr uint32_t civilDayOfEra(uint32_t days) {
+  return (days + 719468UL) % 146097UL;
+}
+constexpr uint32_t civilYearOfEra(uint32_t dayOfEra) {
+  return (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+}
+constexpr uint32_t civilDayOfYearOfEra(uint32_t dayOfEra, uint32_t yearOfEra) {
+  return dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+}
+constexpr uint32_t civilMarchDayFromDays(uint32_t days) {
+  return civilDayOfYearOfEra(civilDayOfEra(days), civilYearOfEra(civilDayOfEra(days)));
+}
+constexpr uint8_t civilMonthFromMarchDay(uint32_t marchDay) {
+  return (5 * marchDay + 2) / 153 < 10 ? (5 * marchDay + 2) / 153 + 3 : (5 * marchDay + 2) / 153 - 9;
+}
+constexpr uint8_t civilDayFromMarchDay(uint32_t marchDay) {
+  return marchDay - (153 * ((5 * marchDay + 2) / 153) + 2) / 5 + 1;
+}
+constexpr uint8_t monthFromDays(uint32_t days) {
+  return civilMonthFromMarchDay(civilMarchDayFromDays(days));
+}
+constexpr uint8_t dayFromDays(uint32_t days) {
+  return civilDayFromMarchDay(civilMarchDayFromDays(days));
+}
+constexpr uint16_t yearFromDays(uint32_t days) {
+  return (days + 719468UL) / 146097UL * 400 + civilYearOfEra(civilDayOfEra(days)) + (monthFromDays(days) <= 2);
+}
+
 } // extern "C++"
 #endif // __cplusplus
 #endif /* _Time_h */
@@ -0,0 +1,331 @@
+//
+//  TimeZone.cpp - POSIX TZ rules (e.g. "CET-1CEST,M3.5.0,M10.5.0/3") with a cached offset interval.
+//  License: MIT
+//
+
+#include "TimeZone.h"
+
+TimeZone::TimeZone()
+{
+    SetPosix(TIMEZONE_DEFAULT_POSIX);
+}
+
+// Keeps the previous rules and returns false if posix can not be parsed
+bool TimeZone::SetPosix(const char* posix)
+{
+    TimeZone parsed(*this);
+    if (!Parse(posix, parsed))
+    {
+        return false;
+    }
+    *this = parsed;
+    strncpy(posix_, posix, TIMEZONE_POSIX_MAX_LEN);
+    posix_[TIMEZONE_POSIX_MAX_LEN] = '\0';
+
+    // empty interval, the next conversion fills the cache
+    cache_begin_ = 0;
+    cache_end_ = 0;
+    return true;
+}
+
+const char* TimeZone::GetPosix()
+{
+    return posix_;
+}
+
+bool TimeZone::IsValidPosix(const char* posix)
+{
+    TimeZone parsed;
+    return Parse(posix, parsed);
+}
+
+int32_t TimeZone::GetOffset(time_t utc)
+{
+    if ((int64_t)utc < cache_begin_ || (int64_t)utc >= cache_end_)
+    {
+        UpdateCache(utc);
+    }
+    return cache_offset_;
+}
+
+bool TimeZone::IsDst(time_t utc)
+{
+    GetOffset(utc);
+    return cache_dst_;
+}
+
+time_t TimeZone::ToLocal(time_t utc)
+{
+    return utc + GetOffset(utc);
+}
+
+// In the hour skipped by a transition the offset before the transition is used,
+// in the hour repeated by a transition the first occurence wins
+time_t TimeZone::ToUtc(time_t local)
+{
+    time_t utc = local - cache_offset_;
+    if ((int64_t)utc >= cache_begin_ && (int64_t)utc < cache_end_)
+    {
+        return utc;
+    }
+    int32_t offset = GetOffset(local - std_offset_);
+    utc = local - offset;
+    int32_t corrected = GetOffset(utc);
+    if (corrected != offset)
+    {
+        utc = local - corrected;
+    }
+    return utc;
+}
+
+time_t TimeZone::GetNextTransition(time_t utc)
+{
+    GetOffset(utc);
+    return cache_end_ > (int64_t)TIMEZONE_NO_TRANSITION ? TIMEZONE_NO_TRANSITION : (time_t)cache_end_;
+}
+
+// Transitions of the year before, this and the next year around utc, sorted,
+// give the interval with a constant offset that contains utc
+void TimeZone::UpdateCache(int64_t utc)
+{
+    if (!has_dst_)
+    {
+        cache_begin_ = INT64_MIN;
+        cache_end_ = INT64_MAX;
+        cache_offset_ = std_offset_;
+        cache_dst_ = false;
+        return;
+    }
+
+    int64_t local_days = (utc + std_offset_) / (int64_t)SECS_PER_DAY;
+    uint16_t year = yearFromDays(local_days > 0 ? (uint32_t)local_days : 0);
+
+    int64_t events[6];
+    bool dst_after[6];
+    uint8_t count = 0;
+    for (uint16_t y = (year > 1970 ? year - 1 : year); y <= year + 1; y++)
+    {
+        // DST starts while standard time is in effect and ends while DST is in effect
+        int64_t start = RuleToLocal(dst_start_, y) - std_offset_;
+        int64_t end   = RuleToLocal(dst_end_, y)   - dst_offset_;
+        for (uint8_t k = 0; k < 2; k++)
+        {
+            int64_t event = (k == 0) ? start : end;
+            uint8_t i = count++;
+            while (i > 0 && events[i - 1] > event)
+            {
+                events[i] = events[i - 1];
+                dst_after[i] = dst_after[i - 1];
+                i--;
+            }
+            events[i] = event;
+            dst_after[i] = (k == 0);
+        }
+    }
+
+    int8_t last = -1;
+    while (last + 1 < count && events[last + 1] <= utc)
+    {
+        last++;
+    }
+    cache_begin_ = (last >= 0) ? events[last] : INT64_MIN;
+    cache_end_   = (last + 1 < count) ? events[last + 1] : INT64_MAX;
+    cache_dst_   = (last >= 0) ? dst_after[last] : !dst_after[0];
+    cache_offset_ = cache_dst_ ? dst_offset_ : std_offset_;
+}
+
+// Local time of the transition in the given year, in seconds since 1 jan 1970
+int64_t TimeZone::RuleToLocal(const TimeZoneRule& rule, uint16_t year)
+{
+    uint32_t year_start = daysFromCivil(year, 1, 1);
+    uint32_t days;
+    switch (rule.type)
+    {
+        case TZ_RULE_JULIAN:
+        {
+            bool leap_year = (daysFromCivil(year, 3, 1) - daysFromCivil(year, 2, 1)) == 29;
+            days = year_start + rule.day - 1 + ((leap_year && rule.day >= 60) ? 1 : 0);
+            break;
+        }
+        case TZ_RULE_DAY_OF_YEAR:
+            days = year_start + rule.day;
+            break;
+        case TZ_RULE_MONTH_WEEK_DAY:
+        default:
+        {
+            uint32_t month_start  = daysFromCivil(year, rule.month, 1);
+            uint32_t month_end    = (rule.month == 12) ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, rule.month + 1, 1);
+            uint8_t first_weekday = (month_start + 4) % 7; // 1 jan 1970 was a thursday
+            uint32_t day = (rule.weekday + 7 - first_weekday) % 7 + (rule.week - 1) * 7;
+            if (month_start + day >= month_end)
+            {
+                day -= 7; // week 5 means the last one
+            }
+            days = month_start + day;
+            break;
+        }
+    }
+    return (int64_t)days * SECS_PER_DAY + rule.time;
+}
+
+bool TimeZone::Parse(const char* posix, TimeZone& zone)
+{
+    if (posix == nullptr || strlen(posix) > TIMEZONE_POSIX_MAX_LEN)
+    {
+        return false;
+    }
+
+    const char* p = ParseName(posix);
+    int32_t offset;
+    if (p == nullptr || (p = ParseTime(p, 24, offset)) == nullptr)
+    {
+        return false;
+    }
+    zone.std_offset_ = -offset; // POSIX offsets count west of UTC
+    zone.dst_offset_ = zone.std_offset_;
+    zone.has_dst_ = false;
+    if (*p == '\0')
+    {
+        return true;
+    }
+
+    if ((p = ParseName(p)) == nullptr)
+    {
+        return false;
+    }
+    zone.dst_offset_ = zone.std_offset_ + SECS_PER_HOUR;
+    if (*p != ',' && *p != '\0')
+    {
+        if ((p = ParseTime(p, 24, offset)) == nullptr)
+        {
+            return false;
+        }
+        zone.dst_offset_ = -offset;
+    }
+
+    if (*p == '\0')
+    {
+        // no rules given, POSIX leaves the default to the implementation, this is the US one
+        p = ",M3.2.0,M11.1.0";
+    }
+    if (*p++ != ',' || (p = ParseRule(p, zone.dst_start_)) == nullptr)
+    {
+        return false;
+    }
+    if (*p++ != ',' || (p = ParseRule(p, zone.dst_end_)) == nullptr)
+    {
+        return false;
+    }
+    zone.has_dst_ = true;
+    return *p == '\0';
+}
+
+// At least three letters or <...> with letters, digits and signs
+const char* TimeZone::ParseName(const char* p)
+{
+    const char* start = p;
+    if (*p == '<')
+    {
+        p++;
+        while (isalnum(*p) || *p == '+' || *p == '-')
+        {
+            p++;
+        }
+        if (*p != '>' || p - start < 4)
+        {
+            return nullptr;
+        }
+        return p + 1;
+    }
+    while (isalpha(*p))
+    {
+        p++;
+    }
+    return (p - start >= 3) ? p : nullptr;
+}
+
+const char* TimeZone::ParseNumber(const char* p, int min, int max, int& value)
+{
+    if (!isdigit(*p))
+    {
+        return nullptr;
+    }
+    value = 0;
+    while (isdigit(*p))
+    {
+        value = value * 10 + (*p++ - '0');
+        if (value > max)
+        {
+            return nullptr;
+        }
+    }
+    return (value >= min) ? p : nullptr;
+}
+
+// [+|-]hh[:mm[:ss]]
+const char* TimeZone::ParseTime(const char* p, int max_hours, int32_t& seconds)
+{
+    int sign = 1;
+    if (*p == '+' || *p == '-')
+    {
+        sign = (*p++ == '-') ? -1 : 1;
+    }
+    int hours, minutes = 0, secs = 0;
+    if ((p = ParseNumber(p, 0, max_hours, hours)) == nullptr)
+    {
+        return nullptr;
+    }
+    if (*p == ':' && (p = ParseNumber(p + 1, 0, 59, minutes)) != nullptr && *p == ':')
+    {
+        p = ParseNumber(p + 1, 0, 59, secs);
+    }
+    if (p == nullptr)
+    {
+        return nullptr;
+    }
+    seconds = sign * (int32_t)(hours * 3600L + minutes * 60L + secs);
+    return p;
+}
+
+// Mm.w.d, Jn or n, optionally followed by /time (default 02:00:00)
+const char* TimeZone::ParseRule(const char* p, TimeZoneRule& rule)
+{
+    int month = 1, week = 1, weekday = 0, day = 0;
+    if (*p == 'M')
+    {
+        rule.type = TZ_RULE_MONTH_WEEK_DAY;
+        if ((p = ParseNumber(p + 1, 1, 12, month)) == nullptr || *p != '.' ||
+            (p = ParseNumber(p + 1, 1, 5, week)) == nullptr || *p != '.' ||
+            (p = ParseNumber(p + 1, 0, 6, weekday)) == nullptr)
+        {
+            return nullptr;
+        }
+    }
+    else if (*p == 'J')
+    {
+        rule.type = TZ_RULE_JULIAN;
+        if ((p = ParseNumber(p + 1, 1, 365, day)) == nullptr)
+        {
+            return nullptr;
+        }
+    }
+    else
+    {
+        rule.type = TZ_RULE_DAY_OF_YEAR;
+        if ((p = ParseNumber(p, 0, 365, day)) == nullptr)
+        {
+            return nullptr;
+        }
+    }
+    rule.month = month;
+    rule.week = week;
+    rule.weekday = weekday;
+    rule.day = day;
+
+    rule.time = 2 * SECS_PER_HOUR;
+    if (*p == '/')
+    {
+        return ParseTime(p + 1, 167, rule.time);
+    }
+    return p;
+}
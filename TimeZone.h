@@ -0,0 +1,70 @@
+//
+//  TimeZone.h - POSIX TZ rules (e.g. "CET-1CEST,M3.5.0,M10.5.0/3") with a cached offset interval.
+//  License: MIT
+//
+#ifndef TIMEZONE_H
+#define TIMEZONE_H
+
+#include <Arduino.h>
+#include "TimeLib.h"
+
+#define TIMEZONE_POSIX_MAX_LEN  47
+#define TIMEZONE_DEFAULT_POSIX  "CET-1CEST,M3.5.0,M10.5.0/3" // central european time with daylight saving
+#define TIMEZONE_NO_TRANSITION  ((time_t)0x7FFFFFFFL)          // returned if the offset never changes
+
+enum TimeZoneRuleType
+{
+    TZ_RULE_MONTH_WEEK_DAY = 0, // Mm.w.d
+    TZ_RULE_JULIAN,             // Jn, 1..365, 29 feb is never counted
+    TZ_RULE_DAY_OF_YEAR         // n, 0..365, 29 feb is counted
+};
+
+struct TimeZoneRule
+{
+    TimeZoneRuleType type;
+    uint8_t month;    // 1..12
+    uint8_t week;     // 1..5, 5 is the last week of the month
+    uint8_t weekday;  // 0..6, sunday is 0
+    uint16_t day;     // for TZ_RULE_JULIAN and TZ_RULE_DAY_OF_YEAR
+    int32_t time;     // local time of day of the transition in seconds, may be negative or beyond one day
+};
+
+class TimeZone
+{
+public:
+    TimeZone();
+
+    bool SetPosix(const char* posix);
+    const char* GetPosix();
+    static bool IsValidPosix(const char* posix);
+
+    int32_t GetOffset(time_t utc);
+    bool IsDst(time_t utc);
+    time_t ToLocal(time_t utc);
+    time_t ToUtc(time_t local);
+    time_t GetNextTransition(time_t utc);
+
+private:
+    static bool Parse(const char* posix, TimeZone& zone);
+    static const char* ParseName(const char* p);
+    static const char* ParseNumber(const char* p, int min, int max, int& value);
+    static const char* ParseTime(const char* p, int max_hours, int32_t& seconds);
+    static const char* ParseRule(const char* p, TimeZoneRule& rule);
+    static int64_t RuleToLocal(const TimeZoneRule& rule, uint16_t year);
+    void UpdateCache(int64_t utc);
+
+    char posix_[TIMEZONE_POSIX_MAX_LEN + 1];
+    int32_t std_offset_;  // seconds east of UTC
+    int32_t dst_offset_;  // seconds east of UTC
+    bool has_dst_;
+    TimeZoneRule dst_start_;
+    TimeZoneRule dst_end_;
+
+    // UTC interval [begin, end) in which cache_offset_ applies, so most conversions are a compare and an add
+    int64_t cache_begin_;
+    int64_t cache_end_;
+    int32_t cache_offset_;
+    bool cache_dst_;
+};
+
+#endif // #ifndef TIMEZONE_H
@@ -2,40 +2,31 @@
 
 Timesettings::Timesettings()
 {
+    timezone_[0] = '\0';
+    schedule_.FromString(SCHEDULE_DEFAULT);
     CheckValidValues();
     timesettings_loaded_ = false;
 }
 
-//source: http://shelvin.de/eine-integer-zahl-in-das-arduiono-eeprom-schreiben/
-void Timesettings::WriteIntegerToEEPROM(int adress, int value)
-{
-    byte low, high;
-    low = value & 0xFF;
-    high = (value >> 8) & 0xFF;
-    EEPROM.write(adress, low);
-    EEPROM.write(adress + 1, high);
-    return;
-}
-
-int Timesettings::ReadIntegerFromEEPROM(int adress)
-{
-    byte low, high;
-    low = EEPROM.read(adress);
-    high = EEPROM.read(adress + 1);
-    return low + ((high << 8) & 0xFF00);
-}
-
+// Takes the values from the record read by Settings.Load() at boot
 void Timesettings::Load() {
 
-    if (EEPROM.read(SETTINGS_EEPROM_ADRESS_CHECKNUM) != SETTINGS_CHECKNUM)
+    if (!Settings.IsValid())
     {
         Reset();
         return;
     }
 
-    timezoneshift_   = ReadIntegerFromEEPROM(SETTINGS_EEPROM_ADRESS_TIMEZONESHIFT);
-    earliestallowed_ = ReadIntegerFromEEPROM(SETTINGS_EEPROM_ADRESS_EARLIESTALLOWED);
-    latestallowed_   = ReadIntegerFromEEPROM(SETTINGS_EEPROM_ADRESS_LATESTALLOWED);
+    const StoredTimesettings& stored = Settings.GetRecord().timesettings;
+    memcpy(timezone_, stored.timezone, sizeof(timezone_));
+    timezone_[TIMEZONE_POSIX_MAX_LEN] = '\0';
+
+    // windows that do not pass AddWindow() are dropped
+    schedule_.Clear();
+    for (uint8_t i = 0; i < stored.window_count && i < SCHEDULE_MAX_WINDOWS; i++)
+    {
+        schedule_.AddWindow(stored.windows[i].weekdays, stored.windows[i].from, stored.windows[i].to);
+    }
     CheckValidValues();
     timesettings_loaded_ = true;
 }
@@ -44,9 +35,8 @@ void Timesettings::Reset()
 {
     Serial.print("reset timesettings...");
 
-    timezoneshift_   =  1; // Default shall be central european time, which is GMT+1
-    earliestallowed_ = 10; // Default shall be 10:00 o'clock
-    latestallowed_   = 20; // Default shall be 20:00 o'clock
+    strcpy(timezone_, TIMEZONE_DEFAULT_POSIX); // Default shall be central european time with daylight saving
+    schedule_.FromString(SCHEDULE_DEFAULT); // Default shall be every day from 10:00 to 21:00 o'clock
 
     Serial.println("done");
 
@@ -56,10 +46,22 @@ void Timesettings::Reset()
 void Timesettings::Save()
 {  
     CheckValidValues();
-    WriteIntegerToEEPROM(SETTINGS_EEPROM_ADRESS_TIMEZONESHIFT,   timezoneshift_);
-    WriteIntegerToEEPROM(SETTINGS_EEPROM_ADRESS_EARLIESTALLOWED, earliestallowed_);
-    WriteIntegerToEEPROM(SETTINGS_EEPROM_ADRESS_LATESTALLOWED,   latestallowed_);
-    EEPROM.write(SETTINGS_EEPROM_ADRESS_CHECKNUM, SETTINGS_CHECKNUM);
+    StoredTimesettings& stored = Settings.GetRecord().timesettings;
+    memset(&stored, 0, sizeof(stored));
+    memcpy(stored.timezone, timezone_, sizeof(stored.timezone));
+    stored.window_count = schedule_.GetWindowCount();
+    for (uint8_t i = 0; i < schedule_.GetWindowCount(); i++)
+    {
+        const ScheduleWindow& window = schedule_.GetWindow(i);
+        stored.windows[i].weekdays = window.weekdays;
+        stored.windows[i].from     = window.from;
+        stored.windows[i].to       = window.to;
+    }
+    if (!Settings.Commit())
+    {
+        Serial.println("saving settings failed");
+        return;
+    }
   
     Info();
     Serial.println("settings saved");
@@ -68,18 +70,28 @@ void Timesettings::Save()
 void Timesettings::Info()
 {
     Serial.println("Settings:");
-    Serial.println("Timezone shift: " + (String)timezoneshift_);
-    Serial.println("Earliest Start: " + (String)earliestallowed_);
-    Serial.println("Latest Start:   " + (String)latestallowed_);
+    Serial.println("Timezone:       " + (String)timezone_);
+    for (uint8_t i = 0; i < schedule_.GetWindowCount(); i++)
+    {
+        const ScheduleWindow& window = schedule_.GetWindow(i);
+        Serial.printf("Window %u:       days 0x%02X, %02u:%02u - %02u:%02u\n", i, window.weekdays,
+                      window.from / 60, window.from % 60, window.to / 60, window.to % 60);
+    }
 }
 
 String Timesettings::GetTimesettingsJSON()
 {
     CheckValidValues();
     String json = "{";
-    json += "\"timezoneshift\":"   + (String)(int)timezoneshift_   + ",";
-    json += "\"earliestallowed\":" + (String)(int)earliestallowed_ + ",";
-    json += "\"latestallowed\":"   + (String)(int)latestallowed_   + "}";
+    json += "\"timezone\":\""       + (String)timezone_             + "\",";
+    json += "\"schedule\":[";
+    for (uint8_t i = 0; i < schedule_.GetWindowCount(); i++)
+    {
+        const ScheduleWindow& window = schedule_.GetWindow(i);
+        json += (String)(i > 0 ? "," : "") + "{\"days\":" + (String)window.weekdays;
+        json += ",\"from\":" + (String)window.from + ",\"to\":" + (String)window.to + "}";
+    }
+    json += "]}";
     
     return json;
 }
@@ -93,62 +105,36 @@ size_t Timesettings::GetSize()
 
 void Timesettings::CheckValidValues()
 {
-    if (timezoneshift_ < 0)
-    {
-        timezoneshift_ = 0;
-    }
-    if (timezoneshift_ > 24)
-    {
-        timezoneshift_ = 24;
-    }
-    if (earliestallowed_ < 0)
-    {
-        earliestallowed_ = 0;
-    }
-    if (earliestallowed_ > 24)
+    // A valid POSIX TZ string only holds letters, digits and +-:,./<>, so it is safe to put into JSON
+    if (!TimeZone::IsValidPosix(timezone_))
     {
-        earliestallowed_ = 24;
-    }
-    if (latestallowed_ < 0)
-    {
-        latestallowed_ = 0;
-    }
-    if (latestallowed_ > 24)
-    {
-        latestallowed_ = 24;
-    }
-    if (earliestallowed_ > latestallowed_)
-    {
-        latestallowed_ = earliestallowed_;
+        strcpy(timezone_, TIMEZONE_DEFAULT_POSIX);
     }
+    // the schedule only ever holds windows accepted by WeeklySchedule::AddWindow(), an empty one is valid
 }
 
-int Timesettings::GetTimezoneshift()
+const char* Timesettings::GetTimezone()
 {
-    return timezoneshift_;
+    return timezone_;
 }
 
-int Timesettings::GetEarliestallowed()
+WeeklySchedule& Timesettings::GetSchedule()
 {
-    return earliestallowed_;
+    return schedule_;
 }
 
-int Timesettings::GetLatestallowed()
+// Rejects strings that are no valid POSIX TZ string
+bool Timesettings::SetTimezone(const String& timezone)
 {
-    return latestallowed_;
-}
-
-void Timesettings::SetTimezoneshift(int timezoneshift)
-{
-    timezoneshift_ = timezoneshift;
-}
-
-void Timesettings::SetEarliestallowed(int earliestallowed)
-{
-    earliestallowed_ = earliestallowed;
+    if (!TimeZone::IsValidPosix(timezone.c_str()))
+    {
+        return false;
+    }
+    strcpy(timezone_, timezone.c_str());
+    return true;
 }
 
-void Timesettings::SetLatestallowed(int latestallowed)
+void Timesettings::SetSchedule(const WeeklySchedule& schedule)
 {
-    latestallowed_ = latestallowed;
+    schedule_ = schedule;
 }
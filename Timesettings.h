@@ -6,16 +6,12 @@
 #ifndef TIMESETTINGS_H
 #define TIMESETTINGS_H
 
-#include <EEPROM.h>
 #include <ESP8266WiFi.h>
 #include <ESP8266WebServer.h>
 
-#define SETTINGS_EEPROM_ADRESS_TIMEZONESHIFT   1024    // type int - +1 byte for next address enough
-#define SETTINGS_EEPROM_ADRESS_EARLIESTALLOWED 1025 // type int - +1 byte for next address enough
-#define SETTINGS_EEPROM_ADRESS_LATESTALLOWED   1026 // type int - +1 byte for next address enough
-
-#define SETTINGS_EEPROM_ADRESS_CHECKNUM 2001
-#define SETTINGS_CHECKNUM 16
+#include "TimeZone.h"
+#include "WeeklySchedule.h"
+#include "SettingsStore.h"
 
 class Timesettings
 {
@@ -27,20 +23,15 @@ public:
     void Info();
     size_t GetSize();
     String GetTimesettingsJSON();
-    void WriteIntegerToEEPROM(int adress, int value);
-    int ReadIntegerFromEEPROM(int adress);
     
     void CheckValidValues();
-    int GetTimezoneshift();
-    int GetEarliestallowed();
-    int GetLatestallowed();
-    void SetTimezoneshift(int timezoneshift);
-    void SetEarliestallowed(int earliestallowed);
-    void SetLatestallowed(int latestallowed);
+    const char* GetTimezone();
+    WeeklySchedule& GetSchedule();
+    bool SetTimezone(const String& timezone);
+    void SetSchedule(const WeeklySchedule& schedule);
 private:    
-    int timezoneshift_;
-    int earliestallowed_;
-    int latestallowed_;
+    char timezone_[TIMEZONE_POSIX_MAX_LEN + 1];
+    WeeklySchedule schedule_;
     bool timesettings_loaded_;    
 };
 
@@ -7,7 +7,8 @@
 #include "WatchMovementSupplier.h"
 
 WatchMovementSupplier::WatchMovementSupplier()
-    : stepper_(0, 0, 0)
+    : stepper_(0, 0, 0),
+      gear_ratio_(1.0)
 {
     const short kfull_step = 1;
     const short krpm = 1;
@@ -39,6 +40,16 @@ void WatchMovementSupplier::SetRPM(short rpm)
     stepper_.setRPM(rpm);
 }
 
+double WatchMovementSupplier::GetGearRatio()
+{
+    return gear_ratio_;
+}
+
+void WatchMovementSupplier::SetGearRatio(double gear_ratio)
+{
+    gear_ratio_ = gear_ratio;
+}
+
 void WatchMovementSupplier::Rotate(double degree)
 {
     stepper_.rotate(degree);
@@ -21,12 +21,15 @@ public:
     A4988& GetStepper();
     short GetRPM();
     void SetRPM(short rpm);
+    double GetGearRatio();
+    void SetGearRatio(double gear_ratio);
     void Rotate(double degree);
     void RemoveRequirementAtIndex(int index);
     
 private:
     std::vector<WatchRequirementTurningLikeStepper> requirements_;
     A4988 stepper_;
+    double gear_ratio_;  // stepper turns per watch turn
 };
 
 #endif // #ifndef WATCHMOVEMENTSUPPLIER_H
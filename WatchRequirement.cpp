@@ -6,9 +6,9 @@
 
 #include "WatchRequirement.h"
 
-WatchRequirement::WatchRequirement(String name, TurningDirection turning_direction, int revolutions_per_day)
+WatchRequirement::WatchRequirement(const char* name, TurningDirection turning_direction, int revolutions_per_day)
 {
-    name_ = name;
+    SetName(name);
     turning_direction_ = turning_direction;
     revolutions_per_day_ = revolutions_per_day;
 }
@@ -33,12 +33,33 @@ void WatchRequirement::SetRevolutionsPerDay(int revolutions_per_day)
     revolutions_per_day_ = revolutions_per_day;
 }
 
-String WatchRequirement::GetName()
+const char* WatchRequirement::GetName() const
 {
     return name_;
 }
 
-void WatchRequirement::SetName(String name)
+uint8_t WatchRequirement::GetNameLength() const
 {
-    name_ = name;
+    return name_length_;
+}
+
+void WatchRequirement::SetName(const char* name)
+{
+    SetName(name, strlen(name));
+}
+
+// Names are cut to WATCH_NAME_MAX_LEN bytes, but never inside a UTF-8 sequence
+void WatchRequirement::SetName(const char* name, size_t length)
+{
+    if (length > WATCH_NAME_MAX_LEN)
+    {
+        length = WATCH_NAME_MAX_LEN;
+        while (length > 0 && ((uint8_t)name[length] & 0xC0) == 0x80)
+        {
+            length--;
+        }
+    }
+    memcpy(name_, name, length);
+    name_[length] = '\0';
+    name_length_ = length;
 }
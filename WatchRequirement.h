@@ -8,6 +8,8 @@
 
 #include <Arduino.h>
 
+#define WATCH_NAME_MAX_LEN 23  // longer names are cut, so they fit the fixed size record of SettingsStore
+
 enum TurningDirection
 {
     CLOCKWISEONLY = 0,
@@ -15,10 +17,11 @@ enum TurningDirection
     BOTHDIRECTIONS
 };
 
+// Holds its name inline and has no pointers, so copies (e.g. of the requirement vectors) never touch the heap
 class WatchRequirement
 {
 public:
-    WatchRequirement(String name, TurningDirection turning_direction, int revolutions_per_day);
+    WatchRequirement(const char* name, TurningDirection turning_direction, int revolutions_per_day);
     
     TurningDirection GetTurningDirection();
     void SetTurningDirection(TurningDirection turning_direction);
@@ -26,11 +29,14 @@ public:
     int GetRevolutionsPerDay();
     void SetRevolutionsPerDay(int revolutions_per_day);
     
-    String GetName();
-    void SetName(String name);
+    const char* GetName() const;
+    uint8_t GetNameLength() const;
+    void SetName(const char* name);
+    void SetName(const char* name, size_t length);
 
 private:
-    String name_;
+    char name_[WATCH_NAME_MAX_LEN + 1];
+    uint8_t name_length_;
     int revolutions_per_day_;
     TurningDirection turning_direction_;
     
@@ -6,10 +6,25 @@
 
 #include "WatchWinder.h"
 
+// Static assets only change with the firmware, so the build time serves as their version
+constexpr uint32_t kstatic_asset_version = Fnv1a(__DATE__ " " __TIME__);
+
+#define WEB_ROUTE_CASE(path, handler)                                       \
+    case WebRouteSlot(Fnv1a(path, WEB_ROUTE_SEED)):                         \
+        if (hash == Fnv1a(path, WEB_ROUTE_SEED)) { handler(); return; }     \
+        break;
+
 WatchWinder::WatchWinder()
     : wifi_manager_(),
       web_server_(80),
-      save_config_(true)
+      save_config_(true),
+      watches_dirty_(false),
+      watches_changed_millis_(0),
+      previous_window_event_(0),
+      next_window_event_(0),
+      in_allowed_time_frame_(false),
+      response_chunk_(nullptr),
+      buffer_counter_(0)
 {
     strcpy(mqtt_port_, "8080");
     strcpy(blynk_token_, "YOUR_BLYNK_TOKEN");
@@ -26,50 +41,51 @@ void WatchWinder::Setup()
     Serial.println("###################################################");
     Serial.println("### Running WatchWinder Setup");
 
+    // Settings and the WiFi configuration are records of the flash log
+    if (!FlashLog.Mount())
+    {
+        Serial.println("failed to mount flash log");
+    }
+
+    SetupClock();
     SetupWifiManager();
     SetupMovement();
     SetupNTPClient();
     
+    Settings.Load();
     timesettings_.Load();
     timesettings_.Info();
     ApplyTimesettings();
     
     SetupWatchMovementSuppliers();
+    history_.Load();
 
-    // HTML
-    web_server_.on("/", (std::bind(&WatchWinder::HandleRoot, this)));
-    web_server_.on("/index.html", (std::bind(&WatchWinder::HandleRoot, this)));
-    web_server_.on("/watches.html", (std::bind(&WatchWinder::HandleWatchesHTML, this)));
-    web_server_.on("/settings.html", (std::bind(&WatchWinder::HandleSettingsHTML, this)));
-    web_server_.on("/info.html", (std::bind(&WatchWinder::HandleInfoHTML, this)));
-    
-    // JS
-    web_server_.on("/js/timesettings.js", (std::bind(&WatchWinder::HandleTimesettingsJS, this)));
-    web_server_.on("/js/watches.js", (std::bind(&WatchWinder::HandleWatchesJS, this)));
-    web_server_.on("/js/functions.js", (std::bind(&WatchWinder::HandleFunctionsJS, this)));
-    
-    // CSS
-    web_server_.on("/style.css", (std::bind(&WatchWinder::HandleStyleCSS, this)));
-    
-    // JSON
-    web_server_.on("/timesettings.json", (std::bind(&WatchWinder::HandleTimesettingsJSON, this)));
-    web_server_.on("/timesettingsSave.json", (std::bind(&WatchWinder::HandleTimesettingsSaveJSON, this)));
-    web_server_.on("/timesettingsReset.json", (std::bind(&WatchWinder::HandleTimesettingsResetJSON, this)));
-    web_server_.on("/watches.json", (std::bind(&WatchWinder::HandleWatchesJSON, this)));
-    web_server_.on("/watchesSave.json", (std::bind(&WatchWinder::HandleWatchesSaveJSON, this)));
-    web_server_.on("/watchesReset.json", (std::bind(&WatchWinder::HandleWatchesResetJSON, this)));
-    web_server_.on("/restartESP.json", (std::bind(&WatchWinder::HandleRestartESPJSON, this)));
+    // Only headers collected here are kept by the web server
+    const char* kcollected_headers[] = { "Range", "If-Range", "If-None-Match" };
+    web_server_.collectHeaders(kcollected_headers, sizeof(kcollected_headers) / sizeof(kcollected_headers[0]));
+
+    // All routes are dispatched from one handler instead of one std::function per route
+    web_server_.onNotFound(std::bind(&WatchWinder::HandleRequest, this));
 
     web_server_.begin();
 
     Serial.println("HTTP server started");
+    Serial.printf("Free heap: %u bytes, largest free block: %u bytes\n", ESP.getFreeHeap(), ESP.getMaxFreeBlockSize());
 }
 
 void WatchWinder::SetupWatchMovementSuppliers()
 {
     // In my current design, there is only one stepper connected to the ESP8266
     WatchMovementSupplier stepper_providing_movement;
+    SetDefaultWatches(stepper_providing_movement);
+    watch_movement_suppliers_.push_back(stepper_providing_movement);
+
+    LoadWatches();
+}
 
+// The built-in configuration, set in place so a rotation the stepper is performing is not lost
+void WatchWinder::SetDefaultWatches(WatchMovementSupplier& stepper_providing_movement)
+{
     const short kdesired_watch_rpm   = 19;  // According to the following link, watch winders like the Elma Schmidbauer GmbH Cyclomatic Due™ or Buben-Zorweg Time Mover™ rotate at 19pm (for 32mins) so "a watch can be given 24 hours' worth of power reserve"
                                             // we will thus also use this as default value
     const short kpinion_number_teeth = 23;  // In my current design, the pinion has 23 teeth
@@ -77,37 +93,184 @@ void WatchWinder::SetupWatchMovementSuppliers()
     const short kdefault_rpm = (short)(kgear_number_teeth/kpinion_number_teeth * kdesired_watch_rpm);
                                             // the stepper itself needs to run (approx 2.39 times) faster to achieve the 19 rpm for the watches
     stepper_providing_movement.SetRPM(kdefault_rpm);
+    stepper_providing_movement.SetGearRatio((double)kgear_number_teeth / kpinion_number_teeth);
 
     // First Watch - next to stepper
-    WatchRequirementTurningLikeStepper::first_type first_watch_requirements("First Watch", BOTHDIRECTIONS, 720); // 720 seems to be a good value for "turns per day" according to http://people.timezone.com/msandler/Articles/ArnsteinWinder/Winder2.html
+    WatchRequirementTurningLikeStepper::first_type first_watch_requirements("First Watch", BOTHDIRECTIONS, WATCH_DEFAULT_TURNS_PER_DAY);
     WatchRequirementTurningLikeStepper::second_type first_watch_turning_like_stepper = false;
     WatchRequirementTurningLikeStepper first_watch = std::make_pair(first_watch_requirements, first_watch_turning_like_stepper);
 
     // Second Watch - in the middle
-    WatchRequirementTurningLikeStepper::first_type second_watch_requirements("Second Watch", BOTHDIRECTIONS, 720); // 720 seems to be a good value for "turns per day" according to http://people.timezone.com/msandler/Articles/ArnsteinWinder/Winder2.html
+    WatchRequirementTurningLikeStepper::first_type second_watch_requirements("Second Watch", BOTHDIRECTIONS, WATCH_DEFAULT_TURNS_PER_DAY);
     WatchRequirementTurningLikeStepper::second_type second_watch_turning_like_stepper = true;
     WatchRequirementTurningLikeStepper second_watch = std::make_pair(second_watch_requirements, second_watch_turning_like_stepper);
 
     // Third Watch - at the opposite end of the stepper
-    WatchRequirementTurningLikeStepper::first_type third_watch_requirements("Third Watch", BOTHDIRECTIONS, 720); // 720 seems to be a good value for "turns per day" according to http://people.timezone.com/msandler/Articles/ArnsteinWinder/Winder2.html
+    WatchRequirementTurningLikeStepper::first_type third_watch_requirements("Third Watch", BOTHDIRECTIONS, WATCH_DEFAULT_TURNS_PER_DAY);
     WatchRequirementTurningLikeStepper::second_type third_watch_turning_like_stepper = false;
     WatchRequirementTurningLikeStepper third_watch = std::make_pair(third_watch_requirements, third_watch_turning_like_stepper);
 
     // In my current design, there are three watches attached to the stepper imposing three requirements (one per watch) on the movement to be performed by the stepper per day
+    stepper_providing_movement.GetAllRequirements().clear();
     stepper_providing_movement.GetAllRequirements().push_back(first_watch);
     stepper_providing_movement.GetAllRequirements().push_back(second_watch);
     stepper_providing_movement.GetAllRequirements().push_back(third_watch);
+}
 
-    watch_movement_suppliers_.push_back(stepper_providing_movement);
+// Replaces the built-in configuration above with the one saved by the user, if there is one. A record
+// without watches (e.g. after a rollback to one saved before any edit) brings the built-in one back.
+void WatchWinder::LoadWatches()
+{
+    const StoredWatches& stored = Settings.GetRecord().watches;
+    if (stored.supplier_count == 0 && !watch_movement_suppliers_.empty())
+    {
+        SetDefaultWatches(watch_movement_suppliers_[0]);
+    }
+    for (uint8_t idx = 0; idx < stored.supplier_count && idx < SETTINGS_MAX_SUPPLIERS && idx < watch_movement_suppliers_.size(); idx++)
+    {
+        const StoredSupplier& stored_supplier = stored.suppliers[idx];
+        WatchMovementSupplier& supplier = watch_movement_suppliers_[idx];
+        if (stored_supplier.rpm > 0)
+        {
+            supplier.SetRPM(stored_supplier.rpm);
+        }
+        supplier.GetAllRequirements().clear();
+        for (uint8_t watch = 0; watch < stored_supplier.watch_count && watch < SETTINGS_MAX_WATCHES; watch++)
+        {
+            const StoredWatch& stored_watch = stored_supplier.watches[watch];
+            char name[WATCH_NAME_MAX_LEN + 1];
+            memcpy(name, stored_watch.name, sizeof(name));
+            name[WATCH_NAME_MAX_LEN] = '\0';
+            TurningDirection turning_direction = stored_watch.turning_direction <= BOTHDIRECTIONS ? (TurningDirection)stored_watch.turning_direction : BOTHDIRECTIONS;
+            // records saved before the web server clamped the value may hold a negative one wrapped around
+            uint16_t revolutions_per_day = min(stored_watch.revolutions_per_day, (uint16_t)WATCH_MAX_TURNS_PER_DAY);
+            WatchRequirement requirement(name, turning_direction, revolutions_per_day);
+            supplier.GetAllRequirements().push_back(std::make_pair(requirement, stored_watch.turning_like_stepper != 0));
+        }
+    }
+    movement_planner_.RequirementsChanged();
+    watches_cache_.Invalidate();
+}
+
+void WatchWinder::SaveWatches()
+{
+    StoredWatches& stored = Settings.GetRecord().watches;
+    memset(&stored, 0, sizeof(stored));
+    stored.supplier_count = min(watch_movement_suppliers_.size(), (size_t)SETTINGS_MAX_SUPPLIERS);
+    for (uint8_t idx = 0; idx < stored.supplier_count; idx++)
+    {
+        StoredSupplier& stored_supplier = stored.suppliers[idx];
+        WatchMovementSupplier& supplier = watch_movement_suppliers_[idx];
+        stored_supplier.rpm = supplier.GetRPM();
+        stored_supplier.watch_count = min(supplier.GetAllRequirements().size(), (size_t)SETTINGS_MAX_WATCHES);
+        for (uint8_t watch = 0; watch < stored_supplier.watch_count; watch++)
+        {
+            WatchRequirementTurningLikeStepper& requirement = supplier.GetAllRequirements()[watch];
+            StoredWatch& stored_watch = stored_supplier.watches[watch];
+            memcpy(stored_watch.name, requirement.first.GetName(), requirement.first.GetNameLength());
+            stored_watch.revolutions_per_day = requirement.first.GetRevolutionsPerDay();
+            stored_watch.turning_direction = requirement.first.GetTurningDirection();
+            stored_watch.turning_like_stepper = requirement.second ? 1 : 0;
+        }
+    }
+    Serial.println(Settings.Commit() ? "watches saved" : "saving watches failed");
+    watches_dirty_ = false;
 }
 
+// Saving is left to Step(), so a burst of edits results in one flash write
+void WatchWinder::WatchesChanged(size_t supplier)
+{
+    movement_planner_.RequirementsChanged(supplier);
+    watches_cache_.Invalidate();
+    watches_dirty_ = true;
+    watches_changed_millis_ = Monotonic.Millis();
+}
+
+// Serves files from PROGMEM and answers Range requests with the requested slice, so interrupted loads can be resumed
 void WatchWinder::SendFile(int code, String type, const char* adr, size_t len)
 {
-    SendHeader(code,type,len);
-    web_server_.sendContent_P(adr,len);
+    String etag = "\"" + String(kstatic_asset_version, HEX) + "-" + String(len, HEX) + "\"";
+    size_t first = 0;
+    size_t last = len - 1;
+
+    web_server_.sendHeader("Accept-Ranges", "bytes");
+    web_server_.sendHeader("ETag", etag);
+    // If-Range: only resume if the client still holds the same version of the file
+    if (web_server_.hasHeader("Range") && (!web_server_.hasHeader("If-Range") || web_server_.header("If-Range") == etag))
+    {
+        switch (ParseRangeHeader(web_server_.header("Range"), len, first, last))
+        {
+            case RANGE_PARTIAL:
+                web_server_.sendHeader("Content-Range", "bytes " + String(first) + "-" + String(last) + "/" + String(len));
+                code = 206;
+                break;
+            case RANGE_UNSATISFIABLE:
+                web_server_.sendHeader("Content-Range", "bytes */" + String(len));
+                web_server_.send(416, type, "");
+                return;
+            case RANGE_FULL:
+            default:
+                break;
+        }
+    }
+
+    SendHeader(code, type, last - first + 1);
+    web_server_.sendContent_P(adr + first, last - first + 1);
     SendBuffer();
 }
 
+// Single byte range as of RFC 7233: "bytes=first-last", "bytes=first-" or "bytes=-suffixlength"
+RangeRequest WatchWinder::ParseRangeHeader(const String& range, size_t len, size_t& first, size_t& last)
+{
+    const char* spec = range.c_str();
+    char* end;
+
+    if (strncmp(spec, "bytes=", 6) != 0 || strchr(spec, ',') != nullptr)
+    {
+        return RANGE_FULL; // other units and multiple ranges are not supported, a full response is allowed then
+    }
+    spec += 6;
+
+    if (*spec == '-')
+    {
+        unsigned long suffix = strtoul(spec + 1, &end, 10);
+        if (end == spec + 1 || *end != '\0')
+        {
+            return RANGE_FULL;
+        }
+        if (suffix == 0 || len == 0)
+        {
+            return RANGE_UNSATISFIABLE;
+        }
+        first = (suffix < len) ? len - suffix : 0;
+        last = len - 1;
+        return RANGE_PARTIAL;
+    }
+
+    unsigned long start = strtoul(spec, &end, 10);
+    if (end == spec || *end != '-')
+    {
+        return RANGE_FULL;
+    }
+    spec = end + 1;
+    unsigned long stop = len - 1;
+    if (*spec != '\0')
+    {
+        stop = strtoul(spec, &end, 10);
+        if (end == spec || *end != '\0' || stop < start)
+        {
+            return RANGE_FULL;
+        }
+    }
+    if (start >= len)
+    {
+        return RANGE_UNSATISFIABLE;
+    }
+    first = start;
+    last = (stop < len - 1) ? stop : len - 1;
+    return RANGE_PARTIAL;
+}
+
 void WatchWinder::SendHeader(int code, String type, size_t _size)
 {
     web_server_.setContentLength(_size);
@@ -118,21 +281,76 @@ void WatchWinder::SendBuffer()
 {
     if(buffer_counter_ > 0)
     {
-        web_server_.sendContent_P(data_website_buffer_, buffer_counter_);
+        web_server_.sendContent_P(response_chunk_, buffer_counter_);
         buffer_counter_ = 0;
     }
+    if(response_chunk_ != nullptr)
+    {
+        ResponsePool.Release(response_chunk_);
+        response_chunk_ = nullptr;
+    }
+}
+
+void WatchWinder::SendToBuffer(const String& str)
+{
+    SendToBuffer(str.c_str(), str.length());
 }
 
-void WatchWinder::SendToBuffer(String str)
+void WatchWinder::SendToBuffer(const char* data, size_t length)
 {
-    size_t length = str.length();
-    if(buffer_counter_ + length > BUFFER_SIZE)
+    if(response_chunk_ == nullptr)
     {
-        web_server_.sendContent_P(data_website_buffer_, buffer_counter_);
-        buffer_counter_ = 0;
+        response_chunk_ = ResponsePool.Acquire();
+        if(response_chunk_ == nullptr)
+        {
+            // all chunks are held, send unbuffered
+            web_server_.sendContent_P(data, length);
+            return;
+        }
+    }
+    while(length > 0)
+    {
+        size_t count = min(length, (size_t)RESPONSE_CHUNK_SIZE - buffer_counter_);
+        memcpy(response_chunk_ + buffer_counter_, data, count);
+        buffer_counter_ += count;
+        data += count;
+        length -= count;
+        if(buffer_counter_ == RESPONSE_CHUNK_SIZE)
+        {
+            web_server_.sendContent_P(response_chunk_, buffer_counter_);
+            buffer_counter_ = 0;
+        }
     }
-    memcpy(data_website_buffer_ + buffer_counter_, str.c_str(), length);
-    buffer_counter_ += length;
+}
+
+// Sends a cached response, or only 304 Not Modified if the client already holds it
+void WatchWinder::SendCachedJSON(ResponseCache& cache)
+{
+    web_server_.sendHeader("ETag", cache.GetETag());
+    web_server_.sendHeader("Cache-Control", "no-cache");
+    if (web_server_.header("If-None-Match") == cache.GetETag())
+    {
+        web_server_.send(304, "text/json", "");
+        return;
+    }
+    SendHeader(200, "text/json", cache.GetBody().length());
+    web_server_.sendContent(cache.GetBody());
+}
+
+void WatchWinder::HandleRequest()
+{
+    String uri = web_server_.uri();
+    uint32_t hash = Fnv1a(uri.c_str(), WEB_ROUTE_SEED);
+
+    // The routes and their hashes are compile-time constants, so this compiles to a jump table in flash
+    switch (WebRouteSlot(hash))
+    {
+        WEB_ROUTES(WEB_ROUTE_CASE)
+#ifndef DATA_BUNDLED
+        WEB_ROUTES_UNBUNDLED(WEB_ROUTE_CASE)
+#endif
+    }
+    web_server_.send(404, "text/plain", "Not found: " + uri);
 }
 
 void WatchWinder::HandleRoot()
@@ -155,6 +373,7 @@ void WatchWinder::HandleInfoHTML()
     SendFile(200, "text/html", data_infoHTML, sizeof(data_infoHTML));
 }
 
+#ifndef DATA_BUNDLED
 void WatchWinder::HandleTimesettingsJS()
 {
     SendFile(200, "text/javascript", data_js_timesettingsJS, sizeof(data_js_timesettingsJS));
@@ -174,29 +393,29 @@ void WatchWinder::HandleStyleCSS()
 {
     SendFile(200, "text/css;charset=UTF-8", data_styleCSS, sizeof(data_styleCSS));
 }
+#endif
 
 void WatchWinder::HandleTimesettingsJSON()
 {
-    SendHeader(200, "text/json", timesettings_.GetSize());
-    String json = timesettings_.GetTimesettingsJSON();
-    SendToBuffer(json);
-    SendBuffer();
+    GetCachedTimesettingsJSON();
+    SendCachedJSON(timesettings_cache_);
 }
 
 void WatchWinder::HandleTimesettingsSaveJSON()
 {
-    if (web_server_.hasArg("timezoneshift"))
-    {
-        timesettings_.SetTimezoneshift(web_server_.arg("timezoneshift").toInt());
-    }
-    if (web_server_.hasArg("earliestallowed"))
+    // Nothing is changed unless every argument is valid
+    WeeklySchedule schedule = timesettings_.GetSchedule();
+    if ((web_server_.hasArg("schedule") && !schedule.FromString(web_server_.arg("schedule").c_str())) ||
+        (web_server_.hasArg("timezone") && !TimeZone::IsValidPosix(web_server_.arg("timezone").c_str())))
     {
-        timesettings_.SetEarliestallowed(web_server_.arg("earliestallowed").toInt());
+        web_server_.send(200, "text/json", "false");
+        return;
     }
-    if (web_server_.hasArg("latestallowed"))
+    if (web_server_.hasArg("timezone"))
     {
-        timesettings_.SetLatestallowed(web_server_.arg("latestallowed").toInt());
+        timesettings_.SetTimezone(web_server_.arg("timezone"));
     }
+    timesettings_.SetSchedule(schedule);
     timesettings_.Save();
     ApplyTimesettings();
     web_server_.send(200, "text/json", "true");
@@ -209,70 +428,191 @@ void WatchWinder::HandleTimesettingsResetJSON()
     web_server_.send(200, "text/json", "true");
 }
 
+// Returns timesettings and watches to the state before the last save, calling it again undoes the rollback
+void WatchWinder::HandleTimesettingsRollbackJSON()
+{
+    if (watches_dirty_)
+    {
+        SaveWatches(); // the pending save is the one to roll back
+    }
+    if (!Settings.Rollback())
+    {
+        web_server_.send(200, "text/json", "false");
+        return;
+    }
+    timesettings_.Load();
+    ApplyTimesettings();
+    LoadWatches();
+    web_server_.send(200, "text/json", "true");
+}
+
 void WatchWinder::HandleWatchesJSON()
 {
-    String json = GetWatchesJSON();
-    size_t json_size = json.length();
-    SendHeader(200, "text/json", json_size);
-    SendToBuffer(json);
-    SendBuffer();
+    GetCachedWatchesJSON();
+    SendCachedJSON(watches_cache_);
 }
 
+// Takes watch<i>name, watch<i>turnsperday and watch<i>turndirection for the watches of the supplier
+// given by ?supplier=, the first one if it is missing. A known watch<i>caliber overrides turns and direction.
 void WatchWinder::HandleWatchesSaveJSON()
 {
-	if (web_server_.hasArg("firstwatchname"))
-    {
-		SetFirstwatchname(web_server_.arg("firstwatchname"));
-    }
-    if (web_server_.hasArg("firstwatchturnsperday"))
-    {
-		SetFirstwatchturnsperday(web_server_.arg("firstwatchturnsperday").toInt());
-    }
-    if (web_server_.hasArg("firstwatchturndirection"))
+    long supplier = web_server_.hasArg("supplier") ? web_server_.arg("supplier").toInt() : 0;
+    if (supplier < 0 || (size_t)supplier >= GetSupplierCount())
     {
-		SetFirstwatchturndirection((TurningDirection)(web_server_.arg("firstwatchturndirection").toInt()));
+        web_server_.send(200, "text/json", "false");
+        return;
     }
-	if (web_server_.hasArg("secondwatchname"))
+
+    char arg[24];
+    for (size_t idx = 0; idx < GetWatchCount(supplier); idx++)
     {
-		SetSecondwatchname(web_server_.arg("secondwatchname"));
+        WatchRequirement& watch = Watch(supplier, idx);
+        snprintf(arg, sizeof(arg), "watch%uname", (unsigned)idx);
+        if (web_server_.hasArg(arg))
+        {
+            watch.SetName(web_server_.arg(arg).c_str());
+        }
+        snprintf(arg, sizeof(arg), "watch%uturnsperday", (unsigned)idx);
+        if (web_server_.hasArg(arg))
+        {
+            watch.SetRevolutionsPerDay(constrain(web_server_.arg(arg).toInt(), 0L, (long)WATCH_MAX_TURNS_PER_DAY));
+        }
+        snprintf(arg, sizeof(arg), "watch%uturndirection", (unsigned)idx);
+        if (web_server_.hasArg(arg))
+        {
+            long turning_direction = web_server_.arg(arg).toInt();
+            watch.SetTurningDirection((turning_direction >= CLOCKWISEONLY && turning_direction <= BOTHDIRECTIONS) ? (TurningDirection)turning_direction : BOTHDIRECTIONS);
+        }
+        snprintf(arg, sizeof(arg), "watch%ucaliber", (unsigned)idx);
+        if (web_server_.hasArg(arg))
+        {
+            ApplyCaliberPreset(web_server_.arg(arg).c_str(), watch);
+        }
     }
-    if (web_server_.hasArg("secondwatchturnsperday"))
+    WatchesChanged(supplier);
+    web_server_.send(200, "text/json", "true");
+}
+
+void WatchWinder::HandleWatchesResetJSON()
+{
+    const char* kdefault_names[] = { "First Watch", "Second Watch", "Third Watch" };
+    const size_t kdefault_name_count = sizeof(kdefault_names) / sizeof(kdefault_names[0]);
+    for (size_t supplier = 0; supplier < GetSupplierCount(); supplier++)
     {
-		SetSecondwatchturnsperday(web_server_.arg("secondwatchturnsperday").toInt());
+        for (size_t idx = 0; idx < GetWatchCount(supplier); idx++)
+        {
+            WatchRequirement& watch = Watch(supplier, idx);
+            if (idx < kdefault_name_count)
+            {
+                watch.SetName(kdefault_names[idx]);
+            }
+            else
+            {
+                char name[WATCH_NAME_MAX_LEN + 1];
+                snprintf(name, sizeof(name), "Watch %u", (unsigned)(idx + 1));
+                watch.SetName(name);
+            }
+            watch.SetRevolutionsPerDay(WATCH_DEFAULT_TURNS_PER_DAY);
+            watch.SetTurningDirection(BOTHDIRECTIONS);
+        }
     }
-    if (web_server_.hasArg("secondwatchturndirection"))
+    WatchesChanged();
+    web_server_.send(200, "text/json", "true");
+}
+
+// Timesettings, watches and status in one response, so a page needs only itself and this request
+void WatchWinder::HandleStateJSON()
+{
+    String json = GetStateJSON();
+    size_t json_size = json.length();
+    SendHeader(200, "text/json", json_size);
+    SendToBuffer(json);
+    SendBuffer();
+}
+
+// Entries newest first, ?offset= and ?limit= page through them and ?format=csv returns CSV instead
+// of JSON. The response is chunked, every entry is formatted on its own into the response buffer.
+void WatchWinder::HandleHistoryAPI()
+{
+    long count = history_.GetCount();
+    long offset = web_server_.hasArg("offset") ? constrain(web_server_.arg("offset").toInt(), 0L, count) : 0;
+    long limit = web_server_.hasArg("limit") ? constrain(web_server_.arg("limit").toInt(), 1L, (long)HISTORY_PAGE_MAX) : HISTORY_PAGE_DEFAULT;
+    long end = min(offset + limit, count);
+    bool csv = web_server_.arg("format") == "csv";
+
+    char line[192];
+    SendHeader(200, csv ? "text/csv" : "text/json", CONTENT_LENGTH_UNKNOWN);
+    if (csv)
     {
-		SetSecondwatchturndirection((TurningDirection)(web_server_.arg("secondwatchturndirection").toInt()));
+        SendToBuffer("date,supplier,watch,required,clockwise,counterclockwise,motorseconds,missedminutes\n");
     }
-	if (web_server_.hasArg("thirdwatchname"))
+    else
     {
-		SetThirdwatchname(web_server_.arg("thirdwatchname"));
+        snprintf(line, sizeof(line), "{\"total\":%ld,\"offset\":%ld,\"entries\":[", count, offset);
+        SendToBuffer(line, strlen(line));
     }
-    if (web_server_.hasArg("thirdwatchturnsperday"))
+    for (long idx = offset; idx < end; idx++)
     {
-		SetThirdwatchturnsperday(web_server_.arg("thirdwatchturnsperday").toInt());
+        const HistoryEntry& entry = history_.GetEntry(count - 1 - idx);
+        tmElements_t date;
+        breakTime((time_t)entry.day * SECS_PER_DAY, date);
+        snprintf(line, sizeof(line),
+                 csv ? "%s%04u-%02u-%02u,%u,%u,%u,%u,%u,%u,%u\n"
+                     : "%s{\"date\":\"%04u-%02u-%02u\",\"supplier\":%u,\"watch\":%u,\"required\":%u,\"clockwise\":%u,"
+                       "\"counterclockwise\":%u,\"motorseconds\":%u,\"missedminutes\":%u}",
+                 csv ? "" : (idx == offset ? "" : ","),
+                 tmYearToCalendar(date.Year), date.Month, date.Day, entry.supplier, entry.watch, entry.required_turns,
+                 entry.turns_clockwise, entry.turns_counterclockwise, entry.motor_seconds, entry.missed_minutes);
+        SendToBuffer(line, strlen(line));
     }
-    if (web_server_.hasArg("thirdwatchturndirection"))
+    if (!csv)
     {
-		SetThirdwatchturndirection((TurningDirection)(web_server_.arg("thirdwatchturndirection").toInt()));
+        SendToBuffer("]}");
     }
-	web_server_.send(200, "text/json", "true");
+    SendBuffer();
+    web_server_.sendContent(""); // last chunk
 }
 
-void WatchWinder::HandleWatchesResetJSON()
+// ?name= answers the preset of that caliber or 404, otherwise the presets starting with ?q= (case
+// insensitive, all if missing) are listed up to ?limit=. Presets are read from flash one at a time.
+void WatchWinder::HandleCalibersAPI()
 {
-	SetFirstwatchname("First Watch");
-    SetFirstwatchturnsperday(720);
-    SetFirstwatchturndirection(BOTHDIRECTIONS);
-
-    SetSecondwatchname("Second Watch");
-    SetSecondwatchturnsperday(720);
-    SetSecondwatchturndirection(BOTHDIRECTIONS);
+    char line[96];
+    CaliberPreset preset;
+    if (web_server_.hasArg("name"))
+    {
+        int id = FindCaliberPreset(web_server_.arg("name").c_str());
+        if (id < 0)
+        {
+            web_server_.send(404, "text/json", "null");
+            return;
+        }
+        ReadCaliberPreset(id, preset);
+        snprintf(line, sizeof(line), "{\"name\":\"%s\",\"turnsperday\":%u,\"turndirection\":%u}", preset.name, preset.turns_per_day, preset.turning_direction);
+        web_server_.send(200, "text/json", line);
+        return;
+    }
 
-    SetThirdwatchname("Third Watch");
-    SetThirdwatchturnsperday(720);
-    SetThirdwatchturndirection(BOTHDIRECTIONS);
-	web_server_.send(200, "text/json", "true");
+    String prefix = web_server_.arg("q");
+    long limit = web_server_.hasArg("limit") ? constrain(web_server_.arg("limit").toInt(), 1L, (long)CALIBER_COUNT) : CALIBERS_PAGE_DEFAULT;
+    long found = 0;
+    SendHeader(200, "text/json", CONTENT_LENGTH_UNKNOWN);
+    SendToBuffer("[");
+    for (uint8_t id = 0; id < CALIBER_COUNT && found < limit; id++)
+    {
+        if (!MatchCaliberPreset(id, prefix.c_str()))
+        {
+            continue;
+        }
+        ReadCaliberPreset(id, preset);
+        snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"turnsperday\":%u,\"turndirection\":%u}",
+                 found > 0 ? "," : "", preset.name, preset.turns_per_day, preset.turning_direction);
+        SendToBuffer(line, strlen(line));
+        found++;
+    }
+    SendToBuffer("]");
+    SendBuffer();
+    web_server_.sendContent(""); // last chunk
 }
 
 void WatchWinder::HandleRestartESPJSON()
@@ -281,61 +621,91 @@ void WatchWinder::HandleRestartESPJSON()
     ESP.restart();
 }
 
+// The configuration is a record of the flash log, a /config.json left in SPIFFS by earlier firmware is imported once.
+// Both are parsed in small chunks straight into the fields, values too long for their field are ignored.
 void WatchWinder::ReadConfig()
 {
-    if (SPIFFS.begin())
+    ConfigField fields[] =
+    {
+        { "mqtt_server", mqtt_server_,    sizeof(mqtt_server_) },
+        { "mqtt_port",   mqtt_port_,      sizeof(mqtt_port_) },
+        { "blynk_token", blynk_token_,    sizeof(blynk_token_) },
+        { "ip",          static_ip_,      sizeof(static_ip_) },
+        { "gateway",     static_gateway_, sizeof(static_gateway_) },
+        { "subnet",      static_subnet_,  sizeof(static_subnet_) }
+    };
+    ConfigReader reader(fields, sizeof(fields) / sizeof(fields[0]));
+    char chunk[CONFIG_JSON_CHUNK];
+
+    int size = FlashLog.GetLength(LOGSTORE_KEY_WIFI_CONFIG);
+    if (size >= 0)
     {
-        if (SPIFFS.exists("/config.json"))
+        for (int offset = 0; offset < size && !reader.HasError(); offset += sizeof(chunk))
         {
-          if (SPIFFS.remove("/config.json"))
-          {
-            Serial.println("Deleted /config.json");
-          }
+            FlashLog.Read(LOGSTORE_KEY_WIFI_CONFIG, chunk, sizeof(chunk), offset);
+            reader.Feed(chunk, min(size - offset, (int)sizeof(chunk)));
         }
-        if (SPIFFS.exists("/config.json"))
-        {
-        //file exists, reading and loading
+    }
+    else if (SPIFFS.begin() && SPIFFS.exists("/config.json"))
+    {
         File configFile = SPIFFS.open("/config.json", "r");
-        if (configFile)
+        if (!configFile)
         {
-                size_t size = configFile.size();
-                // Allocate a buffer to store contents of the file.
-                std::unique_ptr<char[]> buf(new char[size]);
-
-                configFile.readBytes(buf.get(), size);
-                DynamicJsonBuffer jsonBuffer;
-                JsonObject& json = jsonBuffer.parseObject(buf.get());
-                json.printTo(Serial);
-                if (json.success())
-                {
-                    strcpy(mqtt_server_, json["mqtt_server"]);
-                    strcpy(mqtt_port_, json["mqtt_port"]);
-                    strcpy(blynk_token_, json["blynk_token"]);
-
-                    if(json["ip"])
-                    {
-                        strcpy(static_ip_, json["ip"]);
-                        strcpy(static_gateway_, json["gateway"]);
-                        strcpy(static_subnet_, json["subnet"]);
-                    }
-                    else
-                    {
-                        Serial.println("no custom ip in config");
-                    }
-                }
-                else
-                {
-                    Serial.println("failed to load json config");
-                }
-            }
+            return;
+        }
+        size_t read;
+        while (!reader.HasError() && (read = configFile.readBytes(chunk, sizeof(chunk))) > 0)
+        {
+            reader.Feed(chunk, read);
+        }
+        configFile.close();
+        if (reader.IsComplete() && SaveConfig() && SPIFFS.remove("/config.json"))
+        {
+            Serial.println("Moved /config.json to the flash log");
         }
     }
     else
     {
-        Serial.println("failed to mount FS");
+        return;
+    }
+
+    if (!reader.IsComplete())
+    {
+        Serial.println("failed to load json config");
     }
 }
 
+// Writes the configuration to the flash log, unless the stored one is identical
+bool WatchWinder::SaveConfig()
+{
+    ConfigBuffer config;
+    ConfigWriter writer(config);
+    writer.Add("mqtt_server", mqtt_server_);
+    writer.Add("mqtt_port", mqtt_port_);
+    writer.Add("blynk_token", blynk_token_);
+    writer.End();
+    if (config.HasOverflow())
+    {
+        return false;
+    }
+
+    int stored_size = FlashLog.GetLength(LOGSTORE_KEY_WIFI_CONFIG);
+    bool changed = stored_size != (int)config.GetLength();
+    char chunk[CONFIG_JSON_CHUNK];
+    for (int offset = 0; offset < stored_size && !changed; offset += sizeof(chunk))
+    {
+        int part = min(stored_size - offset, (int)sizeof(chunk));
+        FlashLog.Read(LOGSTORE_KEY_WIFI_CONFIG, chunk, part, offset);
+        changed = memcmp(chunk, config.GetData() + offset, part) != 0;
+    }
+    if (!changed)
+    {
+        return true;
+    }
+    Serial.println("saving config");
+    return FlashLog.Write(LOGSTORE_KEY_WIFI_CONFIG, config.GetData(), config.GetLength());
+}
+
 void WatchWinder::SetupWifiManager()
 {
     ReadConfig();
@@ -381,6 +751,11 @@ void WatchWinder::SetupWifiManager()
         // reset and try again, or maybe put it to deep sleep
         wifi_manager_.resetSettings();
         Serial.println("resetting wifi manager and restarting ESP8266");
+        // Step() has not saved the clock yet, without this every failed attempt loses the time spent in the portal
+        if (SystemClock.IsSet())
+        {
+            RtcTime.Save(SystemClock.NowMillis(), SystemClock.GetErrorBoundMillis());
+        }
         ESP.restart();
         delay(5000);
     }
@@ -393,26 +768,10 @@ void WatchWinder::SetupWifiManager()
     strcpy(mqtt_port_, custom_mqtt_port.getValue());
     strcpy(blynk_token_, custom_blynk_token.getValue());
 
-    // save the custom parameters to FS
-    if (save_config_)
+    // save the custom parameters to the flash log
+    if (save_config_ && !SaveConfig())
     {
-        Serial.println("saving config");
-        DynamicJsonBuffer jsonBuffer;
-        JsonObject& json = jsonBuffer.createObject();
-        json["mqtt_server"] = mqtt_server_;
-        json["mqtt_port"] = mqtt_port_;
-        json["blynk_token"] = blynk_token_;
-
-        File configFile = SPIFFS.open("/config.json", "w");
-        if (!configFile)
-        {
-            Serial.println("failed to open config file for writing");
-        }
-
-        json.printTo(Serial);
-        json.printTo(configFile);
-        configFile.close();
-        // end save
+        Serial.println("failed to save config");
     }
 
     Serial.println("local ip");
@@ -424,27 +783,30 @@ void WatchWinder::SetupMovement()
 {
 }
 
-void WatchWinder::SetupNTPClient()
+void WatchWinder::SetupClock()
 {
-    NTP.init((char *)"de.pool.ntp.org", UTC0100); // hardcoded: German NTP Server, Central European Time (CET = UTC + 01:00)
-    NTP.setPollingInterval(60*5); // Poll every 5 minutes
+    Monotonic.Begin();
 
-    NTP.onSyncEvent([](NTPSyncEvent_t ntpEvent)
+    // After a reset the time saved in RTC memory is good enough to plan with until NTP answers
+    uint64_t restored_millis;
+    uint32_t restored_error_ms;
+    if (RtcTime.Restore(restored_millis, restored_error_ms))
     {
-        switch (ntpEvent)
-        {
-            case NTP_EVENT_INIT:
-                break;
-            case NTP_EVENT_STOP:
-                break;
-            case NTP_EVENT_NO_RESPONSE:
-                Serial.printf("NTP server not reachable.\n");
-                break;
-            case NTP_EVENT_SYNCHRONIZED:
-                Serial.printf("Got NTP time: %s\n", NTP.getTimeDate(NTP.getLastSync()));
-            break;
-        }
-    });
+        SystemClock.SetProvisional(restored_millis, restored_error_ms);
+        Serial.printf("Restored time from RTC memory, error below %u ms\n", restored_error_ms);
+    }
+    // SystemClock.Begin() follows NTP.init() in SetupNTPClient(), which sets its own sync provider
+}
+
+void WatchWinder::SetupNTPClient()
+{
+    // hardcoded: German NTP Servers. The clock runs on UTC, local time comes from the timezone in the timesettings
+    NTP.init((char *)"0.de.pool.ntp.org", UTC);
+    NTP.setNTPServer((char *)"1.de.pool.ntp.org", 1);
+    NTP.setNTPServer((char *)"2.de.pool.ntp.org", 2);
+
+    SystemClock.Begin(); // after NTP.init(), so the Time library is fed from the disciplined clock
+    NtpServers.Begin();  // polls the servers above on the adaptive interval of SystemClock
 }
 void WatchWinder::SaveConfigCallback()
 {
@@ -454,296 +816,167 @@ void WatchWinder::SaveConfigCallback()
 
 void WatchWinder::Step()
 {
-    if( InAllowedTimeFrameOfDay() )
+    NtpServers.Step();
+
+    // Read the clock once per iteration, everything else in this iteration uses nowCached()
+    time_t current_time = now();
+    if( SystemClock.IsSet() && RtcTime.IsSaveDue() )
+    {
+        RtcTime.Save(SystemClock.NowMillis(), SystemClock.GetErrorBoundMillis());
+        history_.SaveToRtc();
+    }
+    if( current_time >= next_window_event_ || current_time < previous_window_event_ )
     {
-        Serial.println("Time is ok");
-        for (auto& watch_movement : watch_movement_suppliers_)
+        bool was_in_allowed_time_frame = in_allowed_time_frame_;
+        UpdateAllowedTimeFrame(current_time);
+        if( in_allowed_time_frame_ != was_in_allowed_time_frame )
         {
+            Serial.println(in_allowed_time_frame_ ? "Allowed time frame opened" : "Allowed time frame closed");
         }
     }
+    if( watches_dirty_ && Monotonic.Millis() - watches_changed_millis_ >= WATCHES_SAVE_DELAY_MS )
+    {
+        SaveWatches();
+    }
+    FlashLog.Step();
+    movement_planner_.Step(watch_movement_suppliers_, in_allowed_time_frame_, timesettings_.GetSchedule().GetAllowedMinutesPerWeek());
+    if( timeStatus() != timeNotSet )
+    {
+        history_.Step(watch_movement_suppliers_, movement_planner_, timesettings_.GetSchedule(), time_zone_.ToLocal(current_time));
+    }
     web_server_.handleClient();
 }
 
-bool WatchWinder::InAllowedTimeFrameOfDay()
+// The schedule works in local time, t and the window events are UTC
+void WatchWinder::UpdateAllowedTimeFrame(time_t t)
 {
-    if( hour(now()) >= hour(earliest_allowed_movement_) &&
-        hour(now()) <= hour(latest_allowed_movement_) )
+    if( timeStatus() == timeNotSet )
     {
-        return true;
-    }
-    else
-    {
-        return false;
+        in_allowed_time_frame_ = false;
+        previous_window_event_ = t;
+        next_window_event_     = t + 1;
+        return;
     }
+
+    time_t previous_local;
+    time_t next_local;
+    in_allowed_time_frame_ = timesettings_.GetSchedule().Lookup(time_zone_.ToLocal(t), previous_local, next_local);
+
+    // A daylight saving transition moves the local window, so it is an event of its own
+    previous_window_event_ = min(time_zone_.ToUtc(previous_local), t);
+    next_window_event_     = max(min(time_zone_.ToUtc(next_local), time_zone_.GetNextTransition(t)), t + 1);
 }
 
-std::vector<WatchMovementSupplier> WatchWinder::GetAllWatchMovementSuppliers()
+std::vector<WatchMovementSupplier>& WatchWinder::Suppliers()
 {
     return watch_movement_suppliers_;
 }
 
-void WatchWinder::AddWatchMovementSupplier()
+size_t WatchWinder::GetSupplierCount()
 {
-    watch_movement_suppliers_.push_back(WatchMovementSupplier());
+    return watch_movement_suppliers_.size();
 }
 
-time_t WatchWinder::ConvertEpochHourToUnixTimestamp(int hour, int relative_to_gmt)
+size_t WatchWinder::GetWatchCount(size_t supplier)
 {
-    struct tm dummy_time = {0};  // Initalize to all 0's
-    dummy_time.tm_year = 0;    // This is year-1900, so 118 = 2018
-    dummy_time.tm_mon  = 1;
-    dummy_time.tm_mday = 1;
-    dummy_time.tm_hour = hour - relative_to_gmt * 60 * 60;
-    dummy_time.tm_min  = 0;
-    dummy_time.tm_sec  = 0;
+    return watch_movement_suppliers_[supplier].GetAllRequirements().size();
+}
 
-    return mktime(&dummy_time);
+// Indices are not checked, they have to be below GetSupplierCount() and GetWatchCount().
+// Changes reach the planner through WatchesChanged().
+WatchRequirement& WatchWinder::Watch(size_t supplier, size_t watch)
+{
+    return watch_movement_suppliers_[supplier].GetAllRequirements()[watch].first;
+}
+
+void WatchWinder::AddWatchMovementSupplier()
+{
+    watch_movement_suppliers_.push_back(WatchMovementSupplier());
 }
 
 void WatchWinder::ApplyTimesettings()
 {
-    earliest_allowed_movement_ = ConvertEpochHourToUnixTimestamp(timesettings_.GetEarliestallowed(), timesettings_.GetTimezoneshift());
-    latest_allowed_movement_   = ConvertEpochHourToUnixTimestamp(timesettings_.GetLatestallowed(),   timesettings_.GetTimezoneshift());
+    timesettings_cache_.Invalidate();
+    time_zone_.SetPosix(timesettings_.GetTimezone());
+    // force recomputation of the allowed time frame in the next Step()
+    previous_window_event_ = 0;
+    next_window_event_     = 0;
 }
 
+// {"suppliers":[{"rpm":..,"watches":[{"name":..,"turnsperday":..,"turndirection":..},..]},..]}
 String WatchWinder::GetWatchesJSON()
 {
-	
-	String json = "{";
-    json += "\"firstwatchname\":\""   		  + (String)GetFirstwatchname() 			+ "\",";
-    json += "\"firstwatchturnsperday\":" 	  + (String)GetFirstwatchturnsperday() 	    + ",";
-    json += "\"firstwatchturndirection\":\""  + (String)GetFirstwatchturndirection() 	+ "\",";
-    json += "\"secondwatchname\":\""   		  + (String)GetSecondwatchname() 			+ "\",";
-    json += "\"secondwatchturnsperday\":" 	  + (String)GetSecondwatchturnsperday() 	+ ",";
-    json += "\"secondwatchturndirection\":\"" + (String)GetSecondwatchturndirection()   + "\",";
-    json += "\"thirdwatchname\":\""   		  + (String)GetThirdwatchname() 			+ "\",";
-    json += "\"thirdwatchturnsperday\":" 	  + (String)GetThirdwatchturnsperday() 	    + ",";
-    json += "\"thirdwatchturndirection\":\""  + (String)GetThirdwatchturndirection() 	+ "\"}";
-    
+    StreamString json;
+    json.print("{\"suppliers\":[");
+    for (size_t supplier = 0; supplier < GetSupplierCount(); supplier++)
+    {
+        json.printf("%s{\"rpm\":%d,\"watches\":[", supplier > 0 ? "," : "", (int)watch_movement_suppliers_[supplier].GetRPM());
+        for (size_t idx = 0; idx < GetWatchCount(supplier); idx++)
+        {
+            WatchRequirement& watch = Watch(supplier, idx);
+            json.print(idx > 0 ? ",{\"name\":" : "{\"name\":");
+            WriteJsonString(json, watch.GetName());
+            json.printf(",\"turnsperday\":%d,\"turndirection\":%d}", watch.GetRevolutionsPerDay(), (int)watch.GetTurningDirection());
+        }
+        json.print("]}");
+    }
+    json.print("]}");
+
     return json;
 }
 
-String WatchWinder::GetFirstwatchname()
-{
-	String empty_name = "First Watch";
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 0)
-		{
-			return (String)(watch_movement_suppliers_.at(0).GetAllRequirements().at(0).first.GetName());
-		}
-	}
-	return empty_name;
-}
-
-int WatchWinder::GetFirstwatchturnsperday()
-{
-	int revolutions_per_day = 720; // Default
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 0)
-		{
-			return (int)(watch_movement_suppliers_.at(0).GetAllRequirements().at(0).first.GetRevolutionsPerDay());
-		}
-	}
-	return revolutions_per_day;
-}
-
-TurningDirection WatchWinder::GetFirstwatchturndirection()
-{
-	TurningDirection turning_direction = BOTHDIRECTIONS; // Default
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 0)
-		{
-			return (TurningDirection)(watch_movement_suppliers_.at(0).GetAllRequirements().at(0).first.GetTurningDirection());
-		}
-	}
-	return turning_direction;
-}
-
-String WatchWinder::GetSecondwatchname()
-{
-	String empty_name = "Second Watch";
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 1)
-		{
-			return (String)(watch_movement_suppliers_.at(0).GetAllRequirements().at(1).first.GetName());
-		}
-	}
-	return empty_name;
-}
-
-int WatchWinder::GetSecondwatchturnsperday()
-{
-	int revolutions_per_day = 720; // Default
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 1)
-		{
-			return (int)(watch_movement_suppliers_.at(0).GetAllRequirements().at(1).first.GetRevolutionsPerDay());
-		}
-	}
-	return revolutions_per_day;
-}
-
-TurningDirection WatchWinder::GetSecondwatchturndirection()
+const String& WatchWinder::GetCachedTimesettingsJSON()
 {
-	TurningDirection turning_direction = BOTHDIRECTIONS; // Default
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 1)
-		{
-			return (TurningDirection)(watch_movement_suppliers_.at(0).GetAllRequirements().at(1).first.GetTurningDirection());
-		}
-	}
-	return turning_direction;
-}
-
-String WatchWinder::GetThirdwatchname()
-{
-	String empty_name = "Third Watch";
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 2)
-		{
-			return (String)(watch_movement_suppliers_.at(0).GetAllRequirements().at(2).first.GetName());
-		}
-	}
-	return empty_name;
+    if (!timesettings_cache_.IsValid())
+    {
+        timesettings_cache_.Store(timesettings_.GetTimesettingsJSON());
+    }
+    return timesettings_cache_.GetBody();
 }
 
-int WatchWinder::GetThirdwatchturnsperday()
+const String& WatchWinder::GetCachedWatchesJSON()
 {
-	int revolutions_per_day = 720; // Default
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 2)
-		{
-			return (int)(watch_movement_suppliers_.at(0).GetAllRequirements().at(2).first.GetRevolutionsPerDay());
-		}
-	}
-	return revolutions_per_day;
-}
-
-TurningDirection WatchWinder::GetThirdwatchturndirection()
-{
-	TurningDirection turning_direction = BOTHDIRECTIONS; // Default
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 2)
-		{
-			return (TurningDirection)(watch_movement_suppliers_.at(0).GetAllRequirements().at(2).first.GetTurningDirection());
-		}
-	}
-	return turning_direction;
-}
-
-void WatchWinder::SetFirstwatchname(String name)
-{
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 0)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(0).first.SetName(name);
-			Serial.println("SetFirstwatchname() SUCCESS");
-		}
-	}
-}
-
-void WatchWinder::SetFirstwatchturnsperday(int revolutions_per_day)
-{
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 0)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(0).first.SetRevolutionsPerDay(revolutions_per_day);
-			Serial.println("SetFirstwatchturnsperday() SUCCESS");
-		}
-	}
-}
-
-void WatchWinder::SetFirstwatchturndirection(TurningDirection turning_direction)
-{
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 0)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(0).first.SetTurningDirection(turning_direction);
-			Serial.println("SetFirstwatchturndirection() SUCCESS");
-		}
-	}
-}
-
-void WatchWinder::SetSecondwatchname(String name)
-{
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 1)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(1).first.SetName(name);
-			Serial.println("SetSecondwatchname() SUCCESS");
-		}
-	}
-}
-
-void WatchWinder::SetSecondwatchturnsperday(int revolutions_per_day)
-{
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 1)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(1).first.SetRevolutionsPerDay(revolutions_per_day);
-			Serial.println("SetSecondwatchturnsperday() SUCCESS");
-		}
-	}
-}
-
-void WatchWinder::SetSecondwatchturndirection(TurningDirection turning_direction)
-{
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 1)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(1).first.SetTurningDirection(turning_direction);
-			Serial.println("SetSecondwatchturndirection() SUCCESS");
-		}
-	}
-}
+    if (!watches_cache_.IsValid())
+    {
+        watches_cache_.Store(GetWatchesJSON());
+    }
+    return watches_cache_.GetBody();
+}
+
+String WatchWinder::GetStatusJSON()
+{
+    String json = "{";
+    json += "\"time\":"                + (String)nowCached()                        + ",";
+    json += "\"utcoffset\":"           + (String)time_zone_.GetOffset(nowCached())  + ",";
+    json += "\"timestatus\":"          + (String)(int)timeStatus()                  + ",";
+    json += "\"lastsync\":"            + (String)NtpServers.GetLastSync()           + ",";
+    json += "\"clockdriftppb\":"       + (String)SystemClock.GetDriftPPB()          + ",";
+    json += "\"clockoffsetms\":"       + (String)SystemClock.GetLastOffsetMillis()  + ",";
+    json += "\"clockpollinterval\":"   + (String)SystemClock.GetPollInterval()      + ",";
+    json += "\"clockerrorms\":"        + (String)SystemClock.GetErrorBoundMillis()  + ",";
+    json += "\"clockprovisional\":"    + (String)(SystemClock.IsProvisional() ? "true" : "false") + ",";
+    int ntp_server = NtpServers.GetPreferredServer();
+    if (ntp_server >= 0)
+    {
+        json += "\"ntpserver\":\""        + (String)NtpServers.GetServer(ntp_server).name   + "\",";
+        json += "\"ntprtt\":"              + (String)NtpServers.GetServer(ntp_server).rtt_ms + ",";
+    }
+    json += "\"inallowedtimeframe\":"  + (String)(in_allowed_time_frame_ ? "true" : "false") + ",";
+    json += "\"nextwindowevent\":"     + (String)next_window_event_                 + ",";
+    json += "\"moving\":"              + (String)(movement_planner_.IsMoving() ? "true" : "false") + ",";
+    json += "\"uptime\":"              + (String)(uint32_t)(Monotonic.Millis() / 1000) + ",";
+    json += "\"freeheap\":"            + (String)ESP.getFreeHeap()                  + ",";
+    json += "\"maxfreeblock\":"        + (String)ESP.getMaxFreeBlockSize()          + "}";
 
-void WatchWinder::SetThirdwatchname(String name)
-{
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 2)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(2).first.SetName(name);
-			Serial.println("SetThirdwatchname() SUCCESS");
-		}
-	}
-}
+    return json;
+}
 
-void WatchWinder::SetThirdwatchturnsperday(int revolutions_per_day)
+String WatchWinder::GetStateJSON()
 {
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 2)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(2).first.SetRevolutionsPerDay(revolutions_per_day);
-			Serial.println("SetThirdwatchturnsperday() SUCCESS");
-		}
-	}
-}
+    String json = "{";
+    json += "\"timesettings\":" + GetCachedTimesettingsJSON() + ",";
+    json += "\"watches\":"      + GetCachedWatchesJSON()      + ",";
+    json += "\"status\":"       + GetStatusJSON()             + "}";
 
-void WatchWinder::SetThirdwatchturndirection(TurningDirection turning_direction)
-{
-	if (watch_movement_suppliers_.size() > 0)
-	{
-		if (watch_movement_suppliers_.at(0).GetAllRequirements().size() > 2)
-		{
-			watch_movement_suppliers_.at(0).GetAllRequirements().at(2).first.SetTurningDirection(turning_direction);
-			Serial.println("SetThirdwatchturndirection() SUCCESS");
-		}
-	}
+    return json;
 }
@@ -14,21 +14,43 @@
 #include <DNSServer.h>            // Local DNS Server used for redirecting all requests to the configuration portal
 #include <ESP8266WebServer.h>     // Local WebServer used to serve the configuration portal
 #include <WiFiManager.h>          // https://github.com/tzapu/WiFiManager WiFi Configuration Magic
-
-#include <ArduinoJson.h>          // https://github.com/bblanchon/ArduinoJson
+#include <StreamString.h>
 
 #include "NTPClient.h"
+#include "ClockDiscipline.h"
+#include "NtpServerPool.h"
+#include "RtcTimeStore.h"
+#include "LogStore.h"
+#include "ConfigJson.h"
+#include "TimeZone.h"
+#include "Fnv1a.h"
+#include "ResponseBufferPool.h"
+#include "ResponseCache.h"
 
 #include "WatchMovementSupplier.h"
+#include "MovementPlanner.h"
+#include "WindingHistory.h"
+#include "CaliberPresets.h"
+#include "WebRoutes.h"
 
 #include "Timesettings.h"
 
 #include "data.h"
 #include <time.h>
 
-#define BUFFER_SIZE 10000
+#define WATCHES_SAVE_DELAY_MS 5000   // edits of the watches within this time are saved together
+#define HISTORY_PAGE_DEFAULT  20     // entries per /api/history response without limit argument
+#define HISTORY_PAGE_MAX      HISTORY_MAX_ENTRIES
+#define CALIBERS_PAGE_DEFAULT 10     // presets per /api/calibers response without limit argument
 
 
+enum RangeRequest
+{
+    RANGE_FULL = 0,         // no (usable) Range header, send the whole file
+    RANGE_PARTIAL,
+    RANGE_UNSATISFIABLE
+};
+
 class WatchWinder
 {
 public:
@@ -37,60 +59,65 @@ public:
     void Setup();
     void Step();
     void AddWatchMovementSupplier();
-    std::vector<WatchMovementSupplier> GetAllWatchMovementSuppliers();
+    std::vector<WatchMovementSupplier>& Suppliers();
+    size_t GetSupplierCount();
+    size_t GetWatchCount(size_t supplier);
+    WatchRequirement& Watch(size_t supplier, size_t watch);
 private:
     void SetupWatchMovementSuppliers();
+    void SetDefaultWatches(WatchMovementSupplier& stepper_providing_movement);
+    void LoadWatches();
+    void SaveWatches();
+    void WatchesChanged(size_t supplier = REQUIREMENTS_ALL_SUPPLIERS);
     void ReadConfig();
+    bool SaveConfig();
     void SetupWifiManager();
     void SetupMovement();
+    void SetupClock();
     void SetupNTPClient();
-    bool InAllowedTimeFrameOfDay();
+    void UpdateAllowedTimeFrame(time_t t);
+    void HandleRequest();
     void HandleRoot();
     void HandleSettingsHTML();
     void HandleWatchesHTML();
     void HandleInfoHTML();
+#ifndef DATA_BUNDLED
     void HandleTimesettingsJS();
     void HandleWatchesJS();
     void HandleFunctionsJS();
     void HandleStyleCSS();
+#endif
     void HandleTimesettingsJSON();
     void HandleTimesettingsSaveJSON();
     void HandleTimesettingsResetJSON();
+    void HandleTimesettingsRollbackJSON();
     void HandleWatchesJSON();
     void HandleWatchesSaveJSON();
     void HandleWatchesResetJSON();
+    void HandleStateJSON();
+    void HandleHistoryAPI();
+    void HandleCalibersAPI();
     void HandleRestartESPJSON();
     void SaveConfigCallback();
     void SendFile(int code, String type, const char* adr, size_t len);
     void SendHeader(int code, String type, size_t _size);
+    RangeRequest ParseRangeHeader(const String& range, size_t len, size_t& first, size_t& last);
     void SendBuffer();
-    void SendToBuffer(String str);
-    time_t ConvertEpochHourToUnixTimestamp(int hour, int relative_to_gmt);
+    void SendToBuffer(const String& str);
+    void SendToBuffer(const char* data, size_t length);
+    void SendCachedJSON(ResponseCache& cache);
 	void ApplyTimesettings();
 	String GetWatchesJSON();
-	String GetFirstwatchname();
-	int GetFirstwatchturnsperday();
-	TurningDirection GetFirstwatchturndirection();
-	String GetSecondwatchname();
-	int GetSecondwatchturnsperday();
-	TurningDirection GetSecondwatchturndirection();
-	String GetThirdwatchname();
-	int GetThirdwatchturnsperday();
-	TurningDirection GetThirdwatchturndirection();
-	void SetFirstwatchname(String name);
-	void SetFirstwatchturnsperday(int revolutions_per_day);
-	void SetFirstwatchturndirection(TurningDirection turning_direction);
-	void SetSecondwatchname(String name);
-	void SetSecondwatchturnsperday(int revolutions_per_day);
-	void SetSecondwatchturndirection(TurningDirection turning_direction);
-	void SetThirdwatchname(String name);
-	void SetThirdwatchturnsperday(int revolutions_per_day);
-	void SetThirdwatchturndirection(TurningDirection turning_direction);
+	const String& GetCachedTimesettingsJSON();
+	const String& GetCachedWatchesJSON();
+	String GetStatusJSON();
+	String GetStateJSON();
 
     WiFiManager wifi_manager_;
     ESP8266WebServer web_server_;
     
     Timesettings timesettings_;
+    TimeZone time_zone_;
 
     // define your default values here, if there are different values in config.json, they are overwritten.
     char mqtt_server_[40];
@@ -105,12 +132,21 @@ private:
     bool save_config_;
     
     std::vector<WatchMovementSupplier> watch_movement_suppliers_;
-    time_t earliest_allowed_movement_;
-    time_t latest_allowed_movement_;
+    MovementPlanner movement_planner_;
+    WindingHistory history_;
+    bool watches_dirty_;              // changed, but not yet saved
+    uint64_t watches_changed_millis_; // Monotonic.Millis() of the last change
+
+    // Allowed time frame as absolute timestamps, recomputed only when current time leaves [previous, next)
+    time_t previous_window_event_;
+    time_t next_window_event_;
+    bool in_allowed_time_frame_;
 
-    int buffer_counter_; //buffer counter;
+    ResponseCache timesettings_cache_;
+    ResponseCache watches_cache_;
 
-    char data_website_buffer_[BUFFER_SIZE];
+    char* response_chunk_;   // chunk of ResponsePool, only held while a response is assembled
+    size_t buffer_counter_;  // bytes used in response_chunk_
 };
 
 #endif // #ifndef WATCHWINDER_H
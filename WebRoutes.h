@@ -0,0 +1,51 @@
+//
+//  WebRoutes.h - Paths served by the web server, dispatched through a hash switch in HandleRequest().
+//  License: MIT
+//
+#ifndef WEBROUTES_H
+#define WEBROUTES_H
+
+#include <stdint.h>
+
+#include "Fnv1a.h"
+
+#define WEB_ROUTE_SLOTS 32           // size of the dispatch table in HandleRequest(), power of two
+#define WEB_ROUTE_SEED  0x811C9E0BUL // FNV-1a seed for which no two routes share a slot
+
+// X(path, handler) - a new path may need a new WEB_ROUTE_SEED
+#define WEB_ROUTES(X)                                                   \
+    /* HTML */                                                          \
+    X("/",                          HandleRoot)                         \
+    X("/index.html",                HandleRoot)                         \
+    X("/watches.html",              HandleWatchesHTML)                  \
+    X("/settings.html",             HandleSettingsHTML)                 \
+    X("/info.html",                 HandleInfoHTML)                     \
+    /* JSON */                                                          \
+    X("/timesettings.json",         HandleTimesettingsJSON)             \
+    X("/timesettingsSave.json",     HandleTimesettingsSaveJSON)         \
+    X("/timesettingsReset.json",    HandleTimesettingsResetJSON)        \
+    X("/timesettingsRollback.json", HandleTimesettingsRollbackJSON)     \
+    X("/watches.json",              HandleWatchesJSON)                  \
+    X("/watchesSave.json",          HandleWatchesSaveJSON)              \
+    X("/watchesReset.json",         HandleWatchesResetJSON)             \
+    X("/restartESP.json",           HandleRestartESPJSON)               \
+    X("/state.json",                HandleStateJSON)                    \
+    /* API */                                                           \
+    X("/api/history",               HandleHistoryAPI)                   \
+    X("/api/calibers",              HandleCalibersAPI)
+
+// Only served without DATA_BUNDLED, bundled pages carry their JS and CSS inline
+#define WEB_ROUTES_UNBUNDLED(X)                                         \
+    X("/js/timesettings.js",        HandleTimesettingsJS)               \
+    X("/js/watches.js",             HandleWatchesJS)                    \
+    X("/js/functions.js",           HandleFunctionsJS)                  \
+    X("/style.css",                 HandleStyleCSS)
+
+// Slot of a route in the dispatch table of HandleRequest(). Two routes sharing a slot do not compile
+// ("duplicate case value"), pick another WEB_ROUTE_SEED in that case.
+constexpr uint8_t WebRouteSlot(uint32_t hash)
+{
+    return (uint8_t)((hash ^ (hash >> 16)) & (WEB_ROUTE_SLOTS - 1));
+}
+
+#endif // #ifndef WEBROUTES_H
@@ -0,0 +1,264 @@
+//
+//  WeeklySchedule.cpp - Allowed winding windows per weekday at minute resolution.
+//  License: MIT
+//
+
+#include "WeeklySchedule.h"
+
+WeeklySchedule::WeeklySchedule()
+{
+    Clear();
+}
+
+void WeeklySchedule::Clear()
+{
+    window_count_ = 0;
+    BuildIndex();
+}
+
+// Rejects empty weekday masks, minutes beyond the day and windows exceeding the limits
+bool WeeklySchedule::AddWindow(uint8_t weekdays, uint16_t from, uint16_t to)
+{
+    if (window_count_ >= SCHEDULE_MAX_WINDOWS || weekdays == 0 || weekdays > SCHEDULE_ALL_DAYS ||
+        from >= SCHEDULE_MINUTES_PER_DAY || to >= SCHEDULE_MINUTES_PER_DAY)
+    {
+        return false;
+    }
+    for (uint8_t day = 0; day < DAYS_PER_WEEK; day++)
+    {
+        if (!(weekdays & (1 << day)))
+        {
+            continue;
+        }
+        uint8_t windows_on_day = 0;
+        for (uint8_t idx = 0; idx < window_count_; idx++)
+        {
+            if (windows_[idx].weekdays & (1 << day))
+            {
+                windows_on_day++;
+            }
+        }
+        if (windows_on_day >= SCHEDULE_MAX_WINDOWS_PER_DAY)
+        {
+            return false;
+        }
+    }
+
+    ScheduleWindow& window = windows_[window_count_++];
+    window.weekdays = weekdays;
+    window.from = from;
+    window.to = to;
+    BuildIndex();
+    return true;
+}
+
+uint8_t WeeklySchedule::GetWindowCount()
+{
+    return window_count_;
+}
+
+const ScheduleWindow& WeeklySchedule::GetWindow(uint8_t idx)
+{
+    return windows_[idx];
+}
+
+// "weekdays,from,to;weekdays,from,to;..." e.g. "62,480,720;65,600,1260", an empty string allows no time at all.
+// Keeps the previous windows and returns false if text can not be parsed.
+bool WeeklySchedule::FromString(const char* text)
+{
+    if (text == nullptr)
+    {
+        return false;
+    }
+    WeeklySchedule parsed;
+    const char* p = text;
+    while (*p != '\0')
+    {
+        unsigned long values[3];
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            char* end;
+            if (!isdigit(*p))
+            {
+                return false;
+            }
+            values[i] = strtoul(p, &end, 10);
+            p = end;
+            if (i < 2 && *p++ != ',')
+            {
+                return false;
+            }
+        }
+        if (values[0] > 0xFF || values[1] > 0xFFFF || values[2] > 0xFFFF ||
+            !parsed.AddWindow((uint8_t)values[0], (uint16_t)values[1], (uint16_t)values[2]))
+        {
+            return false;
+        }
+        if (*p == ';')
+        {
+            p++;
+        }
+        else if (*p != '\0')
+        {
+            return false;
+        }
+    }
+    *this = parsed;
+    return true;
+}
+
+bool WeeklySchedule::IsAllowed(time_t local)
+{
+    time_t previous_change, next_change;
+    return Lookup(local, previous_change, next_change);
+}
+
+// Returns whether local is inside a window. previous_change and next_change receive the local times
+// around local at which this may change, the whole week if the schedule is always or never allowed.
+bool WeeklySchedule::Lookup(time_t local, time_t& previous_change, time_t& next_change)
+{
+    time_t week_start = previousSunday(local);
+    uint16_t minute = (uint16_t)((local - week_start) / SECS_PER_MIN);
+
+    if (interval_count_ == 0 || allowed_minutes_per_week_ == SCHEDULE_MINUTES_PER_WEEK)
+    {
+        previous_change = week_start;
+        next_change     = week_start + SECS_PER_WEEK;
+        return interval_count_ != 0;
+    }
+
+    int idx = FindInterval(minute);
+    if (idx >= 0 && minute < intervals_[idx].end)
+    {
+        previous_change = week_start + intervals_[idx].begin * SECS_PER_MIN;
+        next_change     = week_start + intervals_[idx].end * SECS_PER_MIN;
+        return true;
+    }
+
+    const ScheduleInterval& first = intervals_[0];
+    const ScheduleInterval& last  = intervals_[interval_count_ - 1];
+    previous_change = (idx >= 0) ? week_start + intervals_[idx].end * SECS_PER_MIN
+                                 : week_start - (time_t)(SCHEDULE_MINUTES_PER_WEEK - last.end) * SECS_PER_MIN;
+    next_change     = (idx + 1 < interval_count_) ? week_start + intervals_[idx + 1].begin * SECS_PER_MIN
+                                                  : week_start + (time_t)(SCHEDULE_MINUTES_PER_WEEK + first.begin) * SECS_PER_MIN;
+    return false;
+}
+
+// local itself if it is inside a window, 0 if no window exists
+time_t WeeklySchedule::GetNextAllowedStart(time_t local)
+{
+    time_t previous_change, next_change;
+    if (Lookup(local, previous_change, next_change))
+    {
+        return local;
+    }
+    return (interval_count_ == 0) ? 0 : next_change;
+}
+
+uint16_t WeeklySchedule::GetAllowedMinutesPerWeek()
+{
+    return allowed_minutes_per_week_;
+}
+
+// Allowed minutes between two local times, walking from change to change
+uint32_t WeeklySchedule::GetAllowedMinutes(time_t local_from, time_t local_to)
+{
+    uint32_t seconds = 0;
+    while (local_from < local_to)
+    {
+        time_t previous_change, next_change;
+        bool allowed = Lookup(local_from, previous_change, next_change);
+        time_t until = min(next_change, local_to);
+        if (allowed)
+        {
+            seconds += until - local_from;
+        }
+        local_from = until;
+    }
+    return seconds / SECS_PER_MIN;
+}
+
+// Index of the last interval beginning at or before minute, -1 if there is none
+int WeeklySchedule::FindInterval(uint16_t minute)
+{
+    int low = 0;
+    int high = interval_count_;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (intervals_[middle].begin <= minute)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low - 1;
+}
+
+// Every window on every selected day becomes one range of minutes of the week, a range crossing
+// the end of the week is split in two. The ranges are sorted and overlapping ones merged.
+void WeeklySchedule::BuildIndex()
+{
+    ScheduleInterval ranges[SCHEDULE_MAX_WINDOWS * (DAYS_PER_WEEK + 1)];
+    uint8_t range_count = 0;
+    for (uint8_t idx = 0; idx < window_count_; idx++)
+    {
+        const ScheduleWindow& window = windows_[idx];
+        if (window.from == window.to)
+        {
+            continue;
+        }
+        for (uint8_t day = 0; day < DAYS_PER_WEEK; day++)
+        {
+            if (!(window.weekdays & (1 << day)))
+            {
+                continue;
+            }
+            uint16_t begin = day * SCHEDULE_MINUTES_PER_DAY + window.from;
+            uint16_t end   = day * SCHEDULE_MINUTES_PER_DAY + window.to + (window.to < window.from ? SCHEDULE_MINUTES_PER_DAY : 0);
+            if (end > SCHEDULE_MINUTES_PER_WEEK)
+            {
+                ranges[range_count].begin = 0;
+                ranges[range_count].end   = end - SCHEDULE_MINUTES_PER_WEEK;
+                range_count++;
+                end = SCHEDULE_MINUTES_PER_WEEK;
+            }
+            ranges[range_count].begin = begin;
+            ranges[range_count].end   = end;
+            range_count++;
+        }
+    }
+
+    for (uint8_t i = 1; i < range_count; i++)
+    {
+        ScheduleInterval range = ranges[i];
+        uint8_t j = i;
+        while (j > 0 && ranges[j - 1].begin > range.begin)
+        {
+            ranges[j] = ranges[j - 1];
+            j--;
+        }
+        ranges[j] = range;
+    }
+
+    interval_count_ = 0;
+    allowed_minutes_per_week_ = 0;
+    for (uint8_t i = 0; i < range_count; i++)
+    {
+        if (interval_count_ > 0 && ranges[i].begin <= intervals_[interval_count_ - 1].end)
+        {
+            intervals_[interval_count_ - 1].end = max(intervals_[interval_count_ - 1].end, ranges[i].end);
+        }
+        else
+        {
+            intervals_[interval_count_++] = ranges[i];
+        }
+    }
+    for (uint8_t i = 0; i < interval_count_; i++)
+    {
+        allowed_minutes_per_week_ += intervals_[i].end - intervals_[i].begin;
+    }
+}
@@ -0,0 +1,65 @@
+//
+//  WeeklySchedule.h - Allowed winding windows per weekday at minute resolution.
+//  License: MIT
+//
+#ifndef WEEKLYSCHEDULE_H
+#define WEEKLYSCHEDULE_H
+
+#include <Arduino.h>
+#include "TimeLib.h"
+
+#define SCHEDULE_MINUTES_PER_DAY      1440
+#define SCHEDULE_MINUTES_PER_WEEK     10080  // minute 0 is sunday 00:00, like the week of TimeLib
+#define SCHEDULE_MAX_WINDOWS          8
+#define SCHEDULE_MAX_WINDOWS_PER_DAY  4
+#define SCHEDULE_MAX_INTERVALS        (SCHEDULE_MAX_WINDOWS * 7 + 1) // every window on every day, one split at the end of the week
+#define SCHEDULE_ALL_DAYS             0x7F
+#define SCHEDULE_DEFAULT              "127,600,1260" // every day from 10:00 to 21:00
+
+// A window applies to every weekday set in weekdays (bit 0 is sunday). It starts at from and ends
+// before to, both in minutes of the day. If to is before from the window ends on the next day.
+struct ScheduleWindow
+{
+    uint8_t weekdays;
+    uint16_t from;
+    uint16_t to;
+};
+
+// Half open range [begin, end) of minutes of the week
+struct ScheduleInterval
+{
+    uint16_t begin;
+    uint16_t end;
+};
+
+class WeeklySchedule
+{
+public:
+    WeeklySchedule();
+
+    void Clear();
+    bool AddWindow(uint8_t weekdays, uint16_t from, uint16_t to);
+    uint8_t GetWindowCount();
+    const ScheduleWindow& GetWindow(uint8_t idx);
+    bool FromString(const char* text);
+
+    bool IsAllowed(time_t local);
+    bool Lookup(time_t local, time_t& previous_change, time_t& next_change);
+    time_t GetNextAllowedStart(time_t local);
+    uint16_t GetAllowedMinutesPerWeek();
+    uint32_t GetAllowedMinutes(time_t local_from, time_t local_to);
+
+private:
+    void BuildIndex();
+    int FindInterval(uint16_t minute);
+
+    ScheduleWindow windows_[SCHEDULE_MAX_WINDOWS];
+    uint8_t window_count_;
+
+    // Sorted and merged, rebuilt whenever a window is added
+    ScheduleInterval intervals_[SCHEDULE_MAX_INTERVALS];
+    uint8_t interval_count_;
+    uint16_t allowed_minutes_per_week_;
+};
+
+#endif // #ifndef WEEKLYSCHEDULE_H
@@ -0,0 +1,238 @@
+//
+//  WindingHistory.cpp - Ring of per-day, per-watch winding records kept in the flash log.
+//  License: MIT
+//
+
+#include "WindingHistory.h"
+#include "Crc32.h"
+
+static_assert(sizeof(HistoryRing) <= LOGSTORE_MAX_RECORD_SIZE, "HistoryRing does not fit into a log record");
+
+static uint16_t AddSaturated(uint16_t value, uint32_t increment)
+{
+    return (uint16_t)min((uint32_t)value + increment, (uint32_t)0xFFFF);
+}
+
+WindingHistory::WindingHistory()
+    : open_day_(0),
+      stored_day_(0),
+      last_flush_millis_(0)
+{
+    memset(&ring_, 0, sizeof(ring_));
+}
+
+void WindingHistory::Load()
+{
+    if (FlashLog.Read(LOGSTORE_KEY_HISTORY, &ring_, sizeof(ring_)) != (int)sizeof(ring_) ||
+        ring_.count > HISTORY_MAX_ENTRIES || ring_.head >= HISTORY_MAX_ENTRIES)
+    {
+        memset(&ring_, 0, sizeof(ring_));
+    }
+    LoadDay();
+    LoadFromRtc();
+}
+
+// The running day is newer than its entries in the ring. Records written before it had a key of its
+// own are not there, the ring alone is complete then.
+void WindingHistory::LoadDay()
+{
+    HistoryDay day;
+    int length = FlashLog.Read(LOGSTORE_KEY_HISTORY_DAY, &day, sizeof(day));
+    if (length < (int)offsetof(HistoryDay, entries) || day.count > HISTORY_DAY_MAX_ENTRIES ||
+        length != (int)(offsetof(HistoryDay, entries) + day.count * sizeof(HistoryEntry)))
+    {
+        return;
+    }
+    for (uint16_t idx = 0; idx < day.count; idx++)
+    {
+        const HistoryEntry& stored = day.entries[idx];
+        HistoryEntry* entry = FindEntry(stored.day, stored.supplier, stored.watch);
+        *(entry != nullptr ? entry : &Append()) = stored;
+    }
+    ring_.accounted_until = day.accounted_until;
+    stored_day_ = (day.count > 0) ? day.entries[0].day : 0;
+}
+
+// After a reset the gap is known to the second instead of to the last flush
+void WindingHistory::LoadFromRtc()
+{
+    HistoryRtcRecord record;
+    if (!RtcTime.IsMemoryKept() || !ESP.rtcUserMemoryRead(HISTORY_RTC_OFFSET, (uint32_t*)&record, sizeof(record)))
+    {
+        return;
+    }
+    if (record.magic == HISTORY_RTC_MAGIC && record.crc == Crc32(&record, offsetof(HistoryRtcRecord, crc)))
+    {
+        ring_.accounted_until = record.accounted_until;
+    }
+}
+
+// Called from the main loop while the time is set. Adds what the planner delivered since the last
+// call to the entries of the day and the window time lost to gaps, e.g. while switched off.
+void WindingHistory::Step(std::vector<WatchMovementSupplier>& suppliers, MovementPlanner& planner, WeeklySchedule& schedule, time_t local)
+{
+    uint16_t today = (uint16_t)(local / SECS_PER_DAY);
+    if (today != open_day_)
+    {
+        OpenDay(suppliers, today);
+    }
+
+    if (ring_.accounted_until != 0 && local - (time_t)ring_.accounted_until > HISTORY_GAP_SECONDS)
+    {
+        time_t from = max((time_t)ring_.accounted_until, (time_t)today * SECS_PER_DAY);
+        uint32_t missed = schedule.GetAllowedMinutes(from, local);
+        for (uint8_t idx = 0; idx < suppliers.size(); idx++)
+        {
+            for (uint8_t watch = 0; watch < suppliers[idx].GetAllRequirements().size(); watch++)
+            {
+                HistoryEntry* entry = FindEntry(today, idx, watch);
+                if (entry != nullptr)
+                {
+                    entry->missed_minutes = AddSaturated(entry->missed_minutes, missed);
+                }
+            }
+        }
+    }
+    ring_.accounted_until = (uint32_t)local;
+
+    if (counted_.size() != suppliers.size())
+    {
+        counted_.resize(suppliers.size(), SupplierPlan());
+    }
+    for (uint8_t idx = 0; idx < suppliers.size(); idx++)
+    {
+        const SupplierPlan* plan = planner.GetPlan(idx);
+        if (plan == nullptr)
+        {
+            continue;
+        }
+        SupplierPlan& counted = counted_[idx];
+        uint32_t clockwise = plan->turns_clockwise - counted.turns_clockwise;
+        uint32_t counterclockwise = plan->turns_counterclockwise - counted.turns_counterclockwise;
+        uint32_t seconds = (uint32_t)((plan->motor_micros - counted.motor_micros) / 1000000);
+        if (clockwise == 0 && counterclockwise == 0 && seconds == 0)
+        {
+            continue;
+        }
+        counted.turns_clockwise = plan->turns_clockwise;
+        counted.turns_counterclockwise = plan->turns_counterclockwise;
+        counted.motor_micros += (uint64_t)seconds * 1000000;
+
+        // watches not turning like the stepper see the other direction
+        for (uint8_t watch = 0; watch < suppliers[idx].GetAllRequirements().size(); watch++)
+        {
+            HistoryEntry* entry = FindEntry(today, idx, watch);
+            if (entry == nullptr)
+            {
+                OpenDay(suppliers, today); // watch added during the day
+                entry = FindEntry(today, idx, watch);
+            }
+            bool turning_like_stepper = suppliers[idx].GetAllRequirements()[watch].second;
+            entry->turns_clockwise = AddSaturated(entry->turns_clockwise, turning_like_stepper ? clockwise : counterclockwise);
+            entry->turns_counterclockwise = AddSaturated(entry->turns_counterclockwise, turning_like_stepper ? counterclockwise : clockwise);
+            entry->motor_seconds = AddSaturated(entry->motor_seconds, seconds);
+        }
+    }
+
+    if (Monotonic.Millis() - last_flush_millis_ >= HISTORY_FLUSH_MS)
+    {
+        Flush();
+    }
+}
+
+// Only the entries of the running day, the closed days were written by OpenDay() when the day changed
+void WindingHistory::Flush()
+{
+    HistoryDay day;
+    day.accounted_until = ring_.accounted_until;
+    day.count = 0;
+    for (uint16_t idx = 0; idx < ring_.count && day.count < HISTORY_DAY_MAX_ENTRIES; idx++)
+    {
+        const HistoryEntry& entry = GetEntry(idx);
+        if (entry.day == open_day_)
+        {
+            day.entries[day.count++] = entry;
+        }
+    }
+    FlashLog.Write(LOGSTORE_KEY_HISTORY_DAY, &day, offsetof(HistoryDay, entries) + day.count * sizeof(HistoryEntry));
+    stored_day_ = open_day_;
+    last_flush_millis_ = Monotonic.Millis();
+}
+
+// Called with the save of the time, once per RTC_TIME_SAVE_INTERVAL
+void WindingHistory::SaveToRtc()
+{
+    if (ring_.accounted_until == 0)
+    {
+        return;
+    }
+    HistoryRtcRecord record;
+    record.magic           = HISTORY_RTC_MAGIC;
+    record.accounted_until = ring_.accounted_until;
+    record.crc             = Crc32(&record, offsetof(HistoryRtcRecord, crc));
+    ESP.rtcUserMemoryWrite(HISTORY_RTC_OFFSET, (uint32_t*)&record, sizeof(record));
+}
+
+uint16_t WindingHistory::GetCount()
+{
+    return ring_.count;
+}
+
+// 0 is the oldest entry
+const HistoryEntry& WindingHistory::GetEntry(uint16_t idx)
+{
+    return ring_.entries[(ring_.head + idx) % HISTORY_MAX_ENTRIES];
+}
+
+// Every watch gets an entry for the day, so days without any turns show up as well.
+// After a reset during the day the entries read by Load() are continued.
+void WindingHistory::OpenDay(std::vector<WatchMovementSupplier>& suppliers, uint16_t day)
+{
+    for (uint8_t idx = 0; idx < suppliers.size(); idx++)
+    {
+        for (uint8_t watch = 0; watch < suppliers[idx].GetAllRequirements().size(); watch++)
+        {
+            if (FindEntry(day, idx, watch) == nullptr)
+            {
+                HistoryEntry& entry = Append();
+                memset(&entry, 0, sizeof(entry));
+                entry.day = day;
+                entry.supplier = idx;
+                entry.watch = watch;
+                entry.required_turns = suppliers[idx].GetAllRequirements()[watch].first.GetRevolutionsPerDay();
+            }
+        }
+    }
+    open_day_ = day;
+    // the day in LOGSTORE_KEY_HISTORY_DAY is closed and goes into the ring before that record is reused
+    if (day != stored_day_)
+    {
+        FlashLog.Write(LOGSTORE_KEY_HISTORY, &ring_, sizeof(ring_));
+    }
+    Flush();
+}
+
+HistoryEntry* WindingHistory::FindEntry(uint16_t day, uint8_t supplier, uint8_t watch)
+{
+    for (uint16_t idx = ring_.count; idx > 0; idx--)
+    {
+        HistoryEntry& entry = ring_.entries[(ring_.head + idx - 1) % HISTORY_MAX_ENTRIES];
+        if (entry.day == day && entry.supplier == supplier && entry.watch == watch)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// The oldest entry is overwritten once the ring is full
+HistoryEntry& WindingHistory::Append()
+{
+    if (ring_.count < HISTORY_MAX_ENTRIES)
+    {
+        return ring_.entries[(ring_.head + ring_.count++) % HISTORY_MAX_ENTRIES];
+    }
+    HistoryEntry& entry = ring_.entries[ring_.head];
+    ring_.head = (ring_.head + 1) % HISTORY_MAX_ENTRIES;
+    return entry;
+}
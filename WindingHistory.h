@@ -0,0 +1,91 @@
+//
+//  WindingHistory.h - Ring of per-day, per-watch winding records kept in the flash log.
+//  License: MIT
+//
+#ifndef WINDINGHISTORY_H
+#define WINDINGHISTORY_H
+
+#include <Arduino.h>
+#include <vector>
+
+#include "TimeLib.h"
+#include "LogStore.h"
+#include "MonotonicClock.h"
+#include "RtcTimeStore.h"
+#include "MovementPlanner.h"
+#include "WeeklySchedule.h"
+#include "WatchMovementSupplier.h"
+
+#define HISTORY_MAX_ENTRIES      72                   // 24 days of three watches, the whole ring is one log record
+#define HISTORY_DAY_MAX_ENTRIES  8                    // of the running day, one per watch
+#define HISTORY_FLUSH_MS         (15UL * 60 * 1000)   // the running day is written at least this often
+#define HISTORY_GAP_SECONDS      120                  // longer gaps between two Step() calls count as missed time
+#define HISTORY_RTC_OFFSET       (RTC_TIME_RECORD_OFFSET + sizeof(RtcTimeRecord) / 4)  // in 4 byte blocks, right behind the time
+#define HISTORY_RTC_MAGIC        0x57574843UL
+
+struct __attribute__((packed)) HistoryEntry
+{
+    uint16_t day;                       // local days since 1970
+    uint8_t supplier;
+    uint8_t watch;
+    uint16_t required_turns;            // GetRevolutionsPerDay() when the day was opened
+    uint16_t turns_clockwise;           // watch turns as seen by the watch
+    uint16_t turns_counterclockwise;
+    uint16_t motor_seconds;             // on-time of the stepper of the supplier
+    uint16_t missed_minutes;            // window minutes the winder was off or had no time. A power cut
+                                        // counts the time since the last flush, as nothing newer is known.
+};
+
+struct __attribute__((packed)) HistoryRing
+{
+    uint32_t accounted_until;           // local time up to which missed minutes are counted
+    uint16_t count;
+    uint16_t head;                      // index of the oldest entry
+    HistoryEntry entries[HISTORY_MAX_ENTRIES];
+};
+
+// Written every HISTORY_FLUSH_MS instead of the whole ring, only count entries long
+struct __attribute__((packed)) HistoryDay
+{
+    uint32_t accounted_until;
+    uint16_t count;
+    HistoryEntry entries[HISTORY_DAY_MAX_ENTRIES];
+};
+
+// accounted_until of the last second, survives a reset but not a power cut
+struct HistoryRtcRecord
+{
+    uint32_t magic;
+    uint32_t accounted_until;
+    uint32_t crc;
+};
+
+class WindingHistory
+{
+public:
+    WindingHistory();
+
+    void Load();
+    void Step(std::vector<WatchMovementSupplier>& suppliers, MovementPlanner& planner, WeeklySchedule& schedule, time_t local);
+    void Flush();
+    void SaveToRtc();
+
+    uint16_t GetCount();
+    const HistoryEntry& GetEntry(uint16_t idx);
+
+private:
+    void OpenDay(std::vector<WatchMovementSupplier>& suppliers, uint16_t day);
+    HistoryEntry* FindEntry(uint16_t day, uint8_t supplier, uint8_t watch);
+    HistoryEntry& Append();
+
+    void LoadDay();
+    void LoadFromRtc();
+
+    HistoryRing ring_;
+    uint16_t open_day_;
+    uint16_t stored_day_;                // of the entries in LOGSTORE_KEY_HISTORY_DAY, 0 for none
+    std::vector<SupplierPlan> counted_;  // planner totals already added to the ring
+    uint64_t last_flush_millis_;
+};
+
+#endif // #ifndef WINDINGHISTORY_H
@@ -5,11 +5,11 @@
 
 const char data_watchesHTML[] PROGMEM =
 {
-0x3c,0x21,0x44,0x6f,0x63,0x74,0x79,0x70,0x65,0x20,0x68,0x74,0x6d,0x6c,0x3e,0x0a,0x3c,0x68,0x74,0x6d,0x6c,0x3e,0x0a,0x3c,0x68,0x65,0x61,0x64,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x63,0x68,0x61,0x72,0x73,0x65,0x74,0x3d,0x75,0x74,0x66,0x2d,0x38,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x76,0x69,0x65,0x77,0x70,0x6f,0x72,0x74,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x77,0x69,0x64,0x74,0x68,0x3d,0x64,0x65,0x76,0x69,0x63,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x2c,0x20,0x69,0x6e,0x69,0x74,0x69,0x61,0x6c,0x2d,0x73,0x63,0x61,0x6c,0x65,0x3d,0x30,0x2e,0x38,0x2c,0x20,0x6d,0x69,0x6e,0x69,0x6d,0x61,0x6c,0x2d,0x75,0x69,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x64,0x65,0x73,0x63,0x72,0x69,0x70,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x45,0x53,0x50,0x38,0x32,0x36,0x36,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x61,0x75,0x74,0x68,0x6f,0x72,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x20,0x42,0x72,0x79,0x61,0x6e,0x20,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x74,0x68,0x65,0x6d,0x65,0x2d,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x23,0x33,0x36,0x33,0x39,0x33,0x45,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x69,0x74,0x6c,0x65,0x3e,0x45,0x53,0x50,0x38,0x32,0x36,0x36,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x3c,0x2f,0x74,0x69,0x74,0x6c,0x65,0x3e,0x0a,0x3c,0x6c,0x69,0x6e,0x6b,0x20,0x72,0x65,0x6c,0x3d,0x73,0x74,0x79,0x6c,0x65,0x73,0x68,0x65,0x65,0x74,0x20,0x68,0x72,0x65,0x66,0x3d,0x73,0x74,0x79,0x6c,0x65,0x2e,0x63,0x73,0x73,0x3e,0x0a,0x3c,0x73,0x63,0x72,0x69,0x70,0x74,0x20,0x73,0x72,0x63,0x3d,0x6a,0x73,0x2f,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x73,0x2e,0x6a,0x73,0x3e,0x3c,0x2f,0x73,0x63,0x72,0x69,0x70,0x74,0x3e,0x0a,0x3c,0x2f,0x68,0x65,0x61,0x64,0x3e,0x0a,0x3c,0x62,0x6f,0x64,0x79,0x3e,0x0a,0x3c,0x6e,0x61,0x76,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x57,0x61,0x74,0x63,0x68,0x65,0x73,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x53,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x61,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x69,0x67,0x68,0x74,0x20,0x68,0x72,0x65,0x66,0x3d,0x69,0x6e,0x66,0x6f,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x49,0x6e,0x66,0x6f,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x2f,0x6e,0x61,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x61,0x6c,0x69,0x67,0x6e,0x3d,0x63,0x65,0x6e,0x74,0x65,0x72,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6e,0x74,0x61,0x69,0x6e,0x65,0x72,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x65,0x72,0x72,0x6f,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x68,0x69,0x64,0x65,0x3e,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x68,0x31,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x68,0x65,0x61,0x64,0x65,0x72,0x3e,0x57,0x61,0x74,0x63,0x68,0x65,0x73,0x3c,0x2f,0x68,0x31,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x46,0x69,0x72,0x73,0x74,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x61,0x6c,0x69,0x67,0x6e,0x3d,0x63,0x65,0x6e,0x74,0x65,0x72,0x3e,0x0a,0x3c,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x64,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x65,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x31,0x2e,0x31,0x2f,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x63,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x63,0x72,0x65,0x61,0x74,0x69,0x76,0x65,0x63,0x6f,0x6d,0x6d,0x6f,0x6e,0x73,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x72,0x64,0x66,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x31,0x39,0x39,0x39,0x2f,0x30,0x32,0x2f,0x32,0x32,0x2d,0x72,0x64,0x66,0x2d,0x73,0x79,0x6e,0x74,0x61,0x78,0x2d,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x76,0x67,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2e,0x73,0x6f,0x75,0x72,0x63,0x65,0x66,0x6f,0x72,0x67,0x65,0x2e,0x6e,0x65,0x74,0x2f,0x44,0x54,0x44,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2d,0x30,0x2e,0x64,0x74,0x64,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x73,0x2f,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x20,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x30,0x30,0x20,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x30,0x30,0x20,0x76,0x69,0x65,0x77,0x42,0x6f,0x78,0x3d,0x22,0x30,0x20,0x30,0x20,0x35,0x32,0x2e,0x39,0x31,0x36,0x36,0x36,0x35,0x20,0x32,0x36,0x2e,0x34,0x35,0x38,0x33,0x33,0x34,0x22,0x20,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x31,0x2e,0x31,0x20,0x69,0x64,0x3d,0x73,0x76,0x67,0x31,0x34,0x39,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x22,0x30,0x2e,0x39,0x32,0x2e,0x32,0x20,0x28,0x35,0x63,0x33,0x65,0x38,0x30,0x64,0x2c,0x20,0x32,0x30,0x31,0x37,0x2d,0x30,0x38,0x2d,0x30,0x36,0x29,0x22,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x64,0x6f,0x63,0x6e,0x61,0x6d,0x65,0x3d,0x49,0x63,0x6f,0x6e,0x5f,0x57,0x61,0x74,0x63,0x68,0x77,0x69,0x6e,0x64,0x65,0x72,0x5f,0x66,0x69,0x72,0x73,0x74,0x2e,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x64,0x65,0x66,0x73,0x20,0x69,0x64,0x3d,0x64,0x65,0x66,0x73,0x31,0x34,0x39,0x30,0x20,0x2f,0x3e,0x0a,0x3c,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x6e,0x61,0x6d,0x65,0x64,0x76,0x69,0x65,0x77,0x20,0x69,0x64,0x3d,0x62,0x61,0x73,0x65,0x20,0x70,0x61,0x67,0x65,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x66,0x66,0x66,0x66,0x66,0x66,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x36,0x36,0x36,0x36,0x36,0x36,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x31,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x30,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x73,0x68,0x61,0x64,0x6f,0x77,0x3d,0x32,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x7a,0x6f,0x6f,0x6d,0x3d,0x35,0x2e,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x78,0x3d,0x37,0x38,0x2e,0x35,0x32,0x39,0x38,0x36,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x79,0x3d,0x33,0x38,0x2e,0x34,0x39,0x30,0x38,0x30,0x38,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2d,0x75,0x6e,0x69,0x74,0x73,0x3d,0x6d,0x6d,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x75,0x72,0x72,0x65,0x6e,0x74,0x2d,0x6c,0x61,0x79,0x65,0x72,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x73,0x68,0x6f,0x77,0x67,0x72,0x69,0x64,0x3d,0x66,0x61,0x6c,0x73,0x65,0x20,0x75,0x6e,0x69,0x74,0x73,0x3d,0x70,0x78,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x37,0x33,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x36,0x39,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x78,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x79,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x6d,0x61,0x78,0x69,0x6d,0x69,0x7a,0x65,0x64,0x3d,0x31,0x20,0x2f,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x20,0x69,0x64,0x3d,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x31,0x34,0x39,0x33,0x3e,0x0a,0x3c,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x20,0x72,0x64,0x66,0x3a,0x61,0x62,0x6f,0x75,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x69,0x6d,0x61,0x67,0x65,0x2f,0x73,0x76,0x67,0x2b,0x78,0x6d,0x6c,0x3c,0x2f,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x79,0x70,0x65,0x20,0x72,0x64,0x66,0x3a,0x72,0x65,0x73,0x6f,0x75,0x72,0x63,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x64,0x63,0x6d,0x69,0x74,0x79,0x70,0x65,0x2f,0x53,0x74,0x69,0x6c,0x6c,0x49,0x6d,0x61,0x67,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x69,0x74,0x6c,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x3e,0x0a,0x3c,0x2f,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x2f,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x3e,0x0a,0x3c,0x67,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x6c,0x61,0x62,0x65,0x6c,0x3d,0x22,0x45,0x62,0x65,0x6e,0x65,0x20,0x31,0x22,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x67,0x72,0x6f,0x75,0x70,0x6d,0x6f,0x64,0x65,0x3d,0x6c,0x61,0x79,0x65,0x72,0x20,0x69,0x64,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x74,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x3d,0x74,0x72,0x61,0x6e,0x73,0x6c,0x61,0x74,0x65,0x28,0x30,0x2c,0x2d,0x32,0x37,0x30,0x2e,0x35,0x34,0x31,0x36,0x35,0x29,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x20,0x63,0x78,0x3d,0x34,0x32,0x2e,0x36,0x36,0x32,0x34,0x37,0x39,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x37,0x20,0x63,0x78,0x3d,0x35,0x2e,0x33,0x39,0x33,0x32,0x35,0x34,0x38,0x20,0x63,0x79,0x3d,0x32,0x38,0x37,0x2e,0x32,0x30,0x38,0x30,0x34,0x20,0x72,0x3d,0x32,0x2e,0x33,0x38,0x33,0x39,0x34,0x31,0x32,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x20,0x63,0x78,0x3d,0x32,0x38,0x2e,0x33,0x37,0x34,0x39,0x36,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x2d,0x37,0x20,0x63,0x78,0x3d,0x31,0x34,0x2e,0x30,0x38,0x37,0x34,0x35,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x65,0x78,0x74,0x20,0x78,0x6d,0x6c,0x3a,0x73,0x70,0x61,0x63,0x65,0x3d,0x70,0x72,0x65,0x73,0x65,0x72,0x76,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x69,0x7a,0x65,0x3a,0x31,0x30,0x2e,0x35,0x38,0x33,0x33,0x33,0x33,0x30,0x32,0x70,0x78,0x3b,0x6c,0x69,0x6e,0x65,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3a,0x31,0x2e,0x32,0x35,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x73,0x61,0x6e,0x73,0x2d,0x73,0x65,0x72,0x69,0x66,0x3b,0x6c,0x65,0x74,0x74,0x65,0x72,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x77,0x6f,0x72,0x64,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x20,0x78,0x3d,0x31,0x31,0x2e,0x30,0x36,0x35,0x32,0x35,0x32,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x69,0x64,0x3d,0x74,0x65,0x78,0x74,0x32,0x31,0x36,0x36,0x3e,0x3c,0x74,0x73,0x70,0x61,0x6e,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x72,0x6f,0x6c,0x65,0x3d,0x6c,0x69,0x6e,0x65,0x20,0x69,0x64,0x3d,0x74,0x73,0x70,0x61,0x6e,0x32,0x31,0x36,0x34,0x20,0x78,0x3d,0x31,0x31,0x2e,0x30,0x36,0x35,0x32,0x35,0x32,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x76,0x61,0x72,0x69,0x61,0x6e,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x72,0x65,0x74,0x63,0x68,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x2d,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x70,0x65,0x63,0x69,0x66,0x69,0x63,0x61,0x74,0x69,0x6f,0x6e,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x3e,0x31,0x3c,0x2f,0x74,0x73,0x70,0x61,0x6e,0x3e,0x3c,0x2f,0x74,0x65,0x78,0x74,0x3e,0x0a,0x3c,0x2f,0x67,0x3e,0x0a,0x3c,0x2f,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x61,0x6d,0x65,0x20,0x6f,0x66,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x2f,0x3e,0x20,0x28,0x65,0x2e,0x67,0x2e,0x20,0x42,0x72,0x61,0x6e,0x64,0x20,0x6f,0x72,0x20,0x4d,0x6f,0x64,0x65,0x6c,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x75,0x6d,0x62,0x65,0x72,0x20,0x6f,0x66,0x20,0x54,0x75,0x72,0x6e,0x73,0x20,0x70,0x65,0x72,0x20,0x44,0x61,0x79,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x6d,0x69,0x6e,0x3d,0x30,0x20,0x6d,0x61,0x78,0x3d,0x31,0x34,0x34,0x30,0x20,0x2f,0x3e,0x20,0x52,0x65,0x76,0x6f,0x6c,0x75,0x74,0x69,0x6f,0x6e,0x73,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x52,0x65,0x71,0x75,0x69,0x72,0x65,0x64,0x20,0x54,0x75,0x72,0x6e,0x69,0x6e,0x67,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x73,0x65,0x6c,0x65,0x63,0x74,0x20,0x69,0x64,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x30,0x3e,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x31,0x3e,0x43,0x6f,0x75,0x6e,0x74,0x65,0x72,0x20,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x32,0x3e,0x42,0x6f,0x74,0x68,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x2f,0x73,0x65,0x6c,0x65,0x63,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x53,0x65,0x63,0x6f,0x6e,0x64,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x61,0x6c,0x69,0x67,0x6e,0x3d,0x63,0x65,0x6e,0x74,0x65,0x72,0x3e,0x0a,0x3c,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x64,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x65,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x31,0x2e,0x31,0x2f,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x63,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x63,0x72,0x65,0x61,0x74,0x69,0x76,0x65,0x63,0x6f,0x6d,0x6d,0x6f,0x6e,0x73,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x72,0x64,0x66,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x31,0x39,0x39,0x39,0x2f,0x30,0x32,0x2f,0x32,0x32,0x2d,0x72,0x64,0x66,0x2d,0x73,0x79,0x6e,0x74,0x61,0x78,0x2d,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x76,0x67,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2e,0x73,0x6f,0x75,0x72,0x63,0x65,0x66,0x6f,0x72,0x67,0x65,0x2e,0x6e,0x65,0x74,0x2f,0x44,0x54,0x44,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2d,0x30,0x2e,0x64,0x74,0x64,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x73,0x2f,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x20,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x30,0x30,0x20,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x30,0x30,0x20,0x76,0x69,0x65,0x77,0x42,0x6f,0x78,0x3d,0x22,0x30,0x20,0x30,0x20,0x35,0x32,0x2e,0x39,0x31,0x36,0x36,0x36,0x35,0x20,0x32,0x36,0x2e,0x34,0x35,0x38,0x33,0x33,0x34,0x22,0x20,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x31,0x2e,0x31,0x20,0x69,0x64,0x3d,0x73,0x76,0x67,0x31,0x34,0x39,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x22,0x30,0x2e,0x39,0x32,0x2e,0x32,0x20,0x28,0x35,0x63,0x33,0x65,0x38,0x30,0x64,0x2c,0x20,0x32,0x30,0x31,0x37,0x2d,0x30,0x38,0x2d,0x30,0x36,0x29,0x22,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x64,0x6f,0x63,0x6e,0x61,0x6d,0x65,0x3d,0x49,0x63,0x6f,0x6e,0x5f,0x57,0x61,0x74,0x63,0x68,0x77,0x69,0x6e,0x64,0x65,0x72,0x5f,0x73,0x65,0x63,0x6f,0x6e,0x64,0x2e,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x64,0x65,0x66,0x73,0x20,0x69,0x64,0x3d,0x64,0x65,0x66,0x73,0x31,0x34,0x39,0x30,0x20,0x2f,0x3e,0x0a,0x3c,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x6e,0x61,0x6d,0x65,0x64,0x76,0x69,0x65,0x77,0x20,0x69,0x64,0x3d,0x62,0x61,0x73,0x65,0x20,0x70,0x61,0x67,0x65,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x66,0x66,0x66,0x66,0x66,0x66,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x36,0x36,0x36,0x36,0x36,0x36,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x31,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x30,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x73,0x68,0x61,0x64,0x6f,0x77,0x3d,0x32,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x7a,0x6f,0x6f,0x6d,0x3d,0x35,0x2e,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x78,0x3d,0x34,0x39,0x2e,0x34,0x35,0x30,0x34,0x35,0x34,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x79,0x3d,0x32,0x37,0x2e,0x30,0x32,0x38,0x35,0x31,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2d,0x75,0x6e,0x69,0x74,0x73,0x3d,0x6d,0x6d,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x75,0x72,0x72,0x65,0x6e,0x74,0x2d,0x6c,0x61,0x79,0x65,0x72,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x73,0x68,0x6f,0x77,0x67,0x72,0x69,0x64,0x3d,0x66,0x61,0x6c,0x73,0x65,0x20,0x75,0x6e,0x69,0x74,0x73,0x3d,0x70,0x78,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x37,0x33,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x36,0x39,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x78,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x79,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x6d,0x61,0x78,0x69,0x6d,0x69,0x7a,0x65,0x64,0x3d,0x31,0x20,0x2f,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x20,0x69,0x64,0x3d,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x31,0x34,0x39,0x33,0x3e,0x0a,0x3c,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x20,0x72,0x64,0x66,0x3a,0x61,0x62,0x6f,0x75,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x69,0x6d,0x61,0x67,0x65,0x2f,0x73,0x76,0x67,0x2b,0x78,0x6d,0x6c,0x3c,0x2f,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x79,0x70,0x65,0x20,0x72,0x64,0x66,0x3a,0x72,0x65,0x73,0x6f,0x75,0x72,0x63,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x64,0x63,0x6d,0x69,0x74,0x79,0x70,0x65,0x2f,0x53,0x74,0x69,0x6c,0x6c,0x49,0x6d,0x61,0x67,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x69,0x74,0x6c,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x3e,0x0a,0x3c,0x2f,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x2f,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x3e,0x0a,0x3c,0x67,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x6c,0x61,0x62,0x65,0x6c,0x3d,0x22,0x45,0x62,0x65,0x6e,0x65,0x20,0x31,0x22,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x67,0x72,0x6f,0x75,0x70,0x6d,0x6f,0x64,0x65,0x3d,0x6c,0x61,0x79,0x65,0x72,0x20,0x69,0x64,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x74,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x3d,0x74,0x72,0x61,0x6e,0x73,0x6c,0x61,0x74,0x65,0x28,0x30,0x2c,0x2d,0x32,0x37,0x30,0x2e,0x35,0x34,0x31,0x36,0x35,0x29,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x20,0x63,0x78,0x3d,0x34,0x32,0x2e,0x36,0x36,0x32,0x34,0x37,0x39,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x37,0x20,0x63,0x78,0x3d,0x35,0x2e,0x33,0x39,0x33,0x32,0x35,0x34,0x38,0x20,0x63,0x79,0x3d,0x32,0x38,0x37,0x2e,0x32,0x30,0x38,0x30,0x34,0x20,0x72,0x3d,0x32,0x2e,0x33,0x38,0x33,0x39,0x34,0x31,0x32,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x2d,0x37,0x20,0x63,0x78,0x3d,0x31,0x34,0x2e,0x30,0x38,0x37,0x34,0x35,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x65,0x78,0x74,0x20,0x78,0x6d,0x6c,0x3a,0x73,0x70,0x61,0x63,0x65,0x3d,0x70,0x72,0x65,0x73,0x65,0x72,0x76,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x69,0x7a,0x65,0x3a,0x31,0x30,0x2e,0x35,0x38,0x33,0x33,0x33,0x33,0x30,0x32,0x70,0x78,0x3b,0x6c,0x69,0x6e,0x65,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3a,0x31,0x2e,0x32,0x35,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x73,0x61,0x6e,0x73,0x2d,0x73,0x65,0x72,0x69,0x66,0x3b,0x6c,0x65,0x74,0x74,0x65,0x72,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x77,0x6f,0x72,0x64,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x20,0x78,0x3d,0x32,0x35,0x2e,0x33,0x35,0x32,0x37,0x35,0x37,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x69,0x64,0x3d,0x74,0x65,0x78,0x74,0x32,0x31,0x36,0x36,0x3e,0x3c,0x74,0x73,0x70,0x61,0x6e,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x72,0x6f,0x6c,0x65,0x3d,0x6c,0x69,0x6e,0x65,0x20,0x69,0x64,0x3d,0x74,0x73,0x70,0x61,0x6e,0x32,0x31,0x36,0x34,0x20,0x78,0x3d,0x32,0x35,0x2e,0x33,0x35,0x32,0x37,0x35,0x37,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x76,0x61,0x72,0x69,0x61,0x6e,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x72,0x65,0x74,0x63,0x68,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x2d,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x70,0x65,0x63,0x69,0x66,0x69,0x63,0x61,0x74,0x69,0x6f,0x6e,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x3e,0x32,0x3c,0x2f,0x74,0x73,0x70,0x61,0x6e,0x3e,0x3c,0x2f,0x74,0x65,0x78,0x74,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x20,0x63,0x78,0x3d,0x32,0x38,0x2e,0x33,0x37,0x34,0x39,0x36,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x67,0x3e,0x0a,0x3c,0x2f,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x61,0x6d,0x65,0x20,0x6f,0x66,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x2f,0x3e,0x20,0x28,0x65,0x2e,0x67,0x2e,0x20,0x42,0x72,0x61,0x6e,0x64,0x20,0x6f,0x72,0x20,0x4d,0x6f,0x64,0x65,0x6c,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x75,0x6d,0x62,0x65,0x72,0x20,0x6f,0x66,0x20,0x54,0x75,0x72,0x6e,0x73,0x20,0x70,0x65,0x72,0x20,0x44,0x61,0x79,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x6d,0x69,0x6e,0x3d,0x30,0x20,0x6d,0x61,0x78,0x3d,0x31,0x34,0x34,0x30,0x3e,0x20,0x52,0x65,0x76,0x6f,0x6c,0x75,0x74,0x69,0x6f,0x6e,0x73,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x52,0x65,0x71,0x75,0x69,0x72,0x65,0x64,0x20,0x54,0x75,0x72,0x6e,0x69,0x6e,0x67,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x73,0x65,0x6c,0x65,0x63,0x74,0x20,0x69,0x64,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x30,0x3e,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x31,0x3e,0x43,0x6f,0x75,0x6e,0x74,0x65,0x72,0x20,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x32,0x3e,0x42,0x6f,0x74,0x68,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x2f,0x73,0x65,0x6c,0x65,0x63,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x54,0x68,0x69,0x72,0x64,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x61,0x6c,0x69,0x67,0x6e,0x3d,0x63,0x65,0x6e,0x74,0x65,0x72,0x3e,0x0a,0x3c,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x64,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x65,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x31,0x2e,0x31,0x2f,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x63,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x63,0x72,0x65,0x61,0x74,0x69,0x76,0x65,0x63,0x6f,0x6d,0x6d,0x6f,0x6e,0x73,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x72,0x64,0x66,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x31,0x39,0x39,0x39,0x2f,0x30,0x32,0x2f,0x32,0x32,0x2d,0x72,0x64,0x66,0x2d,0x73,0x79,0x6e,0x74,0x61,0x78,0x2d,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x76,0x67,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2e,0x73,0x6f,0x75,0x72,0x63,0x65,0x66,0x6f,0x72,0x67,0x65,0x2e,0x6e,0x65,0x74,0x2f,0x44,0x54,0x44,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2d,0x30,0x2e,0x64,0x74,0x64,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x73,0x2f,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x20,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x30,0x30,0x20,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x30,0x30,0x20,0x76,0x69,0x65,0x77,0x42,0x6f,0x78,0x3d,0x22,0x30,0x20,0x30,0x20,0x35,0x32,0x2e,0x39,0x31,0x36,0x36,0x36,0x35,0x20,0x32,0x36,0x2e,0x34,0x35,0x38,0x33,0x33,0x34,0x22,0x20,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x31,0x2e,0x31,0x20,0x69,0x64,0x3d,0x73,0x76,0x67,0x31,0x34,0x39,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x22,0x30,0x2e,0x39,0x32,0x2e,0x32,0x20,0x28,0x35,0x63,0x33,0x65,0x38,0x30,0x64,0x2c,0x20,0x32,0x30,0x31,0x37,0x2d,0x30,0x38,0x2d,0x30,0x36,0x29,0x22,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x64,0x6f,0x63,0x6e,0x61,0x6d,0x65,0x3d,0x49,0x63,0x6f,0x6e,0x5f,0x57,0x61,0x74,0x63,0x68,0x77,0x69,0x6e,0x64,0x65,0x72,0x5f,0x74,0x68,0x69,0x72,0x64,0x2e,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x64,0x65,0x66,0x73,0x20,0x69,0x64,0x3d,0x64,0x65,0x66,0x73,0x31,0x34,0x39,0x30,0x20,0x2f,0x3e,0x0a,0x3c,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x6e,0x61,0x6d,0x65,0x64,0x76,0x69,0x65,0x77,0x20,0x69,0x64,0x3d,0x62,0x61,0x73,0x65,0x20,0x70,0x61,0x67,0x65,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x66,0x66,0x66,0x66,0x66,0x66,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x36,0x36,0x36,0x36,0x36,0x36,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x31,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x30,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x73,0x68,0x61,0x64,0x6f,0x77,0x3d,0x32,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x7a,0x6f,0x6f,0x6d,0x3d,0x35,0x2e,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x78,0x3d,0x34,0x39,0x2e,0x34,0x35,0x30,0x34,0x35,0x34,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x79,0x3d,0x32,0x37,0x2e,0x30,0x32,0x38,0x35,0x31,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2d,0x75,0x6e,0x69,0x74,0x73,0x3d,0x6d,0x6d,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x75,0x72,0x72,0x65,0x6e,0x74,0x2d,0x6c,0x61,0x79,0x65,0x72,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x73,0x68,0x6f,0x77,0x67,0x72,0x69,0x64,0x3d,0x66,0x61,0x6c,0x73,0x65,0x20,0x75,0x6e,0x69,0x74,0x73,0x3d,0x70,0x78,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x37,0x33,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x36,0x39,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x78,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x79,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x6d,0x61,0x78,0x69,0x6d,0x69,0x7a,0x65,0x64,0x3d,0x31,0x20,0x2f,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x20,0x69,0x64,0x3d,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x31,0x34,0x39,0x33,0x3e,0x0a,0x3c,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x20,0x72,0x64,0x66,0x3a,0x61,0x62,0x6f,0x75,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x69,0x6d,0x61,0x67,0x65,0x2f,0x73,0x76,0x67,0x2b,0x78,0x6d,0x6c,0x3c,0x2f,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x79,0x70,0x65,0x20,0x72,0x64,0x66,0x3a,0x72,0x65,0x73,0x6f,0x75,0x72,0x63,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x64,0x63,0x6d,0x69,0x74,0x79,0x70,0x65,0x2f,0x53,0x74,0x69,0x6c,0x6c,0x49,0x6d,0x61,0x67,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x69,0x74,0x6c,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x3e,0x0a,0x3c,0x2f,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x2f,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x3e,0x0a,0x3c,0x67,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x6c,0x61,0x62,0x65,0x6c,0x3d,0x22,0x45,0x62,0x65,0x6e,0x65,0x20,0x31,0x22,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x67,0x72,0x6f,0x75,0x70,0x6d,0x6f,0x64,0x65,0x3d,0x6c,0x61,0x79,0x65,0x72,0x20,0x69,0x64,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x74,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x3d,0x74,0x72,0x61,0x6e,0x73,0x6c,0x61,0x74,0x65,0x28,0x30,0x2c,0x2d,0x32,0x37,0x30,0x2e,0x35,0x34,0x31,0x36,0x35,0x29,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x37,0x20,0x63,0x78,0x3d,0x35,0x2e,0x33,0x39,0x33,0x32,0x35,0x34,0x38,0x20,0x63,0x79,0x3d,0x32,0x38,0x37,0x2e,0x32,0x30,0x38,0x30,0x34,0x20,0x72,0x3d,0x32,0x2e,0x33,0x38,0x33,0x39,0x34,0x31,0x32,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x2d,0x37,0x20,0x63,0x78,0x3d,0x31,0x34,0x2e,0x30,0x38,0x37,0x34,0x35,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x65,0x78,0x74,0x20,0x78,0x6d,0x6c,0x3a,0x73,0x70,0x61,0x63,0x65,0x3d,0x70,0x72,0x65,0x73,0x65,0x72,0x76,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x69,0x7a,0x65,0x3a,0x31,0x30,0x2e,0x35,0x38,0x33,0x33,0x33,0x33,0x30,0x32,0x70,0x78,0x3b,0x6c,0x69,0x6e,0x65,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3a,0x31,0x2e,0x32,0x35,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x73,0x61,0x6e,0x73,0x2d,0x73,0x65,0x72,0x69,0x66,0x3b,0x6c,0x65,0x74,0x74,0x65,0x72,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x77,0x6f,0x72,0x64,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x20,0x78,0x3d,0x33,0x39,0x2e,0x36,0x34,0x30,0x32,0x37,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x69,0x64,0x3d,0x74,0x65,0x78,0x74,0x32,0x31,0x36,0x36,0x3e,0x3c,0x74,0x73,0x70,0x61,0x6e,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x72,0x6f,0x6c,0x65,0x3d,0x6c,0x69,0x6e,0x65,0x20,0x69,0x64,0x3d,0x74,0x73,0x70,0x61,0x6e,0x32,0x31,0x36,0x34,0x20,0x78,0x3d,0x33,0x39,0x2e,0x36,0x34,0x30,0x32,0x37,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x76,0x61,0x72,0x69,0x61,0x6e,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x72,0x65,0x74,0x63,0x68,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x2d,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x70,0x65,0x63,0x69,0x66,0x69,0x63,0x61,0x74,0x69,0x6f,0x6e,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x3e,0x33,0x3c,0x2f,0x74,0x73,0x70,0x61,0x6e,0x3e,0x3c,0x2f,0x74,0x65,0x78,0x74,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x20,0x63,0x78,0x3d,0x32,0x38,0x2e,0x33,0x37,0x34,0x39,0x36,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x20,0x63,0x78,0x3d,0x34,0x32,0x2e,0x36,0x36,0x32,0x34,0x37,0x39,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x67,0x3e,0x0a,0x3c,0x2f,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x61,0x6d,0x65,0x20,0x6f,0x66,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3e,0x20,0x28,0x65,0x2e,0x67,0x2e,0x20,0x42,0x72,0x61,0x6e,0x64,0x20,0x6f,0x72,0x20,0x4d,0x6f,0x64,0x65,0x6c,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x75,0x6d,0x62,0x65,0x72,0x20,0x6f,0x66,0x20,0x54,0x75,0x72,0x6e,0x73,0x20,0x70,0x65,0x72,0x20,0x44,0x61,0x79,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x6d,0x69,0x6e,0x3d,0x30,0x20,0x6d,0x61,0x78,0x3d,0x31,0x34,0x34,0x30,0x3e,0x20,0x52,0x65,0x76,0x6f,0x6c,0x75,0x74,0x69,0x6f,0x6e,0x73,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x52,0x65,0x71,0x75,0x69,0x72,0x65,0x64,0x20,0x54,0x75,0x72,0x6e,0x69,0x6e,0x67,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x73,0x65,0x6c,0x65,0x63,0x74,0x20,0x69,0x64,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x30,0x3e,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x31,0x3e,0x43,0x6f,0x75,0x6e,0x74,0x65,0x72,0x20,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x32,0x3e,0x42,0x6f,0x74,0x68,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x2f,0x73,0x65,0x6c,0x65,0x63,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x65,0x64,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x72,0x65,0x73,0x65,0x74,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x28,0x29,0x3e,0x72,0x65,0x73,0x65,0x74,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x22,0x62,0x75,0x74,0x74,0x6f,0x6e,0x2d,0x70,0x72,0x69,0x6d,0x61,0x72,0x79,0x20,0x72,0x69,0x67,0x68,0x74,0x22,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x73,0x61,0x76,0x65,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x28,0x29,0x3e,0x73,0x61,0x76,0x65,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6c,0x65,0x61,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x70,0x20,0x69,0x64,0x3d,0x73,0x61,0x76,0x65,0x64,0x3e,0x3c,0x2f,0x70,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6c,0x65,0x61,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x63,0x6f,0x70,0x79,0x72,0x69,0x67,0x68,0x74,0x3e,0x0a,0x56,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x30,0x2e,0x33,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x43,0x6f,0x70,0x79,0x72,0x69,0x67,0x68,0x74,0x20,0x28,0x63,0x29,0x20,0x32,0x30,0x31,0x38,0x20,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x20,0x42,0x72,0x79,0x61,0x6e,0x20,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x68,0x74,0x74,0x70,0x73,0x3a,0x2f,0x2f,0x67,0x69,0x74,0x68,0x75,0x62,0x2e,0x63,0x6f,0x6d,0x2f,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x20,0x74,0x61,0x72,0x67,0x65,0x74,0x3d,0x5f,0x62,0x6c,0x61,0x6e,0x6b,0x3e,0x67,0x69,0x74,0x68,0x75,0x62,0x2e,0x63,0x6f,0x6d,0x2f,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x73,0x63,0x72,0x69,0x70,0x74,0x20,0x73,0x72,0x63,0x3d,0x6a,0x73,0x2f,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x2e,0x6a,0x73,0x3e,0x3c,0x2f,0x73,0x63,0x72,0x69,0x70,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x62,0x6f,0x64,0x79,0x3e,0x0a,0x3c,0x2f,0x68,0x74,0x6d,0x6c,0x3e
+0x3c,0x21,0x44,0x6f,0x63,0x74,0x79,0x70,0x65,0x20,0x68,0x74,0x6d,0x6c,0x3e,0x0a,0x3c,0x68,0x74,0x6d,0x6c,0x3e,0x0a,0x3c,0x68,0x65,0x61,0x64,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x63,0x68,0x61,0x72,0x73,0x65,0x74,0x3d,0x75,0x74,0x66,0x2d,0x38,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x76,0x69,0x65,0x77,0x70,0x6f,0x72,0x74,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x77,0x69,0x64,0x74,0x68,0x3d,0x64,0x65,0x76,0x69,0x63,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x2c,0x20,0x69,0x6e,0x69,0x74,0x69,0x61,0x6c,0x2d,0x73,0x63,0x61,0x6c,0x65,0x3d,0x30,0x2e,0x38,0x2c,0x20,0x6d,0x69,0x6e,0x69,0x6d,0x61,0x6c,0x2d,0x75,0x69,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x64,0x65,0x73,0x63,0x72,0x69,0x70,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x45,0x53,0x50,0x38,0x32,0x36,0x36,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x61,0x75,0x74,0x68,0x6f,0x72,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x20,0x42,0x72,0x79,0x61,0x6e,0x20,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x74,0x68,0x65,0x6d,0x65,0x2d,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x23,0x33,0x36,0x33,0x39,0x33,0x45,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x69,0x74,0x6c,0x65,0x3e,0x45,0x53,0x50,0x38,0x32,0x36,0x36,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x3c,0x2f,0x74,0x69,0x74,0x6c,0x65,0x3e,0x0a,0x3c,0x6c,0x69,0x6e,0x6b,0x20,0x72,0x65,0x6c,0x3d,0x73,0x74,0x79,0x6c,0x65,0x73,0x68,0x65,0x65,0x74,0x20,0x68,0x72,0x65,0x66,0x3d,0x73,0x74,0x79,0x6c,0x65,0x2e,0x63,0x73,0x73,0x3e,0x0a,0x3c,0x73,0x63,0x72,0x69,0x70,0x74,0x20,0x73,0x72,0x63,0x3d,0x6a,0x73,0x2f,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x73,0x2e,0x6a,0x73,0x3e,0x3c,0x2f,0x73,0x63,0x72,0x69,0x70,0x74,0x3e,0x0a,0x3c,0x2f,0x68,0x65,0x61,0x64,0x3e,0x0a,0x3c,0x62,0x6f,0x64,0x79,0x3e,0x0a,0x3c,0x6e,0x61,0x76,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x57,0x61,0x74,0x63,0x68,0x65,0x73,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x53,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x61,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x69,0x67,0x68,0x74,0x20,0x68,0x72,0x65,0x66,0x3d,0x69,0x6e,0x66,0x6f,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x49,0x6e,0x66,0x6f,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x2f,0x6e,0x61,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x61,0x6c,0x69,0x67,0x6e,0x3d,0x63,0x65,0x6e,0x74,0x65,0x72,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6e,0x74,0x61,0x69,0x6e,0x65,0x72,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x65,0x72,0x72,0x6f,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x68,0x69,0x64,0x65,0x3e,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x68,0x31,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x68,0x65,0x61,0x64,0x65,0x72,0x3e,0x57,0x61,0x74,0x63,0x68,0x65,0x73,0x3c,0x2f,0x68,0x31,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x46,0x69,0x72,0x73,0x74,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x61,0x6c,0x69,0x67,0x6e,0x3d,0x63,0x65,0x6e,0x74,0x65,0x72,0x3e,0x0a,0x3c,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x64,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x65,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x31,0x2e,0x31,0x2f,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x63,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x63,0x72,0x65,0x61,0x74,0x69,0x76,0x65,0x63,0x6f,0x6d,0x6d,0x6f,0x6e,0x73,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x72,0x64,0x66,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x31,0x39,0x39,0x39,0x2f,0x30,0x32,0x2f,0x32,0x32,0x2d,0x72,0x64,0x66,0x2d,0x73,0x79,0x6e,0x74,0x61,0x78,0x2d,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x76,0x67,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2e,0x73,0x6f,0x75,0x72,0x63,0x65,0x66,0x6f,0x72,0x67,0x65,0x2e,0x6e,0x65,0x74,0x2f,0x44,0x54,0x44,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2d,0x30,0x2e,0x64,0x74,0x64,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x73,0x2f,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x20,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x30,0x30,0x20,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x30,0x30,0x20,0x76,0x69,0x65,0x77,0x42,0x6f,0x78,0x3d,0x22,0x30,0x20,0x30,0x20,0x35,0x32,0x2e,0x39,0x31,0x36,0x36,0x36,0x35,0x20,0x32,0x36,0x2e,0x34,0x35,0x38,0x33,0x33,0x34,0x22,0x20,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x31,0x2e,0x31,0x20,0x69,0x64,0x3d,0x73,0x76,0x67,0x31,0x34,0x39,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x22,0x30,0x2e,0x39,0x32,0x2e,0x32,0x20,0x28,0x35,0x63,0x33,0x65,0x38,0x30,0x64,0x2c,0x20,0x32,0x30,0x31,0x37,0x2d,0x30,0x38,0x2d,0x30,0x36,0x29,0x22,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x64,0x6f,0x63,0x6e,0x61,0x6d,0x65,0x3d,0x49,0x63,0x6f,0x6e,0x5f,0x57,0x61,0x74,0x63,0x68,0x77,0x69,0x6e,0x64,0x65,0x72,0x5f,0x66,0x69,0x72,0x73,0x74,0x2e,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x64,0x65,0x66,0x73,0x20,0x69,0x64,0x3d,0x64,0x65,0x66,0x73,0x31,0x34,0x39,0x30,0x20,0x2f,0x3e,0x0a,0x3c,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x6e,0x61,0x6d,0x65,0x64,0x76,0x69,0x65,0x77,0x20,0x69,0x64,0x3d,0x62,0x61,0x73,0x65,0x20,0x70,0x61,0x67,0x65,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x66,0x66,0x66,0x66,0x66,0x66,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x36,0x36,0x36,0x36,0x36,0x36,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x31,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x30,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x73,0x68,0x61,0x64,0x6f,0x77,0x3d,0x32,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x7a,0x6f,0x6f,0x6d,0x3d,0x35,0x2e,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x78,0x3d,0x37,0x38,0x2e,0x35,0x32,0x39,0x38,0x36,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x79,0x3d,0x33,0x38,0x2e,0x34,0x39,0x30,0x38,0x30,0x38,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2d,0x75,0x6e,0x69,0x74,0x73,0x3d,0x6d,0x6d,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x75,0x72,0x72,0x65,0x6e,0x74,0x2d,0x6c,0x61,0x79,0x65,0x72,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x73,0x68,0x6f,0x77,0x67,0x72,0x69,0x64,0x3d,0x66,0x61,0x6c,0x73,0x65,0x20,0x75,0x6e,0x69,0x74,0x73,0x3d,0x70,0x78,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x37,0x33,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x36,0x39,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x78,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x79,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x6d,0x61,0x78,0x69,0x6d,0x69,0x7a,0x65,0x64,0x3d,0x31,0x20,0x2f,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x20,0x69,0x64,0x3d,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x31,0x34,0x39,0x33,0x3e,0x0a,0x3c,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x20,0x72,0x64,0x66,0x3a,0x61,0x62,0x6f,0x75,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x69,0x6d,0x61,0x67,0x65,0x2f,0x73,0x76,0x67,0x2b,0x78,0x6d,0x6c,0x3c,0x2f,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x79,0x70,0x65,0x20,0x72,0x64,0x66,0x3a,0x72,0x65,0x73,0x6f,0x75,0x72,0x63,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x64,0x63,0x6d,0x69,0x74,0x79,0x70,0x65,0x2f,0x53,0x74,0x69,0x6c,0x6c,0x49,0x6d,0x61,0x67,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x69,0x74,0x6c,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x3e,0x0a,0x3c,0x2f,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x2f,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x3e,0x0a,0x3c,0x67,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x6c,0x61,0x62,0x65,0x6c,0x3d,0x22,0x45,0x62,0x65,0x6e,0x65,0x20,0x31,0x22,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x67,0x72,0x6f,0x75,0x70,0x6d,0x6f,0x64,0x65,0x3d,0x6c,0x61,0x79,0x65,0x72,0x20,0x69,0x64,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x74,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x3d,0x74,0x72,0x61,0x6e,0x73,0x6c,0x61,0x74,0x65,0x28,0x30,0x2c,0x2d,0x32,0x37,0x30,0x2e,0x35,0x34,0x31,0x36,0x35,0x29,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x20,0x63,0x78,0x3d,0x34,0x32,0x2e,0x36,0x36,0x32,0x34,0x37,0x39,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x37,0x20,0x63,0x78,0x3d,0x35,0x2e,0x33,0x39,0x33,0x32,0x35,0x34,0x38,0x20,0x63,0x79,0x3d,0x32,0x38,0x37,0x2e,0x32,0x30,0x38,0x30,0x34,0x20,0x72,0x3d,0x32,0x2e,0x33,0x38,0x33,0x39,0x34,0x31,0x32,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x20,0x63,0x78,0x3d,0x32,0x38,0x2e,0x33,0x37,0x34,0x39,0x36,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x2d,0x37,0x20,0x63,0x78,0x3d,0x31,0x34,0x2e,0x30,0x38,0x37,0x34,0x35,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x65,0x78,0x74,0x20,0x78,0x6d,0x6c,0x3a,0x73,0x70,0x61,0x63,0x65,0x3d,0x70,0x72,0x65,0x73,0x65,0x72,0x76,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x69,0x7a,0x65,0x3a,0x31,0x30,0x2e,0x35,0x38,0x33,0x33,0x33,0x33,0x30,0x32,0x70,0x78,0x3b,0x6c,0x69,0x6e,0x65,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3a,0x31,0x2e,0x32,0x35,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x73,0x61,0x6e,0x73,0x2d,0x73,0x65,0x72,0x69,0x66,0x3b,0x6c,0x65,0x74,0x74,0x65,0x72,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x77,0x6f,0x72,0x64,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x20,0x78,0x3d,0x31,0x31,0x2e,0x30,0x36,0x35,0x32,0x35,0x32,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x69,0x64,0x3d,0x74,0x65,0x78,0x74,0x32,0x31,0x36,0x36,0x3e,0x3c,0x74,0x73,0x70,0x61,0x6e,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x72,0x6f,0x6c,0x65,0x3d,0x6c,0x69,0x6e,0x65,0x20,0x69,0x64,0x3d,0x74,0x73,0x70,0x61,0x6e,0x32,0x31,0x36,0x34,0x20,0x78,0x3d,0x31,0x31,0x2e,0x30,0x36,0x35,0x32,0x35,0x32,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x76,0x61,0x72,0x69,0x61,0x6e,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x72,0x65,0x74,0x63,0x68,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x2d,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x70,0x65,0x63,0x69,0x66,0x69,0x63,0x61,0x74,0x69,0x6f,0x6e,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x3e,0x31,0x3c,0x2f,0x74,0x73,0x70,0x61,0x6e,0x3e,0x3c,0x2f,0x74,0x65,0x78,0x74,0x3e,0x0a,0x3c,0x2f,0x67,0x3e,0x0a,0x3c,0x2f,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x61,0x6d,0x65,0x20,0x6f,0x66,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x2f,0x3e,0x20,0x28,0x65,0x2e,0x67,0x2e,0x20,0x42,0x72,0x61,0x6e,0x64,0x20,0x6f,0x72,0x20,0x4d,0x6f,0x64,0x65,0x6c,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x43,0x61,0x6c,0x69,0x62,0x65,0x72,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x20,0x6c,0x69,0x73,0x74,0x3d,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x20,0x6f,0x6e,0x69,0x6e,0x70,0x75,0x74,0x3d,0x66,0x69,0x6e,0x64,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x28,0x74,0x68,0x69,0x73,0x29,0x20,0x2f,0x3e,0x20,0x28,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x61,0x6c,0x2c,0x20,0x66,0x69,0x6c,0x6c,0x73,0x20,0x69,0x6e,0x20,0x74,0x75,0x72,0x6e,0x73,0x20,0x61,0x6e,0x64,0x20,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x75,0x6d,0x62,0x65,0x72,0x20,0x6f,0x66,0x20,0x54,0x75,0x72,0x6e,0x73,0x20,0x70,0x65,0x72,0x20,0x44,0x61,0x79,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x6d,0x69,0x6e,0x3d,0x30,0x20,0x6d,0x61,0x78,0x3d,0x31,0x34,0x34,0x30,0x20,0x2f,0x3e,0x20,0x52,0x65,0x76,0x6f,0x6c,0x75,0x74,0x69,0x6f,0x6e,0x73,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x52,0x65,0x71,0x75,0x69,0x72,0x65,0x64,0x20,0x54,0x75,0x72,0x6e,0x69,0x6e,0x67,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x73,0x65,0x6c,0x65,0x63,0x74,0x20,0x69,0x64,0x3d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x30,0x3e,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x31,0x3e,0x43,0x6f,0x75,0x6e,0x74,0x65,0x72,0x20,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x32,0x3e,0x42,0x6f,0x74,0x68,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x2f,0x73,0x65,0x6c,0x65,0x63,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x53,0x65,0x63,0x6f,0x6e,0x64,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x61,0x6c,0x69,0x67,0x6e,0x3d,0x63,0x65,0x6e,0x74,0x65,0x72,0x3e,0x0a,0x3c,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x64,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x65,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x31,0x2e,0x31,0x2f,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x63,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x63,0x72,0x65,0x61,0x74,0x69,0x76,0x65,0x63,0x6f,0x6d,0x6d,0x6f,0x6e,0x73,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x72,0x64,0x66,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x31,0x39,0x39,0x39,0x2f,0x30,0x32,0x2f,0x32,0x32,0x2d,0x72,0x64,0x66,0x2d,0x73,0x79,0x6e,0x74,0x61,0x78,0x2d,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x76,0x67,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2e,0x73,0x6f,0x75,0x72,0x63,0x65,0x66,0x6f,0x72,0x67,0x65,0x2e,0x6e,0x65,0x74,0x2f,0x44,0x54,0x44,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2d,0x30,0x2e,0x64,0x74,0x64,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x73,0x2f,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x20,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x30,0x30,0x20,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x30,0x30,0x20,0x76,0x69,0x65,0x77,0x42,0x6f,0x78,0x3d,0x22,0x30,0x20,0x30,0x20,0x35,0x32,0x2e,0x39,0x31,0x36,0x36,0x36,0x35,0x20,0x32,0x36,0x2e,0x34,0x35,0x38,0x33,0x33,0x34,0x22,0x20,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x31,0x2e,0x31,0x20,0x69,0x64,0x3d,0x73,0x76,0x67,0x31,0x34,0x39,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x22,0x30,0x2e,0x39,0x32,0x2e,0x32,0x20,0x28,0x35,0x63,0x33,0x65,0x38,0x30,0x64,0x2c,0x20,0x32,0x30,0x31,0x37,0x2d,0x30,0x38,0x2d,0x30,0x36,0x29,0x22,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x64,0x6f,0x63,0x6e,0x61,0x6d,0x65,0x3d,0x49,0x63,0x6f,0x6e,0x5f,0x57,0x61,0x74,0x63,0x68,0x77,0x69,0x6e,0x64,0x65,0x72,0x5f,0x73,0x65,0x63,0x6f,0x6e,0x64,0x2e,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x64,0x65,0x66,0x73,0x20,0x69,0x64,0x3d,0x64,0x65,0x66,0x73,0x31,0x34,0x39,0x30,0x20,0x2f,0x3e,0x0a,0x3c,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x6e,0x61,0x6d,0x65,0x64,0x76,0x69,0x65,0x77,0x20,0x69,0x64,0x3d,0x62,0x61,0x73,0x65,0x20,0x70,0x61,0x67,0x65,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x66,0x66,0x66,0x66,0x66,0x66,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x36,0x36,0x36,0x36,0x36,0x36,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x31,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x30,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x73,0x68,0x61,0x64,0x6f,0x77,0x3d,0x32,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x7a,0x6f,0x6f,0x6d,0x3d,0x35,0x2e,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x78,0x3d,0x34,0x39,0x2e,0x34,0x35,0x30,0x34,0x35,0x34,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x79,0x3d,0x32,0x37,0x2e,0x30,0x32,0x38,0x35,0x31,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2d,0x75,0x6e,0x69,0x74,0x73,0x3d,0x6d,0x6d,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x75,0x72,0x72,0x65,0x6e,0x74,0x2d,0x6c,0x61,0x79,0x65,0x72,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x73,0x68,0x6f,0x77,0x67,0x72,0x69,0x64,0x3d,0x66,0x61,0x6c,0x73,0x65,0x20,0x75,0x6e,0x69,0x74,0x73,0x3d,0x70,0x78,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x37,0x33,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x36,0x39,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x78,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x79,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x6d,0x61,0x78,0x69,0x6d,0x69,0x7a,0x65,0x64,0x3d,0x31,0x20,0x2f,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x20,0x69,0x64,0x3d,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x31,0x34,0x39,0x33,0x3e,0x0a,0x3c,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x20,0x72,0x64,0x66,0x3a,0x61,0x62,0x6f,0x75,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x69,0x6d,0x61,0x67,0x65,0x2f,0x73,0x76,0x67,0x2b,0x78,0x6d,0x6c,0x3c,0x2f,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x79,0x70,0x65,0x20,0x72,0x64,0x66,0x3a,0x72,0x65,0x73,0x6f,0x75,0x72,0x63,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x64,0x63,0x6d,0x69,0x74,0x79,0x70,0x65,0x2f,0x53,0x74,0x69,0x6c,0x6c,0x49,0x6d,0x61,0x67,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x69,0x74,0x6c,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x3e,0x0a,0x3c,0x2f,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x2f,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x3e,0x0a,0x3c,0x67,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x6c,0x61,0x62,0x65,0x6c,0x3d,0x22,0x45,0x62,0x65,0x6e,0x65,0x20,0x31,0x22,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x67,0x72,0x6f,0x75,0x70,0x6d,0x6f,0x64,0x65,0x3d,0x6c,0x61,0x79,0x65,0x72,0x20,0x69,0x64,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x74,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x3d,0x74,0x72,0x61,0x6e,0x73,0x6c,0x61,0x74,0x65,0x28,0x30,0x2c,0x2d,0x32,0x37,0x30,0x2e,0x35,0x34,0x31,0x36,0x35,0x29,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x20,0x63,0x78,0x3d,0x34,0x32,0x2e,0x36,0x36,0x32,0x34,0x37,0x39,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x37,0x20,0x63,0x78,0x3d,0x35,0x2e,0x33,0x39,0x33,0x32,0x35,0x34,0x38,0x20,0x63,0x79,0x3d,0x32,0x38,0x37,0x2e,0x32,0x30,0x38,0x30,0x34,0x20,0x72,0x3d,0x32,0x2e,0x33,0x38,0x33,0x39,0x34,0x31,0x32,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x2d,0x37,0x20,0x63,0x78,0x3d,0x31,0x34,0x2e,0x30,0x38,0x37,0x34,0x35,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x65,0x78,0x74,0x20,0x78,0x6d,0x6c,0x3a,0x73,0x70,0x61,0x63,0x65,0x3d,0x70,0x72,0x65,0x73,0x65,0x72,0x76,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x69,0x7a,0x65,0x3a,0x31,0x30,0x2e,0x35,0x38,0x33,0x33,0x33,0x33,0x30,0x32,0x70,0x78,0x3b,0x6c,0x69,0x6e,0x65,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3a,0x31,0x2e,0x32,0x35,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x73,0x61,0x6e,0x73,0x2d,0x73,0x65,0x72,0x69,0x66,0x3b,0x6c,0x65,0x74,0x74,0x65,0x72,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x77,0x6f,0x72,0x64,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x20,0x78,0x3d,0x32,0x35,0x2e,0x33,0x35,0x32,0x37,0x35,0x37,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x69,0x64,0x3d,0x74,0x65,0x78,0x74,0x32,0x31,0x36,0x36,0x3e,0x3c,0x74,0x73,0x70,0x61,0x6e,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x72,0x6f,0x6c,0x65,0x3d,0x6c,0x69,0x6e,0x65,0x20,0x69,0x64,0x3d,0x74,0x73,0x70,0x61,0x6e,0x32,0x31,0x36,0x34,0x20,0x78,0x3d,0x32,0x35,0x2e,0x33,0x35,0x32,0x37,0x35,0x37,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x76,0x61,0x72,0x69,0x61,0x6e,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x72,0x65,0x74,0x63,0x68,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x2d,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x70,0x65,0x63,0x69,0x66,0x69,0x63,0x61,0x74,0x69,0x6f,0x6e,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x3e,0x32,0x3c,0x2f,0x74,0x73,0x70,0x61,0x6e,0x3e,0x3c,0x2f,0x74,0x65,0x78,0x74,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x20,0x63,0x78,0x3d,0x32,0x38,0x2e,0x33,0x37,0x34,0x39,0x36,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x67,0x3e,0x0a,0x3c,0x2f,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x61,0x6d,0x65,0x20,0x6f,0x66,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x2f,0x3e,0x20,0x28,0x65,0x2e,0x67,0x2e,0x20,0x42,0x72,0x61,0x6e,0x64,0x20,0x6f,0x72,0x20,0x4d,0x6f,0x64,0x65,0x6c,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x43,0x61,0x6c,0x69,0x62,0x65,0x72,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x20,0x6c,0x69,0x73,0x74,0x3d,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x20,0x6f,0x6e,0x69,0x6e,0x70,0x75,0x74,0x3d,0x66,0x69,0x6e,0x64,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x28,0x74,0x68,0x69,0x73,0x29,0x20,0x2f,0x3e,0x20,0x28,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x61,0x6c,0x2c,0x20,0x66,0x69,0x6c,0x6c,0x73,0x20,0x69,0x6e,0x20,0x74,0x75,0x72,0x6e,0x73,0x20,0x61,0x6e,0x64,0x20,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x75,0x6d,0x62,0x65,0x72,0x20,0x6f,0x66,0x20,0x54,0x75,0x72,0x6e,0x73,0x20,0x70,0x65,0x72,0x20,0x44,0x61,0x79,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x6d,0x69,0x6e,0x3d,0x30,0x20,0x6d,0x61,0x78,0x3d,0x31,0x34,0x34,0x30,0x3e,0x20,0x52,0x65,0x76,0x6f,0x6c,0x75,0x74,0x69,0x6f,0x6e,0x73,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x52,0x65,0x71,0x75,0x69,0x72,0x65,0x64,0x20,0x54,0x75,0x72,0x6e,0x69,0x6e,0x67,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x73,0x65,0x6c,0x65,0x63,0x74,0x20,0x69,0x64,0x3d,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x30,0x3e,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x31,0x3e,0x43,0x6f,0x75,0x6e,0x74,0x65,0x72,0x20,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x32,0x3e,0x42,0x6f,0x74,0x68,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x2f,0x73,0x65,0x6c,0x65,0x63,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x54,0x68,0x69,0x72,0x64,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x61,0x6c,0x69,0x67,0x6e,0x3d,0x63,0x65,0x6e,0x74,0x65,0x72,0x3e,0x0a,0x3c,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x64,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x65,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x31,0x2e,0x31,0x2f,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x63,0x63,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x63,0x72,0x65,0x61,0x74,0x69,0x76,0x65,0x63,0x6f,0x6d,0x6d,0x6f,0x6e,0x73,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x72,0x64,0x66,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x31,0x39,0x39,0x39,0x2f,0x30,0x32,0x2f,0x32,0x32,0x2d,0x72,0x64,0x66,0x2d,0x73,0x79,0x6e,0x74,0x61,0x78,0x2d,0x6e,0x73,0x23,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x76,0x67,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2e,0x73,0x6f,0x75,0x72,0x63,0x65,0x66,0x6f,0x72,0x67,0x65,0x2e,0x6e,0x65,0x74,0x2f,0x44,0x54,0x44,0x2f,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x2d,0x30,0x2e,0x64,0x74,0x64,0x20,0x78,0x6d,0x6c,0x6e,0x73,0x3a,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2e,0x6f,0x72,0x67,0x2f,0x6e,0x61,0x6d,0x65,0x73,0x70,0x61,0x63,0x65,0x73,0x2f,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x20,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x30,0x30,0x20,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x30,0x30,0x20,0x76,0x69,0x65,0x77,0x42,0x6f,0x78,0x3d,0x22,0x30,0x20,0x30,0x20,0x35,0x32,0x2e,0x39,0x31,0x36,0x36,0x36,0x35,0x20,0x32,0x36,0x2e,0x34,0x35,0x38,0x33,0x33,0x34,0x22,0x20,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x31,0x2e,0x31,0x20,0x69,0x64,0x3d,0x73,0x76,0x67,0x31,0x34,0x39,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x22,0x30,0x2e,0x39,0x32,0x2e,0x32,0x20,0x28,0x35,0x63,0x33,0x65,0x38,0x30,0x64,0x2c,0x20,0x32,0x30,0x31,0x37,0x2d,0x30,0x38,0x2d,0x30,0x36,0x29,0x22,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x64,0x6f,0x63,0x6e,0x61,0x6d,0x65,0x3d,0x49,0x63,0x6f,0x6e,0x5f,0x57,0x61,0x74,0x63,0x68,0x77,0x69,0x6e,0x64,0x65,0x72,0x5f,0x74,0x68,0x69,0x72,0x64,0x2e,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x64,0x65,0x66,0x73,0x20,0x69,0x64,0x3d,0x64,0x65,0x66,0x73,0x31,0x34,0x39,0x30,0x20,0x2f,0x3e,0x0a,0x3c,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x6e,0x61,0x6d,0x65,0x64,0x76,0x69,0x65,0x77,0x20,0x69,0x64,0x3d,0x62,0x61,0x73,0x65,0x20,0x70,0x61,0x67,0x65,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x66,0x66,0x66,0x66,0x66,0x66,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x63,0x6f,0x6c,0x6f,0x72,0x3d,0x23,0x36,0x36,0x36,0x36,0x36,0x36,0x20,0x62,0x6f,0x72,0x64,0x65,0x72,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x31,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3d,0x30,0x2e,0x30,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x70,0x61,0x67,0x65,0x73,0x68,0x61,0x64,0x6f,0x77,0x3d,0x32,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x7a,0x6f,0x6f,0x6d,0x3d,0x35,0x2e,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x78,0x3d,0x34,0x39,0x2e,0x34,0x35,0x30,0x34,0x35,0x34,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x79,0x3d,0x32,0x37,0x2e,0x30,0x32,0x38,0x35,0x31,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2d,0x75,0x6e,0x69,0x74,0x73,0x3d,0x6d,0x6d,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x63,0x75,0x72,0x72,0x65,0x6e,0x74,0x2d,0x6c,0x61,0x79,0x65,0x72,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x73,0x68,0x6f,0x77,0x67,0x72,0x69,0x64,0x3d,0x66,0x61,0x6c,0x73,0x65,0x20,0x75,0x6e,0x69,0x74,0x73,0x3d,0x70,0x78,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x77,0x69,0x64,0x74,0x68,0x3d,0x32,0x37,0x33,0x36,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3d,0x31,0x36,0x39,0x39,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x78,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x79,0x3d,0x2d,0x31,0x33,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x77,0x69,0x6e,0x64,0x6f,0x77,0x2d,0x6d,0x61,0x78,0x69,0x6d,0x69,0x7a,0x65,0x64,0x3d,0x31,0x20,0x2f,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x20,0x69,0x64,0x3d,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x31,0x34,0x39,0x33,0x3e,0x0a,0x3c,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x20,0x72,0x64,0x66,0x3a,0x61,0x62,0x6f,0x75,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x69,0x6d,0x61,0x67,0x65,0x2f,0x73,0x76,0x67,0x2b,0x78,0x6d,0x6c,0x3c,0x2f,0x64,0x63,0x3a,0x66,0x6f,0x72,0x6d,0x61,0x74,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x79,0x70,0x65,0x20,0x72,0x64,0x66,0x3a,0x72,0x65,0x73,0x6f,0x75,0x72,0x63,0x65,0x3d,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x70,0x75,0x72,0x6c,0x2e,0x6f,0x72,0x67,0x2f,0x64,0x63,0x2f,0x64,0x63,0x6d,0x69,0x74,0x79,0x70,0x65,0x2f,0x53,0x74,0x69,0x6c,0x6c,0x49,0x6d,0x61,0x67,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x63,0x3a,0x74,0x69,0x74,0x6c,0x65,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x63,0x63,0x3a,0x57,0x6f,0x72,0x6b,0x3e,0x0a,0x3c,0x2f,0x72,0x64,0x66,0x3a,0x52,0x44,0x46,0x3e,0x0a,0x3c,0x2f,0x6d,0x65,0x74,0x61,0x64,0x61,0x74,0x61,0x3e,0x0a,0x3c,0x67,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x6c,0x61,0x62,0x65,0x6c,0x3d,0x22,0x45,0x62,0x65,0x6e,0x65,0x20,0x31,0x22,0x20,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x3a,0x67,0x72,0x6f,0x75,0x70,0x6d,0x6f,0x64,0x65,0x3d,0x6c,0x61,0x79,0x65,0x72,0x20,0x69,0x64,0x3d,0x6c,0x61,0x79,0x65,0x72,0x31,0x20,0x74,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x3d,0x74,0x72,0x61,0x6e,0x73,0x6c,0x61,0x74,0x65,0x28,0x30,0x2c,0x2d,0x32,0x37,0x30,0x2e,0x35,0x34,0x31,0x36,0x35,0x29,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x37,0x20,0x63,0x78,0x3d,0x35,0x2e,0x33,0x39,0x33,0x32,0x35,0x34,0x38,0x20,0x63,0x79,0x3d,0x32,0x38,0x37,0x2e,0x32,0x30,0x38,0x30,0x34,0x20,0x72,0x3d,0x32,0x2e,0x33,0x38,0x33,0x39,0x34,0x31,0x32,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x2d,0x37,0x20,0x63,0x78,0x3d,0x31,0x34,0x2e,0x30,0x38,0x37,0x34,0x35,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x65,0x78,0x74,0x20,0x78,0x6d,0x6c,0x3a,0x73,0x70,0x61,0x63,0x65,0x3d,0x70,0x72,0x65,0x73,0x65,0x72,0x76,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x69,0x7a,0x65,0x3a,0x31,0x30,0x2e,0x35,0x38,0x33,0x33,0x33,0x33,0x30,0x32,0x70,0x78,0x3b,0x6c,0x69,0x6e,0x65,0x2d,0x68,0x65,0x69,0x67,0x68,0x74,0x3a,0x31,0x2e,0x32,0x35,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x73,0x61,0x6e,0x73,0x2d,0x73,0x65,0x72,0x69,0x66,0x3b,0x6c,0x65,0x74,0x74,0x65,0x72,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x77,0x6f,0x72,0x64,0x2d,0x73,0x70,0x61,0x63,0x69,0x6e,0x67,0x3a,0x30,0x70,0x78,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x20,0x78,0x3d,0x33,0x39,0x2e,0x36,0x34,0x30,0x32,0x37,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x69,0x64,0x3d,0x74,0x65,0x78,0x74,0x32,0x31,0x36,0x36,0x3e,0x3c,0x74,0x73,0x70,0x61,0x6e,0x20,0x73,0x6f,0x64,0x69,0x70,0x6f,0x64,0x69,0x3a,0x72,0x6f,0x6c,0x65,0x3d,0x6c,0x69,0x6e,0x65,0x20,0x69,0x64,0x3d,0x74,0x73,0x70,0x61,0x6e,0x32,0x31,0x36,0x34,0x20,0x78,0x3d,0x33,0x39,0x2e,0x36,0x34,0x30,0x32,0x37,0x20,0x79,0x3d,0x32,0x38,0x36,0x2e,0x34,0x31,0x36,0x36,0x36,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x79,0x6c,0x65,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x76,0x61,0x72,0x69,0x61,0x6e,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x77,0x65,0x69,0x67,0x68,0x74,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x74,0x72,0x65,0x74,0x63,0x68,0x3a,0x6e,0x6f,0x72,0x6d,0x61,0x6c,0x3b,0x66,0x6f,0x6e,0x74,0x2d,0x66,0x61,0x6d,0x69,0x6c,0x79,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x2d,0x69,0x6e,0x6b,0x73,0x63,0x61,0x70,0x65,0x2d,0x66,0x6f,0x6e,0x74,0x2d,0x73,0x70,0x65,0x63,0x69,0x66,0x69,0x63,0x61,0x74,0x69,0x6f,0x6e,0x3a,0x41,0x72,0x69,0x61,0x6c,0x3b,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x30,0x2e,0x32,0x36,0x34,0x35,0x38,0x33,0x33,0x32,0x3e,0x33,0x3c,0x2f,0x74,0x73,0x70,0x61,0x6e,0x3e,0x3c,0x2f,0x74,0x65,0x78,0x74,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x62,0x66,0x62,0x66,0x62,0x62,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x2d,0x38,0x20,0x63,0x78,0x3d,0x32,0x38,0x2e,0x33,0x37,0x34,0x39,0x36,0x36,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x63,0x69,0x72,0x63,0x6c,0x65,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x66,0x69,0x6c,0x6c,0x3a,0x23,0x34,0x66,0x61,0x64,0x66,0x66,0x3b,0x66,0x69,0x6c,0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x30,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x3a,0x23,0x32,0x66,0x33,0x31,0x33,0x36,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x3a,0x31,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6d,0x69,0x74,0x65,0x72,0x6c,0x69,0x6d,0x69,0x74,0x3a,0x34,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x64,0x61,0x73,0x68,0x61,0x72,0x72,0x61,0x79,0x3a,0x6e,0x6f,0x6e,0x65,0x3b,0x73,0x74,0x72,0x6f,0x6b,0x65,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x20,0x69,0x64,0x3d,0x70,0x61,0x74,0x68,0x32,0x30,0x34,0x31,0x20,0x63,0x78,0x3d,0x34,0x32,0x2e,0x36,0x36,0x32,0x34,0x37,0x39,0x20,0x63,0x79,0x3d,0x32,0x38,0x32,0x2e,0x36,0x38,0x33,0x36,0x35,0x20,0x72,0x3d,0x36,0x2e,0x39,0x30,0x30,0x30,0x32,0x32,0x35,0x20,0x2f,0x3e,0x0a,0x3c,0x2f,0x67,0x3e,0x0a,0x3c,0x2f,0x73,0x76,0x67,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x61,0x6d,0x65,0x20,0x6f,0x66,0x20,0x57,0x61,0x74,0x63,0x68,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3e,0x20,0x28,0x65,0x2e,0x67,0x2e,0x20,0x42,0x72,0x61,0x6e,0x64,0x20,0x6f,0x72,0x20,0x4d,0x6f,0x64,0x65,0x6c,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x43,0x61,0x6c,0x69,0x62,0x65,0x72,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x20,0x6c,0x69,0x73,0x74,0x3d,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x20,0x6f,0x6e,0x69,0x6e,0x70,0x75,0x74,0x3d,0x66,0x69,0x6e,0x64,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x28,0x74,0x68,0x69,0x73,0x29,0x20,0x2f,0x3e,0x20,0x28,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x61,0x6c,0x2c,0x20,0x66,0x69,0x6c,0x6c,0x73,0x20,0x69,0x6e,0x20,0x74,0x75,0x72,0x6e,0x73,0x20,0x61,0x6e,0x64,0x20,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x29,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4e,0x75,0x6d,0x62,0x65,0x72,0x20,0x6f,0x66,0x20,0x54,0x75,0x72,0x6e,0x73,0x20,0x70,0x65,0x72,0x20,0x44,0x61,0x79,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x20,0x6d,0x69,0x6e,0x3d,0x30,0x20,0x6d,0x61,0x78,0x3d,0x31,0x34,0x34,0x30,0x3e,0x20,0x52,0x65,0x76,0x6f,0x6c,0x75,0x74,0x69,0x6f,0x6e,0x73,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x52,0x65,0x71,0x75,0x69,0x72,0x65,0x64,0x20,0x54,0x75,0x72,0x6e,0x69,0x6e,0x67,0x20,0x44,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x73,0x65,0x6c,0x65,0x63,0x74,0x20,0x69,0x64,0x3d,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x30,0x3e,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x31,0x3e,0x43,0x6f,0x75,0x6e,0x74,0x65,0x72,0x20,0x43,0x6c,0x6f,0x63,0x6b,0x77,0x69,0x73,0x65,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x32,0x3e,0x42,0x6f,0x74,0x68,0x3c,0x2f,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x3e,0x0a,0x3c,0x2f,0x73,0x65,0x6c,0x65,0x63,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x65,0x64,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x72,0x65,0x73,0x65,0x74,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x28,0x29,0x3e,0x72,0x65,0x73,0x65,0x74,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x22,0x62,0x75,0x74,0x74,0x6f,0x6e,0x2d,0x70,0x72,0x69,0x6d,0x61,0x72,0x79,0x20,0x72,0x69,0x67,0x68,0x74,0x22,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x73,0x61,0x76,0x65,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x28,0x29,0x3e,0x73,0x61,0x76,0x65,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6c,0x65,0x61,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x70,0x20,0x69,0x64,0x3d,0x73,0x61,0x76,0x65,0x64,0x3e,0x3c,0x2f,0x70,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6c,0x65,0x61,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x63,0x6f,0x70,0x79,0x72,0x69,0x67,0x68,0x74,0x3e,0x0a,0x56,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x30,0x2e,0x33,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x43,0x6f,0x70,0x79,0x72,0x69,0x67,0x68,0x74,0x20,0x28,0x63,0x29,0x20,0x32,0x30,0x31,0x38,0x20,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x20,0x42,0x72,0x79,0x61,0x6e,0x20,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x68,0x74,0x74,0x70,0x73,0x3a,0x2f,0x2f,0x67,0x69,0x74,0x68,0x75,0x62,0x2e,0x63,0x6f,0x6d,0x2f,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x20,0x74,0x61,0x72,0x67,0x65,0x74,0x3d,0x5f,0x62,0x6c,0x61,0x6e,0x6b,0x3e,0x67,0x69,0x74,0x68,0x75,0x62,0x2e,0x63,0x6f,0x6d,0x2f,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x61,0x74,0x61,0x6c,0x69,0x73,0x74,0x20,0x69,0x64,0x3d,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x3e,0x3c,0x2f,0x64,0x61,0x74,0x61,0x6c,0x69,0x73,0x74,0x3e,0x0a,0x3c,0x73,0x63,0x72,0x69,0x70,0x74,0x20,0x73,0x72,0x63,0x3d,0x6a,0x73,0x2f,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x2e,0x6a,0x73,0x3e,0x3c,0x2f,0x73,0x63,0x72,0x69,0x70,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x62,0x6f,0x64,0x79,0x3e,0x0a,0x3c,0x2f,0x68,0x74,0x6d,0x6c,0x3e
 };
 const char data_settingsHTML[] PROGMEM =
 {
-0x3c,0x21,0x44,0x6f,0x63,0x74,0x79,0x70,0x65,0x20,0x68,0x74,0x6d,0x6c,0x3e,0x0a,0x3c,0x68,0x74,0x6d,0x6c,0x3e,0x0a,0x3c,0x68,0x65,0x61,0x64,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x63,0x68,0x61,0x72,0x73,0x65,0x74,0x3d,0x75,0x74,0x66,0x2d,0x38,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x76,0x69,0x65,0x77,0x70,0x6f,0x72,0x74,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x77,0x69,0x64,0x74,0x68,0x3d,0x64,0x65,0x76,0x69,0x63,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x2c,0x20,0x69,0x6e,0x69,0x74,0x69,0x61,0x6c,0x2d,0x73,0x63,0x61,0x6c,0x65,0x3d,0x30,0x2e,0x38,0x2c,0x20,0x6d,0x69,0x6e,0x69,0x6d,0x61,0x6c,0x2d,0x75,0x69,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x64,0x65,0x73,0x63,0x72,0x69,0x70,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x45,0x53,0x50,0x38,0x32,0x36,0x36,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x61,0x75,0x74,0x68,0x6f,0x72,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x20,0x42,0x72,0x79,0x61,0x6e,0x20,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x74,0x68,0x65,0x6d,0x65,0x2d,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x23,0x33,0x36,0x33,0x39,0x33,0x45,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x69,0x74,0x6c,0x65,0x3e,0x45,0x53,0x50,0x38,0x32,0x36,0x36,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x3c,0x2f,0x74,0x69,0x74,0x6c,0x65,0x3e,0x0a,0x3c,0x6c,0x69,0x6e,0x6b,0x20,0x72,0x65,0x6c,0x3d,0x73,0x74,0x79,0x6c,0x65,0x73,0x68,0x65,0x65,0x74,0x20,0x68,0x72,0x65,0x66,0x3d,0x73,0x74,0x79,0x6c,0x65,0x2e,0x63,0x73,0x73,0x3e,0x0a,0x3c,0x73,0x63,0x72,0x69,0x70,0x74,0x20,0x73,0x72,0x63,0x3d,0x6a,0x73,0x2f,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x73,0x2e,0x6a,0x73,0x3e,0x3c,0x2f,0x73,0x63,0x72,0x69,0x70,0x74,0x3e,0x0a,0x3c,0x2f,0x68,0x65,0x61,0x64,0x3e,0x0a,0x3c,0x62,0x6f,0x64,0x79,0x3e,0x0a,0x3c,0x6e,0x61,0x76,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x57,0x61,0x74,0x63,0x68,0x65,0x73,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x53,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x61,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x69,0x67,0x68,0x74,0x20,0x68,0x72,0x65,0x66,0x3d,0x69,0x6e,0x66,0x6f,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x49,0x6e,0x66,0x6f,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x2f,0x6e,0x61,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6e,0x74,0x61,0x69,0x6e,0x65,0x72,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x65,0x72,0x72,0x6f,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x68,0x69,0x64,0x65,0x3e,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x68,0x31,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x68,0x65,0x61,0x64,0x65,0x72,0x3e,0x53,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x3c,0x2f,0x68,0x31,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x54,0x69,0x6d,0x65,0x20,0x5a,0x6f,0x6e,0x65,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x73,0x68,0x69,0x66,0x74,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x52,0x65,0x6c,0x61,0x74,0x69,0x76,0x65,0x20,0x74,0x6f,0x20,0x55,0x54,0x43,0x20,0x28,0x69,0x6e,0x20,0x68,0x6f,0x75,0x72,0x73,0x29,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x73,0x68,0x69,0x66,0x74,0x20,0x6d,0x69,0x6e,0x3d,0x2d,0x31,0x32,0x20,0x6d,0x61,0x78,0x3d,0x31,0x34,0x3e,0x20,0x68,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x41,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x20,0x54,0x69,0x6d,0x65,0x20,0x66,0x6f,0x72,0x20,0x41,0x63,0x74,0x69,0x76,0x65,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x45,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x20,0x53,0x74,0x61,0x72,0x74,0x20,0x28,0x6f,0x6e,0x6c,0x79,0x20,0x66,0x75,0x6c,0x6c,0x20,0x68,0x6f,0x75,0x72,0x73,0x20,0x2d,0x20,0x30,0x20,0x74,0x6f,0x20,0x32,0x34,0x29,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x20,0x6d,0x69,0x6e,0x3d,0x30,0x20,0x6d,0x61,0x78,0x3d,0x32,0x34,0x20,0x6f,0x6e,0x63,0x68,0x61,0x6e,0x67,0x65,0x3d,0x22,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2e,0x67,0x65,0x74,0x45,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x42,0x79,0x49,0x64,0x28,0x27,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x27,0x29,0x2e,0x6d,0x69,0x6e,0x3d,0x74,0x68,0x69,0x73,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x69,0x66,0x28,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2e,0x67,0x65,0x74,0x45,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x42,0x79,0x49,0x64,0x28,0x27,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x27,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3c,0x74,0x68,0x69,0x73,0x2e,0x76,0x61,0x6c,0x75,0x65,0x29,0x7b,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2e,0x67,0x65,0x74,0x45,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x42,0x79,0x49,0x64,0x28,0x27,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x27,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x74,0x68,0x69,0x73,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x7d,0x22,0x3e,0x20,0x68,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x4c,0x61,0x74,0x65,0x73,0x74,0x20,0x53,0x74,0x61,0x72,0x74,0x20,0x28,0x6f,0x6e,0x6c,0x79,0x20,0x66,0x75,0x6c,0x6c,0x20,0x68,0x6f,0x75,0x72,0x73,0x20,0x2d,0x20,0x30,0x20,0x74,0x6f,0x20,0x32,0x34,0x29,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x6e,0x75,0x6d,0x62,0x65,0x72,0x20,0x69,0x64,0x3d,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x20,0x6d,0x69,0x6e,0x3d,0x22,0x64,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x2e,0x67,0x65,0x74,0x45,0x6c,0x65,0x6d,0x65,0x6e,0x74,0x42,0x79,0x49,0x64,0x28,0x27,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x27,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x22,0x20,0x6d,0x61,0x78,0x3d,0x32,0x34,0x3e,0x20,0x68,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x65,0x64,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x72,0x65,0x73,0x65,0x74,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x3e,0x72,0x65,0x73,0x65,0x74,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x22,0x62,0x75,0x74,0x74,0x6f,0x6e,0x2d,0x70,0x72,0x69,0x6d,0x61,0x72,0x79,0x20,0x72,0x69,0x67,0x68,0x74,0x22,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x73,0x61,0x76,0x65,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x3e,0x73,0x61,0x76,0x65,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6c,0x65,0x61,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x70,0x20,0x69,0x64,0x3d,0x73,0x61,0x76,0x65,0x64,0x3e,0x3c,0x2f,0x70,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6c,0x65,0x61,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x63,0x6f,0x70,0x79,0x72,0x69,0x67,0x68,0x74,0x3e,0x0a,0x56,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x30,0x2e,0x33,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x43,0x6f,0x70,0x79,0x72,0x69,0x67,0x68,0x74,0x20,0x28,0x63,0x29,0x20,0x32,0x30,0x31,0x38,0x20,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x20,0x42,0x72,0x79,0x61,0x6e,0x20,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x68,0x74,0x74,0x70,0x73,0x3a,0x2f,0x2f,0x67,0x69,0x74,0x68,0x75,0x62,0x2e,0x63,0x6f,0x6d,0x2f,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x20,0x74,0x61,0x72,0x67,0x65,0x74,0x3d,0x5f,0x62,0x6c,0x61,0x6e,0x6b,0x3e,0x67,0x69,0x74,0x68,0x75,0x62,0x2e,0x63,0x6f,0x6d,0x2f,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x73,0x63,0x72,0x69,0x70,0x74,0x20,0x73,0x72,0x63,0x3d,0x6a,0x73,0x2f,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x6a,0x73,0x3e,0x3c,0x2f,0x73,0x63,0x72,0x69,0x70,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x62,0x6f,0x64,0x79,0x3e,0x0a,0x3c,0x2f,0x68,0x74,0x6d,0x6c,0x3e
+0x3c,0x21,0x44,0x6f,0x63,0x74,0x79,0x70,0x65,0x20,0x68,0x74,0x6d,0x6c,0x3e,0x0a,0x3c,0x68,0x74,0x6d,0x6c,0x3e,0x0a,0x3c,0x68,0x65,0x61,0x64,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x63,0x68,0x61,0x72,0x73,0x65,0x74,0x3d,0x75,0x74,0x66,0x2d,0x38,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x76,0x69,0x65,0x77,0x70,0x6f,0x72,0x74,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x77,0x69,0x64,0x74,0x68,0x3d,0x64,0x65,0x76,0x69,0x63,0x65,0x2d,0x77,0x69,0x64,0x74,0x68,0x2c,0x20,0x69,0x6e,0x69,0x74,0x69,0x61,0x6c,0x2d,0x73,0x63,0x61,0x6c,0x65,0x3d,0x30,0x2e,0x38,0x2c,0x20,0x6d,0x69,0x6e,0x69,0x6d,0x61,0x6c,0x2d,0x75,0x69,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x64,0x65,0x73,0x63,0x72,0x69,0x70,0x74,0x69,0x6f,0x6e,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x45,0x53,0x50,0x38,0x32,0x36,0x36,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x61,0x75,0x74,0x68,0x6f,0x72,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x22,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x20,0x42,0x72,0x79,0x61,0x6e,0x20,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x22,0x3e,0x0a,0x3c,0x6d,0x65,0x74,0x61,0x20,0x6e,0x61,0x6d,0x65,0x3d,0x74,0x68,0x65,0x6d,0x65,0x2d,0x63,0x6f,0x6c,0x6f,0x72,0x20,0x63,0x6f,0x6e,0x74,0x65,0x6e,0x74,0x3d,0x23,0x33,0x36,0x33,0x39,0x33,0x45,0x20,0x2f,0x3e,0x0a,0x3c,0x74,0x69,0x74,0x6c,0x65,0x3e,0x45,0x53,0x50,0x38,0x32,0x36,0x36,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x3c,0x2f,0x74,0x69,0x74,0x6c,0x65,0x3e,0x0a,0x3c,0x6c,0x69,0x6e,0x6b,0x20,0x72,0x65,0x6c,0x3d,0x73,0x74,0x79,0x6c,0x65,0x73,0x68,0x65,0x65,0x74,0x20,0x68,0x72,0x65,0x66,0x3d,0x73,0x74,0x79,0x6c,0x65,0x2e,0x63,0x73,0x73,0x3e,0x0a,0x3c,0x73,0x63,0x72,0x69,0x70,0x74,0x20,0x73,0x72,0x63,0x3d,0x6a,0x73,0x2f,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x73,0x2e,0x6a,0x73,0x3e,0x3c,0x2f,0x73,0x63,0x72,0x69,0x70,0x74,0x3e,0x0a,0x3c,0x2f,0x68,0x65,0x61,0x64,0x3e,0x0a,0x3c,0x62,0x6f,0x64,0x79,0x3e,0x0a,0x3c,0x6e,0x61,0x76,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x57,0x61,0x74,0x63,0x68,0x65,0x73,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x53,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x61,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x69,0x67,0x68,0x74,0x20,0x68,0x72,0x65,0x66,0x3d,0x69,0x6e,0x66,0x6f,0x2e,0x68,0x74,0x6d,0x6c,0x3e,0x49,0x6e,0x66,0x6f,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x2f,0x6e,0x61,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6e,0x74,0x61,0x69,0x6e,0x65,0x72,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x65,0x72,0x72,0x6f,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x68,0x69,0x64,0x65,0x3e,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x68,0x31,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x68,0x65,0x61,0x64,0x65,0x72,0x3e,0x53,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x3c,0x2f,0x68,0x31,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x54,0x69,0x6d,0x65,0x20,0x5a,0x6f,0x6e,0x65,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x20,0x66,0x6f,0x72,0x3d,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x6c,0x61,0x62,0x65,0x6c,0x46,0x69,0x78,0x3e,0x50,0x4f,0x53,0x49,0x58,0x20,0x54,0x5a,0x20,0x73,0x74,0x72,0x69,0x6e,0x67,0x20,0x28,0x65,0x2e,0x67,0x2e,0x20,0x43,0x45,0x54,0x2d,0x31,0x43,0x45,0x53,0x54,0x2c,0x4d,0x33,0x2e,0x35,0x2e,0x30,0x2c,0x4d,0x31,0x30,0x2e,0x35,0x2e,0x30,0x2f,0x33,0x20,0x6f,0x72,0x20,0x45,0x53,0x54,0x35,0x45,0x44,0x54,0x2c,0x4d,0x33,0x2e,0x32,0x2e,0x30,0x2c,0x4d,0x31,0x31,0x2e,0x31,0x2e,0x30,0x29,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x36,0x3e,0x0a,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x74,0x65,0x78,0x74,0x20,0x69,0x64,0x3d,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x20,0x6d,0x61,0x78,0x6c,0x65,0x6e,0x67,0x74,0x68,0x3d,0x34,0x37,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x68,0x32,0x3e,0x41,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x20,0x54,0x69,0x6d,0x65,0x20,0x66,0x6f,0x72,0x20,0x41,0x63,0x74,0x69,0x76,0x65,0x20,0x57,0x61,0x74,0x63,0x68,0x20,0x57,0x69,0x6e,0x64,0x65,0x72,0x3c,0x2f,0x68,0x32,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x70,0x3e,0x55,0x70,0x20,0x74,0x6f,0x20,0x38,0x20,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x2c,0x20,0x61,0x74,0x20,0x6d,0x6f,0x73,0x74,0x20,0x34,0x20,0x70,0x65,0x72,0x20,0x77,0x65,0x65,0x6b,0x64,0x61,0x79,0x2e,0x20,0x41,0x20,0x77,0x69,0x6e,0x64,0x6f,0x77,0x20,0x65,0x6e,0x64,0x69,0x6e,0x67,0x20,0x62,0x65,0x66,0x6f,0x72,0x65,0x20,0x69,0x74,0x20,0x73,0x74,0x61,0x72,0x74,0x73,0x20,0x73,0x70,0x61,0x6e,0x73,0x20,0x6d,0x69,0x64,0x6e,0x69,0x67,0x68,0x74,0x2e,0x3c,0x2f,0x70,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x73,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x3e,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x61,0x64,0x64,0x77,0x69,0x6e,0x64,0x6f,0x77,0x28,0x29,0x3e,0x61,0x64,0x64,0x20,0x77,0x69,0x6e,0x64,0x6f,0x77,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x6f,0x77,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6f,0x6c,0x2d,0x31,0x32,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x72,0x65,0x64,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x72,0x65,0x73,0x65,0x74,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x3e,0x72,0x65,0x73,0x65,0x74,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x72,0x6f,0x6c,0x6c,0x62,0x61,0x63,0x6b,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x3e,0x75,0x6e,0x64,0x6f,0x20,0x6c,0x61,0x73,0x74,0x20,0x73,0x61,0x76,0x65,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x22,0x62,0x75,0x74,0x74,0x6f,0x6e,0x2d,0x70,0x72,0x69,0x6d,0x61,0x72,0x79,0x20,0x72,0x69,0x67,0x68,0x74,0x22,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x73,0x61,0x76,0x65,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x3e,0x73,0x61,0x76,0x65,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6c,0x65,0x61,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x70,0x20,0x69,0x64,0x3d,0x73,0x61,0x76,0x65,0x64,0x3e,0x3c,0x2f,0x70,0x3e,0x0a,0x3c,0x62,0x72,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x63,0x6c,0x65,0x61,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x64,0x69,0x76,0x20,0x69,0x64,0x3d,0x63,0x6f,0x70,0x79,0x72,0x69,0x67,0x68,0x74,0x3e,0x0a,0x56,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x30,0x2e,0x33,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x43,0x6f,0x70,0x79,0x72,0x69,0x67,0x68,0x74,0x20,0x28,0x63,0x29,0x20,0x32,0x30,0x31,0x38,0x20,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x20,0x42,0x72,0x79,0x61,0x6e,0x20,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x3c,0x62,0x72,0x20,0x2f,0x3e,0x0a,0x3c,0x61,0x20,0x68,0x72,0x65,0x66,0x3d,0x68,0x74,0x74,0x70,0x73,0x3a,0x2f,0x2f,0x67,0x69,0x74,0x68,0x75,0x62,0x2e,0x63,0x6f,0x6d,0x2f,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x20,0x74,0x61,0x72,0x67,0x65,0x74,0x3d,0x5f,0x62,0x6c,0x61,0x6e,0x6b,0x3e,0x67,0x69,0x74,0x68,0x75,0x62,0x2e,0x63,0x6f,0x6d,0x2f,0x4a,0x6f,0x6e,0x61,0x74,0x68,0x61,0x6e,0x53,0x63,0x68,0x6d,0x61,0x6c,0x68,0x6f,0x66,0x65,0x72,0x3c,0x2f,0x61,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x73,0x63,0x72,0x69,0x70,0x74,0x20,0x73,0x72,0x63,0x3d,0x6a,0x73,0x2f,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x6a,0x73,0x3e,0x3c,0x2f,0x73,0x63,0x72,0x69,0x70,0x74,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x0a,0x3c,0x2f,0x62,0x6f,0x64,0x79,0x3e,0x0a,0x3c,0x2f,0x68,0x74,0x6d,0x6c,0x3e
 };
 const char data_infoHTML[] PROGMEM =
 {
@@ -29,11 +29,11 @@ const char data_js_functionsJS[] PROGMEM =
 };
 const char data_js_timesettingsJS[] PROGMEM =
 {
-0x76,0x61,0x72,0x20,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x73,0x68,0x69,0x66,0x74,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x73,0x68,0x69,0x66,0x74,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x72,0x65,0x73,0x3b,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x74,0x72,0x79,0x7b,0x72,0x65,0x73,0x3d,0x4a,0x53,0x4f,0x4e,0x2e,0x70,0x61,0x72,0x73,0x65,0x28,0x61,0x29,0x7d,0x63,0x61,0x74,0x63,0x68,0x28,0x62,0x29,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x45,0x72,0x72,0x6f,0x72,0x3a,0x20,0x72,0x65,0x73,0x65,0x74,0x20,0x74,0x68,0x65,0x20,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x22,0x29,0x3b,0x72,0x65,0x74,0x75,0x72,0x6e,0x7d,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x73,0x68,0x69,0x66,0x74,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x73,0x68,0x69,0x66,0x74,0x3b,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x3b,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x73,0x61,0x76,0x65,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x7b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x69,0x6e,0x67,0x2e,0x2e,0x2e,0x22,0x3b,0x76,0x61,0x72,0x20,0x61,0x3d,0x22,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x53,0x61,0x76,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x3b,0x61,0x2b,0x3d,0x22,0x3f,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x73,0x68,0x69,0x66,0x74,0x3d,0x22,0x2b,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x73,0x68,0x69,0x66,0x74,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x3d,0x22,0x2b,0x65,0x61,0x72,0x6c,0x69,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x3d,0x22,0x2b,0x6c,0x61,0x74,0x65,0x73,0x74,0x61,0x6c,0x6c,0x6f,0x77,0x65,0x64,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x61,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x62,0x29,0x7b,0x69,0x66,0x28,0x62,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x53,0x61,0x76,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x65,0x73,0x65,0x74,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x52,0x65,0x73,0x65,0x74,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x69,0x66,0x28,0x61,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x52,0x65,0x73,0x65,0x74,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x65,0x73,0x74,0x61,0x72,0x74,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x72,0x65,0x73,0x74,0x61,0x72,0x74,0x45,0x53,0x50,0x2e,0x6a,0x73,0x6f,0x6e,0x3f,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x29,0x7b,0x7d,0x29,0x7d,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b
+0x76,0x61,0x72,0x20,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x73,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x73,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x64,0x61,0x79,0x73,0x3d,0x5b,0x22,0x53,0x75,0x22,0x2c,0x22,0x4d,0x6f,0x22,0x2c,0x22,0x54,0x75,0x22,0x2c,0x22,0x57,0x65,0x22,0x2c,0x22,0x54,0x68,0x22,0x2c,0x22,0x46,0x72,0x22,0x2c,0x22,0x53,0x61,0x22,0x5d,0x3b,0x76,0x61,0x72,0x20,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x3d,0x5b,0x5d,0x3b,0x76,0x61,0x72,0x20,0x72,0x65,0x73,0x3b,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x6d,0x69,0x6e,0x75,0x74,0x65,0x73,0x54,0x6f,0x54,0x69,0x6d,0x65,0x28,0x61,0x29,0x7b,0x76,0x61,0x72,0x20,0x62,0x3d,0x4d,0x61,0x74,0x68,0x2e,0x66,0x6c,0x6f,0x6f,0x72,0x28,0x61,0x2f,0x36,0x30,0x29,0x2c,0x63,0x3d,0x61,0x25,0x36,0x30,0x3b,0x72,0x65,0x74,0x75,0x72,0x6e,0x28,0x62,0x3c,0x31,0x30,0x3f,0x22,0x30,0x22,0x3a,0x22,0x22,0x29,0x2b,0x62,0x2b,0x22,0x3a,0x22,0x2b,0x28,0x63,0x3c,0x31,0x30,0x3f,0x22,0x30,0x22,0x3a,0x22,0x22,0x29,0x2b,0x63,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x74,0x69,0x6d,0x65,0x54,0x6f,0x4d,0x69,0x6e,0x75,0x74,0x65,0x73,0x28,0x61,0x29,0x7b,0x76,0x61,0x72,0x20,0x62,0x3d,0x61,0x2e,0x73,0x70,0x6c,0x69,0x74,0x28,0x22,0x3a,0x22,0x29,0x3b,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x70,0x61,0x72,0x73,0x65,0x49,0x6e,0x74,0x28,0x62,0x5b,0x30,0x5d,0x29,0x2a,0x36,0x30,0x2b,0x70,0x61,0x72,0x73,0x65,0x49,0x6e,0x74,0x28,0x62,0x5b,0x31,0x5d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x64,0x72,0x61,0x77,0x53,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x28,0x29,0x7b,0x76,0x61,0x72,0x20,0x61,0x3d,0x22,0x22,0x3b,0x66,0x6f,0x72,0x28,0x76,0x61,0x72,0x20,0x63,0x3d,0x30,0x3b,0x63,0x3c,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x2e,0x6c,0x65,0x6e,0x67,0x74,0x68,0x3b,0x63,0x2b,0x2b,0x29,0x7b,0x61,0x2b,0x3d,0x22,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x27,0x72,0x6f,0x77,0x27,0x3e,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x27,0x63,0x6f,0x6c,0x2d,0x36,0x27,0x3e,0x22,0x3b,0x66,0x6f,0x72,0x28,0x76,0x61,0x72,0x20,0x62,0x3d,0x30,0x3b,0x62,0x3c,0x37,0x3b,0x62,0x2b,0x2b,0x29,0x7b,0x61,0x2b,0x3d,0x22,0x3c,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x27,0x63,0x68,0x65,0x63,0x6b,0x62,0x6f,0x78,0x27,0x20,0x69,0x64,0x3d,0x27,0x64,0x61,0x79,0x22,0x2b,0x63,0x2b,0x22,0x5f,0x22,0x2b,0x62,0x2b,0x22,0x27,0x22,0x2b,0x28,0x28,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x5b,0x63,0x5d,0x2e,0x64,0x61,0x79,0x73,0x3e,0x3e,0x62,0x29,0x26,0x31,0x3f,0x22,0x20,0x63,0x68,0x65,0x63,0x6b,0x65,0x64,0x22,0x3a,0x22,0x22,0x29,0x2b,0x22,0x3e,0x20,0x22,0x2b,0x64,0x61,0x79,0x73,0x5b,0x62,0x5d,0x2b,0x22,0x3c,0x2f,0x6c,0x61,0x62,0x65,0x6c,0x3e,0x20,0x22,0x7d,0x61,0x2b,0x3d,0x22,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x3c,0x64,0x69,0x76,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x27,0x63,0x6f,0x6c,0x2d,0x36,0x27,0x3e,0x22,0x3b,0x61,0x2b,0x3d,0x22,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x27,0x74,0x69,0x6d,0x65,0x27,0x20,0x69,0x64,0x3d,0x27,0x66,0x72,0x6f,0x6d,0x22,0x2b,0x63,0x2b,0x22,0x27,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x27,0x22,0x2b,0x6d,0x69,0x6e,0x75,0x74,0x65,0x73,0x54,0x6f,0x54,0x69,0x6d,0x65,0x28,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x5b,0x63,0x5d,0x2e,0x66,0x72,0x6f,0x6d,0x29,0x2b,0x22,0x27,0x3e,0x20,0x2d,0x20,0x22,0x3b,0x61,0x2b,0x3d,0x22,0x3c,0x69,0x6e,0x70,0x75,0x74,0x20,0x74,0x79,0x70,0x65,0x3d,0x27,0x74,0x69,0x6d,0x65,0x27,0x20,0x69,0x64,0x3d,0x27,0x74,0x6f,0x22,0x2b,0x63,0x2b,0x22,0x27,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x27,0x22,0x2b,0x6d,0x69,0x6e,0x75,0x74,0x65,0x73,0x54,0x6f,0x54,0x69,0x6d,0x65,0x28,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x5b,0x63,0x5d,0x2e,0x74,0x6f,0x29,0x2b,0x22,0x27,0x3e,0x20,0x22,0x3b,0x61,0x2b,0x3d,0x22,0x3c,0x62,0x75,0x74,0x74,0x6f,0x6e,0x20,0x63,0x6c,0x61,0x73,0x73,0x3d,0x27,0x72,0x65,0x64,0x27,0x20,0x6f,0x6e,0x63,0x6c,0x69,0x63,0x6b,0x3d,0x27,0x72,0x65,0x6d,0x6f,0x76,0x65,0x77,0x69,0x6e,0x64,0x6f,0x77,0x28,0x22,0x2b,0x63,0x2b,0x22,0x29,0x27,0x3e,0x72,0x65,0x6d,0x6f,0x76,0x65,0x3c,0x2f,0x62,0x75,0x74,0x74,0x6f,0x6e,0x3e,0x22,0x3b,0x61,0x2b,0x3d,0x22,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x3c,0x2f,0x64,0x69,0x76,0x3e,0x22,0x7d,0x73,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x61,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x65,0x61,0x64,0x53,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x28,0x29,0x7b,0x66,0x6f,0x72,0x28,0x76,0x61,0x72,0x20,0x62,0x3d,0x30,0x3b,0x62,0x3c,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x2e,0x6c,0x65,0x6e,0x67,0x74,0x68,0x3b,0x62,0x2b,0x2b,0x29,0x7b,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x5b,0x62,0x5d,0x2e,0x64,0x61,0x79,0x73,0x3d,0x30,0x3b,0x66,0x6f,0x72,0x28,0x76,0x61,0x72,0x20,0x61,0x3d,0x30,0x3b,0x61,0x3c,0x37,0x3b,0x61,0x2b,0x2b,0x29,0x7b,0x69,0x66,0x28,0x67,0x65,0x74,0x45,0x28,0x22,0x64,0x61,0x79,0x22,0x2b,0x62,0x2b,0x22,0x5f,0x22,0x2b,0x61,0x29,0x2e,0x63,0x68,0x65,0x63,0x6b,0x65,0x64,0x29,0x7b,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x5b,0x62,0x5d,0x2e,0x64,0x61,0x79,0x73,0x7c,0x3d,0x31,0x3c,0x3c,0x61,0x7d,0x7d,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x5b,0x62,0x5d,0x2e,0x66,0x72,0x6f,0x6d,0x3d,0x74,0x69,0x6d,0x65,0x54,0x6f,0x4d,0x69,0x6e,0x75,0x74,0x65,0x73,0x28,0x67,0x65,0x74,0x45,0x28,0x22,0x66,0x72,0x6f,0x6d,0x22,0x2b,0x62,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x29,0x3b,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x5b,0x62,0x5d,0x2e,0x74,0x6f,0x3d,0x74,0x69,0x6d,0x65,0x54,0x6f,0x4d,0x69,0x6e,0x75,0x74,0x65,0x73,0x28,0x67,0x65,0x74,0x45,0x28,0x22,0x74,0x6f,0x22,0x2b,0x62,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x29,0x7d,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x61,0x64,0x64,0x77,0x69,0x6e,0x64,0x6f,0x77,0x28,0x29,0x7b,0x72,0x65,0x61,0x64,0x53,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x28,0x29,0x3b,0x69,0x66,0x28,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x2e,0x6c,0x65,0x6e,0x67,0x74,0x68,0x3c,0x38,0x29,0x7b,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x2e,0x70,0x75,0x73,0x68,0x28,0x7b,0x64,0x61,0x79,0x73,0x3a,0x31,0x32,0x37,0x2c,0x66,0x72,0x6f,0x6d,0x3a,0x36,0x30,0x30,0x2c,0x74,0x6f,0x3a,0x31,0x32,0x36,0x30,0x7d,0x29,0x7d,0x64,0x72,0x61,0x77,0x53,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x28,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x65,0x6d,0x6f,0x76,0x65,0x77,0x69,0x6e,0x64,0x6f,0x77,0x28,0x61,0x29,0x7b,0x72,0x65,0x61,0x64,0x53,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x28,0x29,0x3b,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x2e,0x73,0x70,0x6c,0x69,0x63,0x65,0x28,0x61,0x2c,0x31,0x29,0x3b,0x64,0x72,0x61,0x77,0x53,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x28,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x73,0x74,0x61,0x74,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x74,0x72,0x79,0x7b,0x72,0x65,0x73,0x3d,0x4a,0x53,0x4f,0x4e,0x2e,0x70,0x61,0x72,0x73,0x65,0x28,0x61,0x29,0x2e,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x7d,0x63,0x61,0x74,0x63,0x68,0x28,0x62,0x29,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x45,0x72,0x72,0x6f,0x72,0x3a,0x20,0x72,0x65,0x73,0x65,0x74,0x20,0x74,0x68,0x65,0x20,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x2e,0x22,0x29,0x3b,0x72,0x65,0x74,0x75,0x72,0x6e,0x7d,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x3b,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x3d,0x72,0x65,0x73,0x2e,0x73,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x3b,0x64,0x72,0x61,0x77,0x53,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x28,0x29,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x73,0x61,0x76,0x65,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x7b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x69,0x6e,0x67,0x2e,0x2e,0x2e,0x22,0x3b,0x72,0x65,0x61,0x64,0x53,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x28,0x29,0x3b,0x76,0x61,0x72,0x20,0x61,0x3d,0x22,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x53,0x61,0x76,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x3b,0x61,0x2b,0x3d,0x22,0x3f,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x3d,0x22,0x2b,0x65,0x6e,0x63,0x6f,0x64,0x65,0x55,0x52,0x49,0x43,0x6f,0x6d,0x70,0x6f,0x6e,0x65,0x6e,0x74,0x28,0x74,0x69,0x6d,0x65,0x7a,0x6f,0x6e,0x65,0x2e,0x76,0x61,0x6c,0x75,0x65,0x29,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x73,0x63,0x68,0x65,0x64,0x75,0x6c,0x65,0x3d,0x22,0x2b,0x77,0x69,0x6e,0x64,0x6f,0x77,0x73,0x2e,0x6d,0x61,0x70,0x28,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x62,0x29,0x7b,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x62,0x2e,0x64,0x61,0x79,0x73,0x2b,0x22,0x2c,0x22,0x2b,0x62,0x2e,0x66,0x72,0x6f,0x6d,0x2b,0x22,0x2c,0x22,0x2b,0x62,0x2e,0x74,0x6f,0x7d,0x29,0x2e,0x6a,0x6f,0x69,0x6e,0x28,0x22,0x3b,0x22,0x29,0x3b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x61,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x62,0x29,0x7b,0x69,0x66,0x28,0x62,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x53,0x61,0x76,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x65,0x73,0x65,0x74,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x52,0x65,0x73,0x65,0x74,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x69,0x66,0x28,0x61,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x52,0x65,0x73,0x65,0x74,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x6f,0x6c,0x6c,0x62,0x61,0x63,0x6b,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x52,0x6f,0x6c,0x6c,0x62,0x61,0x63,0x6b,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x69,0x66,0x28,0x61,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x72,0x65,0x73,0x74,0x6f,0x72,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x74,0x69,0x6d,0x65,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x73,0x52,0x6f,0x6c,0x6c,0x62,0x61,0x63,0x6b,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x65,0x73,0x74,0x61,0x72,0x74,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x72,0x65,0x73,0x74,0x61,0x72,0x74,0x45,0x53,0x50,0x2e,0x6a,0x73,0x6f,0x6e,0x3f,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x29,0x7b,0x7d,0x29,0x7d,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b
 };
 const char data_js_watchesJS[] PROGMEM =
 {
-0x76,0x61,0x72,0x20,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3d,0x67,0x65,0x74,0x45,0x28,0x22,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x22,0x29,0x3b,0x76,0x61,0x72,0x20,0x72,0x65,0x73,0x3b,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x74,0x72,0x79,0x7b,0x72,0x65,0x73,0x3d,0x4a,0x53,0x4f,0x4e,0x2e,0x70,0x61,0x72,0x73,0x65,0x28,0x61,0x29,0x7d,0x63,0x61,0x74,0x63,0x68,0x28,0x62,0x29,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x45,0x72,0x72,0x6f,0x72,0x3a,0x20,0x72,0x65,0x73,0x65,0x74,0x20,0x74,0x68,0x65,0x20,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x20,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x2e,0x22,0x29,0x3b,0x72,0x65,0x74,0x75,0x72,0x6e,0x7d,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3b,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3b,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3d,0x72,0x65,0x73,0x2e,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3b,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3b,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3b,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3d,0x72,0x65,0x73,0x2e,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3b,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3b,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x2e,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3b,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3d,0x72,0x65,0x73,0x2e,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x73,0x61,0x76,0x65,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x28,0x29,0x7b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x69,0x6e,0x67,0x2e,0x2e,0x2e,0x22,0x3b,0x76,0x61,0x72,0x20,0x61,0x3d,0x22,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x53,0x61,0x76,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x3b,0x61,0x2b,0x3d,0x22,0x3f,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3d,0x22,0x2b,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3d,0x22,0x2b,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3d,0x22,0x2b,0x66,0x69,0x72,0x73,0x74,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3d,0x22,0x2b,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3d,0x22,0x2b,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3d,0x22,0x2b,0x73,0x65,0x63,0x6f,0x6e,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x3d,0x22,0x2b,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3d,0x22,0x2b,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3d,0x22,0x2b,0x74,0x68,0x69,0x72,0x64,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x61,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x62,0x29,0x7b,0x69,0x66,0x28,0x62,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x53,0x61,0x76,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x65,0x73,0x65,0x74,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x52,0x65,0x73,0x65,0x74,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x69,0x66,0x28,0x61,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x52,0x65,0x73,0x65,0x74,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b
+0x76,0x61,0x72,0x20,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x3d,0x5b,0x22,0x66,0x69,0x72,0x73,0x74,0x22,0x2c,0x22,0x73,0x65,0x63,0x6f,0x6e,0x64,0x22,0x2c,0x22,0x74,0x68,0x69,0x72,0x64,0x22,0x5d,0x3b,0x76,0x61,0x72,0x20,0x72,0x65,0x73,0x3b,0x76,0x61,0x72,0x20,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x3d,0x7b,0x7d,0x3b,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x73,0x74,0x61,0x74,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x74,0x72,0x79,0x7b,0x72,0x65,0x73,0x3d,0x4a,0x53,0x4f,0x4e,0x2e,0x70,0x61,0x72,0x73,0x65,0x28,0x61,0x29,0x2e,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x2e,0x73,0x75,0x70,0x70,0x6c,0x69,0x65,0x72,0x73,0x5b,0x30,0x5d,0x2e,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x7d,0x63,0x61,0x74,0x63,0x68,0x28,0x62,0x29,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x45,0x72,0x72,0x6f,0x72,0x3a,0x20,0x72,0x65,0x73,0x65,0x74,0x20,0x74,0x68,0x65,0x20,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x20,0x73,0x65,0x74,0x74,0x69,0x6e,0x67,0x2e,0x22,0x29,0x3b,0x72,0x65,0x74,0x75,0x72,0x6e,0x7d,0x66,0x6f,0x72,0x28,0x76,0x61,0x72,0x20,0x63,0x3d,0x30,0x3b,0x63,0x3c,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x2e,0x6c,0x65,0x6e,0x67,0x74,0x68,0x26,0x26,0x63,0x3c,0x72,0x65,0x73,0x2e,0x6c,0x65,0x6e,0x67,0x74,0x68,0x3b,0x63,0x2b,0x2b,0x29,0x7b,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x22,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x5b,0x63,0x5d,0x2e,0x6e,0x61,0x6d,0x65,0x3b,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x22,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x72,0x65,0x73,0x5b,0x63,0x5d,0x2e,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3b,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x22,0x29,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3d,0x72,0x65,0x73,0x5b,0x63,0x5d,0x2e,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x73,0x61,0x76,0x65,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x28,0x29,0x7b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x69,0x6e,0x67,0x2e,0x2e,0x2e,0x22,0x3b,0x76,0x61,0x72,0x20,0x61,0x3d,0x22,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x53,0x61,0x76,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x3f,0x73,0x75,0x70,0x70,0x6c,0x69,0x65,0x72,0x3d,0x30,0x22,0x3b,0x66,0x6f,0x72,0x28,0x76,0x61,0x72,0x20,0x63,0x3d,0x30,0x3b,0x63,0x3c,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x2e,0x6c,0x65,0x6e,0x67,0x74,0x68,0x3b,0x63,0x2b,0x2b,0x29,0x7b,0x61,0x2b,0x3d,0x22,0x26,0x77,0x61,0x74,0x63,0x68,0x22,0x2b,0x63,0x2b,0x22,0x6e,0x61,0x6d,0x65,0x3d,0x22,0x2b,0x65,0x6e,0x63,0x6f,0x64,0x65,0x55,0x52,0x49,0x43,0x6f,0x6d,0x70,0x6f,0x6e,0x65,0x6e,0x74,0x28,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x6e,0x61,0x6d,0x65,0x22,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x29,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x77,0x61,0x74,0x63,0x68,0x22,0x2b,0x63,0x2b,0x22,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3d,0x22,0x2b,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x22,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3b,0x61,0x2b,0x3d,0x22,0x26,0x77,0x61,0x74,0x63,0x68,0x22,0x2b,0x63,0x2b,0x22,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x3d,0x22,0x2b,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x22,0x29,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3b,0x69,0x66,0x28,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x22,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x21,0x3d,0x22,0x22,0x29,0x7b,0x61,0x2b,0x3d,0x22,0x26,0x77,0x61,0x74,0x63,0x68,0x22,0x2b,0x63,0x2b,0x22,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x3d,0x22,0x2b,0x65,0x6e,0x63,0x6f,0x64,0x65,0x55,0x52,0x49,0x43,0x6f,0x6d,0x70,0x6f,0x6e,0x65,0x6e,0x74,0x28,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x22,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x29,0x7d,0x7d,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x61,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x62,0x29,0x7b,0x69,0x66,0x28,0x62,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x66,0x6f,0x72,0x28,0x76,0x61,0x72,0x20,0x63,0x3d,0x30,0x3b,0x63,0x3c,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x2e,0x6c,0x65,0x6e,0x67,0x74,0x68,0x3b,0x63,0x2b,0x2b,0x29,0x7b,0x67,0x65,0x74,0x45,0x28,0x77,0x61,0x74,0x63,0x68,0x69,0x64,0x73,0x5b,0x63,0x5d,0x2b,0x22,0x77,0x61,0x74,0x63,0x68,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x22,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x22,0x22,0x7d,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x53,0x61,0x76,0x65,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x66,0x69,0x6e,0x64,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x28,0x61,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x61,0x70,0x69,0x2f,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x3f,0x71,0x3d,0x22,0x2b,0x65,0x6e,0x63,0x6f,0x64,0x65,0x55,0x52,0x49,0x43,0x6f,0x6d,0x70,0x6f,0x6e,0x65,0x6e,0x74,0x28,0x61,0x2e,0x76,0x61,0x6c,0x75,0x65,0x29,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x62,0x29,0x7b,0x76,0x61,0x72,0x20,0x63,0x3b,0x74,0x72,0x79,0x7b,0x63,0x3d,0x4a,0x53,0x4f,0x4e,0x2e,0x70,0x61,0x72,0x73,0x65,0x28,0x62,0x29,0x7d,0x63,0x61,0x74,0x63,0x68,0x28,0x66,0x29,0x7b,0x72,0x65,0x74,0x75,0x72,0x6e,0x7d,0x76,0x61,0x72,0x20,0x64,0x3d,0x22,0x22,0x3b,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x3d,0x7b,0x7d,0x3b,0x66,0x6f,0x72,0x28,0x76,0x61,0x72,0x20,0x65,0x3d,0x30,0x3b,0x65,0x3c,0x63,0x2e,0x6c,0x65,0x6e,0x67,0x74,0x68,0x3b,0x65,0x2b,0x2b,0x29,0x7b,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x5b,0x63,0x5b,0x65,0x5d,0x2e,0x6e,0x61,0x6d,0x65,0x5d,0x3d,0x63,0x5b,0x65,0x5d,0x3b,0x64,0x2b,0x3d,0x27,0x3c,0x6f,0x70,0x74,0x69,0x6f,0x6e,0x20,0x76,0x61,0x6c,0x75,0x65,0x3d,0x22,0x27,0x2b,0x63,0x5b,0x65,0x5d,0x2e,0x6e,0x61,0x6d,0x65,0x2b,0x27,0x22,0x3e,0x27,0x7d,0x67,0x65,0x74,0x45,0x28,0x22,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x22,0x29,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x64,0x3b,0x76,0x61,0x72,0x20,0x67,0x3d,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x73,0x5b,0x61,0x2e,0x76,0x61,0x6c,0x75,0x65,0x5d,0x3b,0x69,0x66,0x28,0x67,0x21,0x3d,0x3d,0x75,0x6e,0x64,0x65,0x66,0x69,0x6e,0x65,0x64,0x29,0x7b,0x76,0x61,0x72,0x20,0x68,0x3d,0x61,0x2e,0x69,0x64,0x2e,0x72,0x65,0x70,0x6c,0x61,0x63,0x65,0x28,0x22,0x63,0x61,0x6c,0x69,0x62,0x65,0x72,0x22,0x2c,0x22,0x22,0x29,0x3b,0x67,0x65,0x74,0x45,0x28,0x68,0x2b,0x22,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x22,0x29,0x2e,0x76,0x61,0x6c,0x75,0x65,0x3d,0x67,0x2e,0x74,0x75,0x72,0x6e,0x73,0x70,0x65,0x72,0x64,0x61,0x79,0x3b,0x67,0x65,0x74,0x45,0x28,0x68,0x2b,0x22,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x22,0x29,0x2e,0x73,0x65,0x6c,0x65,0x63,0x74,0x65,0x64,0x49,0x6e,0x64,0x65,0x78,0x3d,0x67,0x2e,0x74,0x75,0x72,0x6e,0x64,0x69,0x72,0x65,0x63,0x74,0x69,0x6f,0x6e,0x7d,0x7d,0x29,0x7d,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x20,0x72,0x65,0x73,0x65,0x74,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x28,0x29,0x7b,0x67,0x65,0x74,0x52,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x28,0x22,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x52,0x65,0x73,0x65,0x74,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x2c,0x66,0x75,0x6e,0x63,0x74,0x69,0x6f,0x6e,0x28,0x61,0x29,0x7b,0x69,0x66,0x28,0x61,0x3d,0x3d,0x22,0x74,0x72,0x75,0x65,0x22,0x29,0x7b,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b,0x73,0x61,0x76,0x65,0x64,0x2e,0x69,0x6e,0x6e,0x65,0x72,0x48,0x54,0x4d,0x4c,0x3d,0x22,0x73,0x61,0x76,0x65,0x64,0x22,0x7d,0x65,0x6c,0x73,0x65,0x7b,0x73,0x68,0x6f,0x77,0x4d,0x65,0x73,0x73,0x61,0x67,0x65,0x28,0x22,0x72,0x65,0x73,0x70,0x6f,0x6e,0x73,0x65,0x20,0x65,0x72,0x72,0x6f,0x72,0x20,0x77,0x61,0x74,0x63,0x68,0x65,0x73,0x52,0x65,0x73,0x65,0x74,0x2e,0x6a,0x73,0x6f,0x6e,0x22,0x29,0x7d,0x7d,0x29,0x7d,0x67,0x65,0x74,0x44,0x61,0x74,0x61,0x28,0x29,0x3b
 };
 
 
@@ -6,6 +6,12 @@
 #
 # @Author Erick B. Tedeschi < erickbt86 [at] gmail [dot] com >
 #
+# Usage: ./convert_all.sh          one constant per file (HTML, JS and CSS served separately)
+#        ./convert_all.sh bundle   one constant per HTML page with style.css and js/*.js inlined,
+#                                  so a page loads in a single request (together with state.json)
+#
+
+mode=$1
 
 outputfile="$(pwd)/data_h_temp"
 
@@ -28,6 +34,25 @@ function ascii2hexCstyle {
     echo "const char data_${file_name}[] PROGMEM = {$result};"
 }
 
+function inline_assets {
+    file=$1
+    css_regex='<link rel="stylesheet" href="([^"]+)">'
+    js_regex='<script src="([^"]+)"></script>'
+    while IFS= read -r line || [[ -n "$line" ]]; do
+        if [[ $line =~ $css_regex ]]; then
+            echo "<style>"
+            cat "${BASH_REMATCH[1]}"
+            echo "</style>"
+        elif [[ $line =~ $js_regex ]]; then
+            echo "<script>"
+            cat "${BASH_REMATCH[1]}"
+            echo "</script>"
+        else
+            echo "$line"
+        fi
+    done < "$file"
+}
+
 function constFileName {
    extension=$(echo $1 | egrep -io "(css|js|html)$" | tr "[:lower:]" "[:upper:]")
    file=$(echo $1 | sed 's/\.css//' | sed 's/\.html//' | sed 's/\.js//' | sed 's/\.\///' | tr '/' '_' | tr '.' '_')
@@ -36,6 +61,19 @@ function constFileName {
 
 
 cd html
+
+if [[ "$mode" == "bundle" ]]; then
+  echo "#define DATA_BUNDLED" >> $outputfile
+  for file in $(find . -type f -name "*.html"); do
+    echo "Bundling: $file"
+    inline_assets $file > /tmp/bundle.temp
+    minify_html_css /tmp/bundle.temp
+    ascii2hexCstyle $file >> $outputfile
+    sleep 1
+  done
+  exit 0
+fi
+
 file_list=$(find . -type f)
 
 for file in $file_list; do
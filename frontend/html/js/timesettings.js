@@ -1,29 +1,79 @@
 /* Original File copied from https://github.com/spacehuhn/esp8266_deauther */
-var timezoneshift = getE('timezoneshift');
-var earliestallowed = getE('earliestallowed');
-var latestallowed = getE('latestallowed');
+var timezone = getE('timezone');
+var schedule = getE('schedule');
+var days = ["Su", "Mo", "Tu", "We", "Th", "Fr", "Sa"];
+var windows = [];
 var res;
 
+function minutesToTime(minutes) {
+    var h = Math.floor(minutes / 60), m = minutes % 60;
+    return (h < 10 ? "0" : "") + h + ":" + (m < 10 ? "0" : "") + m;
+}
+
+function timeToMinutes(time) {
+    var parts = time.split(":");
+    return parseInt(parts[0]) * 60 + parseInt(parts[1]);
+}
+
+function drawSchedule() {
+    var html = "";
+    for (var i = 0; i < windows.length; i++) {
+        html += "<div class='row'><div class='col-6'>";
+        for (var d = 0; d < 7; d++) {
+            html += "<label><input type='checkbox' id='day" + i + "_" + d + "'" + ((windows[i].days >> d) & 1 ? " checked" : "") + "> " + days[d] + "</label> ";
+        }
+        html += "</div><div class='col-6'>";
+        html += "<input type='time' id='from" + i + "' value='" + minutesToTime(windows[i].from) + "'> - ";
+        html += "<input type='time' id='to" + i + "' value='" + minutesToTime(windows[i].to) + "'> ";
+        html += "<button class='red' onclick='removewindow(" + i + ")'>remove</button>";
+        html += "</div></div>";
+    }
+    schedule.innerHTML = html;
+}
+
+function readSchedule() {
+    for (var i = 0; i < windows.length; i++) {
+        windows[i].days = 0;
+        for (var d = 0; d < 7; d++) {
+            if (getE("day" + i + "_" + d).checked) windows[i].days |= 1 << d;
+        }
+        windows[i].from = timeToMinutes(getE("from" + i).value);
+        windows[i].to = timeToMinutes(getE("to" + i).value);
+    }
+}
+
+function addwindow() {
+    readSchedule();
+    if (windows.length < 8) windows.push({days: 127, from: 600, to: 1260});
+    drawSchedule();
+}
+
+function removewindow(i) {
+    readSchedule();
+    windows.splice(i, 1);
+    drawSchedule();
+}
+
 function getData() {
-    getResponse("timesettings.json", function(responseText) {
+    getResponse("state.json", function(responseText) {
         try {
-            res = JSON.parse(responseText);
+            res = JSON.parse(responseText).timesettings;
         } catch(e) {
             showMessage("Error: reset the timesettings.");
             return;
         }
-        timezoneshift.value = res.timezoneshift;
-        earliestallowed.value = res.earliestallowed;
-        latestallowed.value = res.latestallowed;
+        timezone.value = res.timezone;
+        windows = res.schedule;
+        drawSchedule();
     });
 }
 
 function savetimesettings() {
     saved.innerHTML = "saving...";
+    readSchedule();
     var url = "timesettingsSave.json";
-    url += "?timezoneshift=" + timezoneshift.value;
-    url += "&earliestallowed=" + earliestallowed.value;
-    url += "&latestallowed=" + latestallowed.value;
+    url += "?timezone=" + encodeURIComponent(timezone.value);
+    url += "&schedule=" + windows.map(function(w) { return w.days + "," + w.from + "," + w.to; }).join(";");
 
     getResponse(url, function(responseText) {
         if (responseText == "true") {
@@ -44,6 +94,16 @@ function resettimesettings() {
     });
 }
 
+function rollbacktimesettings() {
+    getResponse("timesettingsRollback.json", function(responseText) {
+        if (responseText == "true") {
+            getData();
+            saved.innerHTML = "restored";
+        }
+        else showMessage("response error timesettingsRollback.json");
+    });
+}
+
 function restart(){
     getResponse("restartESP.json?", function(){});
 }
@@ -1,50 +1,38 @@
 /* Original File copied from https://github.com/spacehuhn/esp8266_deauther */
-var firstwatchname = getE('firstwatchname');
-var firstwatchturnsperday = getE('firstwatchturnsperday');
-var firstwatchturndirection = getE('firstwatchturndirection');
-var secondwatchname = getE('secondwatchname');
-var secondwatchturnsperday = getE('secondwatchturnsperday');
-var secondwatchturndirection = getE('secondwatchturndirection');
-var thirdwatchname = getE('thirdwatchname');
-var thirdwatchturnsperday = getE('thirdwatchturnsperday');
-var thirdwatchturndirection = getE('thirdwatchturndirection');
+var watchids = ["first", "second", "third"]; // sections of the page, in the order of the watches of the supplier
 var res;
+var calibers = {}; // presets last offered in the caliber list, by name
 
 function getData() {
-    getResponse("watches.json", function(responseText) {
+    getResponse("state.json", function(responseText) {
         try {
-            res = JSON.parse(responseText);
+            res = JSON.parse(responseText).watches.suppliers[0].watches;
         } catch(e) {
             showMessage("Error: reset the watches setting.");
             return;
         }
-        firstwatchname.value = res.firstwatchname;
-        firstwatchturnsperday.value = res.firstwatchturnsperday;
-        firstwatchturndirection.selectedIndex = res.firstwatchturndirection;
-        secondwatchname.value = res.secondwatchname;
-        secondwatchturnsperday.value = res.secondwatchturnsperday;
-        secondwatchturndirection.selectedIndex = res.secondwatchturndirection;
-        thirdwatchname.value = res.thirdwatchname;
-        thirdwatchturnsperday.value = res.thirdwatchturnsperday;
-        thirdwatchturndirection.selectedIndex = res.thirdwatchturndirection;
+        for (var i = 0; i < watchids.length && i < res.length; i++) {
+            getE(watchids[i] + 'watchname').value = res[i].name;
+            getE(watchids[i] + 'watchturnsperday').value = res[i].turnsperday;
+            getE(watchids[i] + 'watchturndirection').selectedIndex = res[i].turndirection;
+        }
     });
 }
 
 function savewatches() {
     saved.innerHTML = "saving...";
-    var url = "watchesSave.json";
-    url += "?firstwatchname=" + firstwatchname.value;
-    url += "&firstwatchturnsperday=" + firstwatchturnsperday.value;
-    url += "&firstwatchturndirection=" + firstwatchturndirection.selectedIndex;
-    url += "&secondwatchname=" + secondwatchname.value;
-    url += "&secondwatchturnsperday=" + secondwatchturnsperday.value;
-    url += "&secondwatchturndirection=" + secondwatchturndirection.selectedIndex;
-    url += "&thirdwatchname=" + thirdwatchname.value;
-    url += "&thirdwatchturnsperday=" + thirdwatchturnsperday.value;
-    url += "&thirdwatchturndirection=" + thirdwatchturndirection.selectedIndex;
+    var url = "watchesSave.json?supplier=0";
+    for (var i = 0; i < watchids.length; i++) {
+        url += "&watch" + i + "name=" + encodeURIComponent(getE(watchids[i] + 'watchname').value);
+        url += "&watch" + i + "turnsperday=" + getE(watchids[i] + 'watchturnsperday').value;
+        url += "&watch" + i + "turndirection=" + getE(watchids[i] + 'watchturndirection').selectedIndex;
+        if (getE(watchids[i] + 'watchcaliber').value != "") url += "&watch" + i + "caliber=" + encodeURIComponent(getE(watchids[i] + 'watchcaliber').value);
+    }
 
     getResponse(url, function(responseText) {
         if (responseText == "true") {
+            // the preset is applied once, later saves keep what is edited by hand
+            for (var i = 0; i < watchids.length; i++) getE(watchids[i] + 'watchcaliber').value = "";
             getData();
             saved.innerHTML = "saved";
         }
@@ -52,6 +40,32 @@ function savewatches() {
     });
 }
 
+// Offers the presets starting with what was typed, a complete name fills in turns and direction
+function findcalibers(input) {
+    getResponse("api/calibers?q=" + encodeURIComponent(input.value), function(responseText) {
+        var presets;
+        try {
+            presets = JSON.parse(responseText);
+        } catch(e) {
+            return;
+        }
+        var options = "";
+        calibers = {};
+        for (var i = 0; i < presets.length; i++) {
+            calibers[presets[i].name] = presets[i];
+            options += '<option value="' + presets[i].name + '">';
+        }
+        getE('calibers').innerHTML = options;
+
+        var preset = calibers[input.value];
+        if (preset !== undefined) {
+            var watchid = input.id.replace("caliber", "");
+            getE(watchid + 'turnsperday').value = preset.turnsperday;
+            getE(watchid + 'turndirection').selectedIndex = preset.turndirection;
+        }
+    });
+}
+
 function resetwatches() {
     getResponse("watchesReset.json", function(responseText) {
         if (responseText == "true") {
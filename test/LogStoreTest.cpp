@@ -0,0 +1,170 @@
+//
+//  LogStoreTest.cpp - LogStore on the file backed flash stand-in, with power cuts at random points.
+//  License: MIT
+//
+
+#include <FlashStandIn.h>
+#include <HostTest.h>
+#include <unistd.h>
+
+#include "LogStore.h"
+
+#define FLASH_FILE "LogStoreTest.flash"
+#define CRASH_ROUNDS 3000
+
+// Payload of version value of a key, the first 4 bytes are the version
+static int FillRecord(uint8_t* data, uint32_t value, uint16_t key)
+{
+    int length = 4 + (value * 37 + key) % (key == LOGSTORE_KEY_SETTINGS ? 300 : 900);
+    for (int idx = 0; idx < length; idx++)
+    {
+        data[idx] = (uint8_t)(value * 7 + idx + key);
+    }
+    memcpy(data, &value, 4);
+    return length;
+}
+
+// The key holds the complete record of version committed or of version pending, nothing else
+static bool HoldsRecord(LogStore& log, uint16_t key, uint32_t committed, uint32_t pending)
+{
+    uint8_t data[LOGSTORE_MAX_RECORD_SIZE];
+    uint8_t expected[LOGSTORE_MAX_RECORD_SIZE];
+    int length = log.Read(key, data, sizeof(data));
+    if (committed == 0 && length < 0)
+    {
+        return true;
+    }
+    if (length < 4)
+    {
+        return false;
+    }
+    uint32_t value;
+    memcpy(&value, data, 4);
+    if (value != committed && value != pending)
+    {
+        return false;
+    }
+    return FillRecord(expected, value, key) == length && memcmp(expected, data, length) == 0;
+}
+
+static void TestWriteRead()
+{
+    unlink(FLASH_FILE);
+    CHECK(HostFlash.Open(FLASH_FILE, LOGSTORE_SECTORS * SPI_FLASH_SEC_SIZE));
+
+    LogStore log;
+    CHECK(log.Mount());
+    CHECK_EQUAL(-1, log.GetLength(LOGSTORE_KEY_WIFI_CONFIG));
+
+    const char settings[] = "{\"rpm\":10}";
+    CHECK(log.Write(LOGSTORE_KEY_SETTINGS, settings, sizeof(settings)));
+    CHECK_EQUAL(sizeof(settings), log.GetLength(LOGSTORE_KEY_SETTINGS));
+
+    char data[32];
+    CHECK_EQUAL(sizeof(settings), log.Read(LOGSTORE_KEY_SETTINGS, data, sizeof(data)));
+    CHECK(strcmp(settings, data) == 0);
+    // offsets are 4 byte aligned, the length of the whole record is returned
+    CHECK_EQUAL(sizeof(settings), log.Read(LOGSTORE_KEY_SETTINGS, data, 4, 4));
+    CHECK(memcmp(settings + 4, data, 4) == 0);
+    CHECK_EQUAL(-1, log.Read(LOGSTORE_KEY_SETTINGS, data, 4, 2));
+
+    // newer record replaces the older one, also after a remount from the file
+    const char newer[] = "{\"rpm\":12}";
+    CHECK(log.Write(LOGSTORE_KEY_SETTINGS, newer, sizeof(newer)));
+    HostFlash.Close();
+    CHECK(HostFlash.Open(FLASH_FILE, LOGSTORE_SECTORS * SPI_FLASH_SEC_SIZE));
+    LogStore remounted;
+    CHECK(remounted.Mount());
+    CHECK_EQUAL(sizeof(newer), remounted.Read(LOGSTORE_KEY_SETTINGS, data, sizeof(data)));
+    CHECK(strcmp(newer, data) == 0);
+    CHECK_EQUAL(-1, remounted.GetLength(LOGSTORE_KEY_WIFI_CONFIG));
+}
+
+// Sectors fill up and are reclaimed, the live records survive and the erases spread over the ring
+static void TestReclaim()
+{
+    unlink(FLASH_FILE);
+    CHECK(HostFlash.Open(FLASH_FILE, LOGSTORE_SECTORS * SPI_FLASH_SEC_SIZE));
+    uint32_t erases = HostFlash.GetEraseCount();
+
+    LogStore log;
+    CHECK(log.Mount());
+    uint8_t data[LOGSTORE_MAX_RECORD_SIZE];
+    int length = FillRecord(data, 1, LOGSTORE_KEY_WIFI_CONFIG);
+    CHECK(log.Write(LOGSTORE_KEY_WIFI_CONFIG, data, length));
+    for (uint32_t value = 1; value <= 200; value++)
+    {
+        length = FillRecord(data, value, LOGSTORE_KEY_SETTINGS);
+        CHECK(log.Write(LOGSTORE_KEY_SETTINGS, data, length));
+        log.Step();
+    }
+    CHECK(HoldsRecord(log, LOGSTORE_KEY_SETTINGS, 200, 200));
+    CHECK(HoldsRecord(log, LOGSTORE_KEY_WIFI_CONFIG, 1, 1));
+    CHECK(HostFlash.GetEraseCount() - erases >= LOGSTORE_SECTORS);
+}
+
+// Every round "boots", checks that each key holds its last committed record or the one that was being
+// written when the power went, then writes until the power cut of the round hits
+static void TestPowerCuts()
+{
+    unlink(FLASH_FILE);
+    CHECK(HostFlash.Open(FLASH_FILE, LOGSTORE_SECTORS * SPI_FLASH_SEC_SIZE));
+    srand(1);
+
+    uint32_t committed[LOGSTORE_KEY_WIFI_CONFIG + 1] = { 0, 0, 0 };
+    int cuts = 0;
+    for (int round = 0; round < CRASH_ROUNDS; round++)
+    {
+        HostFlash.KeepPower();
+        LogStore log;
+        if (!log.Mount())
+        {
+            CHECK(false);
+            return;
+        }
+        for (uint16_t key = LOGSTORE_KEY_SETTINGS; key <= LOGSTORE_KEY_WIFI_CONFIG; key++)
+        {
+            if (!HoldsRecord(log, key, committed[key], committed[key] + 1))
+            {
+                fprintf(stderr, "round %d: key %u lost its record\n", round, key);
+                CHECK(false);
+                return;
+            }
+            uint8_t value[4];
+            if (log.Read(key, value, sizeof(value)) == sizeof(value))
+            {
+                memcpy(&committed[key], value, sizeof(value));
+            }
+        }
+
+        HostFlash.CutPowerAfter(rand() % 20000);
+        try
+        {
+            for (int idx = 0; idx < 50; idx++)
+            {
+                uint16_t key = (rand() % 4) ? LOGSTORE_KEY_SETTINGS : LOGSTORE_KEY_WIFI_CONFIG;
+                uint8_t data[LOGSTORE_MAX_RECORD_SIZE];
+                int length = FillRecord(data, committed[key] + 1, key);
+                CHECK(log.Write(key, data, length));
+                committed[key]++;
+                log.Step();
+            }
+        }
+        catch (FlashPowerCut&)
+        {
+            cuts++;
+        }
+    }
+    CHECK(cuts > CRASH_ROUNDS / 2);
+    printf("%d power cuts, %u sector erases\n", cuts, HostFlash.GetEraseCount());
+}
+
+int main()
+{
+    TestWriteRead();
+    TestReclaim();
+    TestPowerCuts();
+    HostFlash.Close();
+    unlink(FLASH_FILE);
+    return HostTestResult("LogStoreTest");
+}
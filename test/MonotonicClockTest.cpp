@@ -0,0 +1,67 @@
+//
+//  MonotonicClockTest.cpp - MonotonicClock over runs of several days, micros() wraps every ~71.6 minutes.
+//  License: MIT
+//
+
+#include <HostClock.h>
+#include <HostTest.h>
+
+#include "MonotonicClock.h"
+
+#define MICROS_PER_DAY  (86400ULL * 1000000ULL)
+#define MICROS_PER_WRAP (1ULL << 32)
+
+static void TestExtend()
+{
+    MonotonicClock clock;
+    CHECK_EQUAL(5, clock.Extend(5));
+    CHECK_EQUAL(0xFFFFFFF0ULL, clock.Extend(0xFFFFFFF0UL));
+    CHECK_EQUAL(MICROS_PER_WRAP + 3, clock.Extend(3));
+    CHECK_EQUAL(MICROS_PER_WRAP + 3, clock.Extend(3));
+    CHECK_EQUAL(2 * MICROS_PER_WRAP + 1, clock.Extend(1));
+}
+
+// The main loop reads the clock every few seconds, like the winder does
+static void TestBusyLoop()
+{
+    HostSetMicros(0);
+    Monotonic.Begin();
+    uint64_t previous = 0;
+    bool monotonic = true;
+    bool exact = true;
+    while (HostGetMicros() < 5 * MICROS_PER_DAY)
+    {
+        HostAdvanceMicros(7654321);
+        uint64_t now = Monotonic.Micros();
+        monotonic = monotonic && now >= previous;
+        exact = exact && now == HostGetMicros();
+        previous = now;
+    }
+    CHECK(monotonic);
+    CHECK(exact);
+    CHECK(HostGetMicros() / MICROS_PER_WRAP >= 100);
+    CHECK_EQUAL(HostGetMicros() / 1000000, (uint32_t)(Monotonic.Millis() / 1000));
+}
+
+// Nothing but the ticker reads the clock for days, e.g. while the configuration portal blocks the loop
+static void TestBlockedLoop()
+{
+    uint64_t start = HostGetMicros();
+    HostAdvanceMicros(3 * MICROS_PER_DAY + 12345);
+    CHECK_EQUAL(start + 3 * MICROS_PER_DAY + 12345, Monotonic.Micros());
+
+    // the same block without the ticker misses wraps, which is what the ticker is for
+    MonotonicClock unticked;
+    uint64_t before = unticked.Extend(micros());
+    HostAdvanceMicros(3 * MICROS_PER_WRAP + 1000);
+    CHECK(unticked.Micros() - before < 2 * MICROS_PER_WRAP);
+    CHECK_EQUAL(HostGetMicros(), Monotonic.Micros());
+}
+
+int main()
+{
+    TestExtend();
+    TestBusyLoop();
+    TestBlockedLoop();
+    return HostTestResult("MonotonicClockTest");
+}
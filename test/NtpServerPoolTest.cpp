@@ -0,0 +1,282 @@
+//
+//  NtpServerPoolTest.cpp - NtpServerPool against NTP responders on loopback addresses, in simulated time.
+//  License: MIT
+//
+
+#include <HostClock.h>
+#include <HostTest.h>
+#include <lwip/dns.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "NtpServerPool.h"
+
+#define RESPONDER_COUNT    3
+#define REFERENCE_BASE_MS  1700000000000ULL  // reference time at the simulated boot, nov 2023
+#define FINE_STEP_MICROS   1000ULL           // while a request or a reply is on the way
+#define COARSE_STEP_MICROS 1000000ULL
+
+// One NTP server per loopback address, all on the same port. Replies leave after delay_ms of simulated
+// time, the server clock runs clock_offset_ms ahead of the reference.
+struct Responder
+{
+    const char* address;
+    uint32_t delay_ms;
+    int32_t clock_offset_ms;
+    bool silent;
+    uint32_t requests;
+    int socket;
+};
+
+struct QueuedReply
+{
+    uint8_t responder;
+    uint64_t due_micros;
+    struct sockaddr_in client;
+    uint8_t packet[NTP_PACKET_SIZE];
+};
+
+static Responder responders[RESPONDER_COUNT] =
+{
+    { "127.0.0.1", 80, 0,   false, 0, -1 },
+    { "127.0.0.2", 20, 0,   false, 0, -1 },
+    { "127.0.0.3", 40, 300, false, 0, -1 },
+};
+static std::vector<QueuedReply> queued_replies;
+static uint64_t busy_until_micros = 0;
+static bool answer_dns = true;
+
+static uint64_t ReferenceMillis(int32_t clock_offset_ms)
+{
+    return REFERENCE_BASE_MS + HostGetMicros() / 1000 + clock_offset_ms;
+}
+
+static void WriteTimestamp(uint8_t* timestamp, uint64_t unix_millis)
+{
+    uint32_t seconds = (uint32_t)(unix_millis / 1000 + NTP_UNIX_OFFSET);
+    uint32_t fraction = (uint32_t)((((unix_millis % 1000) << 32) + 999) / 1000);  // rounded up, reads back as the same millisecond
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        timestamp[i]     = seconds >> (24 - 8 * i);
+        timestamp[i + 4] = fraction >> (24 - 8 * i);
+    }
+}
+
+static bool OpenResponders()
+{
+    uint16_t port = 0;
+    for (uint8_t idx = 0; idx < RESPONDER_COUNT; idx++)
+    {
+        Responder& responder = responders[idx];
+        responder.socket = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in local;
+        memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_port = htons(port);
+        inet_aton(responder.address, &local.sin_addr);
+        socklen_t length = sizeof(local);
+        if (responder.socket < 0 || bind(responder.socket, (struct sockaddr*)&local, sizeof(local)) != 0
+            || getsockname(responder.socket, (struct sockaddr*)&local, &length) != 0)
+        {
+            return false;
+        }
+        port = ntohs(local.sin_port);
+    }
+    WiFiUDP::HostRemotePort = port;
+    return true;
+}
+
+// Takes the requests that arrived and sends the replies that are due
+static void StepResponders()
+{
+    for (uint8_t idx = 0; idx < RESPONDER_COUNT; idx++)
+    {
+        Responder& responder = responders[idx];
+        QueuedReply reply;
+        socklen_t length = sizeof(reply.client);
+        uint8_t request[NTP_PACKET_SIZE];
+        while (recvfrom(responder.socket, request, sizeof(request), MSG_DONTWAIT, (struct sockaddr*)&reply.client, &length) == NTP_PACKET_SIZE)
+        {
+            responder.requests++;
+            if (responder.silent)
+            {
+                busy_until_micros = HostGetMicros() + (NTP_REPLY_TIMEOUT_MS + 10) * 1000ULL;
+                continue;
+            }
+            // the server sees the request half way through the round trip
+            memset(reply.packet, 0, sizeof(reply.packet));
+            reply.packet[0] = 0x24;  // LI 0, version 4, mode 4 (server)
+            reply.packet[1] = 2;     // stratum
+            memcpy(reply.packet + 24, request + 40, 8);
+            WriteTimestamp(reply.packet + 32, ReferenceMillis(responder.clock_offset_ms) + responder.delay_ms / 2);
+            WriteTimestamp(reply.packet + 40, ReferenceMillis(responder.clock_offset_ms) + responder.delay_ms / 2);
+            reply.responder = idx;
+            reply.due_micros = HostGetMicros() + responder.delay_ms * 1000ULL;
+            queued_replies.push_back(reply);
+            busy_until_micros = max(busy_until_micros, (uint64_t)(reply.due_micros + FINE_STEP_MICROS));
+        }
+    }
+    for (size_t idx = 0; idx < queued_replies.size();)
+    {
+        QueuedReply& reply = queued_replies[idx];
+        if (reply.due_micros > HostGetMicros())
+        {
+            idx++;
+            continue;
+        }
+        sendto(responders[reply.responder].socket, reply.packet, sizeof(reply.packet), 0, (struct sockaddr*)&reply.client, sizeof(reply.client));
+        queued_replies.erase(queued_replies.begin() + idx);
+    }
+}
+
+// The main loop of the winder, only what the pool needs
+static void Run(uint64_t millis)
+{
+    uint64_t until = HostGetMicros() + millis * 1000ULL;
+    while (HostGetMicros() < until)
+    {
+        NtpServers.Step();
+        StepResponders();
+        if (answer_dns)
+        {
+            HostRunLwip();
+        }
+        HostAdvanceMicros(HostGetMicros() < busy_until_micros ? FINE_STEP_MICROS : COARSE_STEP_MICROS);
+    }
+}
+
+static void StartPool(const char* first, const char* second, const char* third)
+{
+    NTP.setNTPServer((char*)first, 0);
+    NTP.setNTPServer((char*)second, 1);
+    NTP.setNTPServer((char*)third, 2);
+    SystemClock = ClockDiscipline();
+    NtpServers.Begin();
+    for (uint8_t idx = 0; idx < RESPONDER_COUNT; idx++)
+    {
+        responders[idx].requests = 0;
+    }
+}
+
+// Every server is measured once before the fastest one is preferred
+static void TestOffsetAndRoundTrip()
+{
+    StartPool("127.0.0.1", "127.0.0.2", "127.0.0.3");
+    Run(15 * 60 * 1000);
+
+    CHECK(SystemClock.IsSet());
+    CHECK_EQUAL(3, NtpServers.GetServerCount());
+    for (uint8_t idx = 0; idx < RESPONDER_COUNT; idx++)
+    {
+        const NtpServerStats& server = NtpServers.GetServer(idx);
+        CHECK(responders[idx].requests >= 1);
+        CHECK(server.rtt_ms >= responders[idx].delay_ms && server.rtt_ms <= responders[idx].delay_ms + 2);
+        CHECK_EQUAL(0, server.failures);
+    }
+    // the first reply sets the clock, the others measure against it
+    CHECK(abs(NtpServers.GetServer(1).offset_ms) <= 2);
+    CHECK(abs(NtpServers.GetServer(2).offset_ms - 300) <= 2);
+    CHECK_EQUAL(1, NtpServers.GetPreferredServer());
+
+    uint32_t requests[RESPONDER_COUNT];
+    for (uint8_t idx = 0; idx < RESPONDER_COUNT; idx++)
+    {
+        requests[idx] = responders[idx].requests;
+    }
+    Run(2 * 3600 * 1000);
+    CHECK_EQUAL(requests[0], responders[0].requests);
+    CHECK(responders[1].requests > requests[1]);
+    CHECK_EQUAL(requests[2], responders[2].requests);
+    CHECK(NtpServers.GetLastSync() > 0);
+    CHECK(llabs((int64_t)(SystemClock.NowMillis() - ReferenceMillis(0))) <= 300);
+}
+
+// A silent server backs off, doubling the delay up to NTP_MAX_BACKOFF, and the next one takes over
+static void TestBackoff()
+{
+    responders[1].silent = true;
+    uint32_t fallback_requests = responders[2].requests;
+    uint32_t backoff_ms[12];
+    uint8_t failures = 0;
+    uint64_t until = HostGetMicros() + 7 * 24 * 3600 * 1000000ULL;
+    while (failures < 12 && HostGetMicros() < until)
+    {
+        Run(1000);
+        const NtpServerStats& server = NtpServers.GetServer(1);
+        if (server.failures > failures)
+        {
+            failures = server.failures;
+            backoff_ms[failures - 1] = server.retry_after_millis - millis();
+        }
+    }
+    CHECK_EQUAL(12, failures);
+    uint32_t expected = NTP_SHORT_INTERVAL * 1000UL;
+    for (uint8_t idx = 0; idx < failures; idx++)
+    {
+        CHECK(backoff_ms[idx] <= expected && backoff_ms[idx] + 1100 >= expected);
+        expected = min(expected * 2, (uint32_t)(NTP_MAX_BACKOFF * 1000UL));
+    }
+    CHECK(responders[2].requests > fallback_requests);
+    CHECK_EQUAL(0, NtpServers.GetServer(2).failures);
+
+    // polls are up to CLOCK_MAX_POLL_INTERVAL apart by now
+    responders[1].silent = false;
+    Run((CLOCK_MAX_POLL_INTERVAL + NTP_MAX_BACKOFF) * 1000ULL);
+    CHECK_EQUAL(0, NtpServers.GetServer(1).failures);
+    CHECK_EQUAL(1, NtpServers.GetPreferredServer());
+}
+
+// Names are resolved in the background, Step() never waits for the answer
+static void TestResolve()
+{
+    HostAddDnsEntry("ntp-b.test", "127.0.0.2");
+    answer_dns = false;
+    StartPool("ntp-unknown.test", "ntp-b.test", "127.0.0.3");
+
+    NtpServers.Step();
+    CHECK_EQUAL(NTP_RESOLVE_PENDING, NtpServers.GetServer(0).resolve_state);
+    Run(1000);
+    CHECK_EQUAL(0, responders[0].requests + responders[1].requests + responders[2].requests);
+
+    // an unknown name fails, the next server is resolved and asked
+    answer_dns = true;
+    Run(5000);
+    CHECK_EQUAL(1, NtpServers.GetServer(0).failures);
+    CHECK((uint32_t)NtpServers.GetServer(1).address == (uint32_t)IPAddress(127, 0, 0, 2));
+    CHECK_EQUAL(1, responders[1].requests);
+    CHECK(SystemClock.IsSet());
+
+    // a lookup that is never answered times out
+    answer_dns = false;
+    StartPool("ntp-b.test", "127.0.0.3", "");
+    Run(NTP_RESOLVE_TIMEOUT_MS - 1000);
+    CHECK_EQUAL(NTP_RESOLVE_PENDING, NtpServers.GetServer(0).resolve_state);
+    Run(5000);
+    CHECK_EQUAL(1, NtpServers.GetServer(0).failures);
+    CHECK_EQUAL(1, responders[2].requests);
+    answer_dns = true;
+    HostRunLwip();  // the late answer is ignored
+    CHECK_EQUAL(NTP_RESOLVE_IDLE, NtpServers.GetServer(0).resolve_state);
+    CHECK((uint32_t)NtpServers.GetServer(0).address == 0);
+}
+
+int main()
+{
+    HostSerialQuiet = true;
+    if (!OpenResponders())
+    {
+        printf("NtpServerPoolTest: no loopback sockets, skipped\n");
+        return 0;
+    }
+    NTP.init((char*)"127.0.0.1");
+    SystemClock.Begin();
+    Monotonic.Begin();
+
+    TestOffsetAndRoundTrip();
+    TestBackoff();
+    TestResolve();
+    return HostTestResult("NtpServerPoolTest");
+}
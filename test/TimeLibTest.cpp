@@ -0,0 +1,214 @@
+//
+//  TimeLibTest.cpp - breakTime(), makeTime() and now() against the loops they replaced.
+//  License: MIT
+//
+
+#include <Arduino.h>
+#include <HostClock.h>
+#include <HostTest.h>
+
+#include "TimeLib.h"
+
+#define LAST_DAY 49710UL  // 7 feb 2106, the last day an unsigned 32-bit time_t reaches
+#define NOW_REPETITIONS 20
+
+// The year and month loops of Time.cpp before the constant time conversion, kept as the reference
+#define LEAP_YEAR(Y)     ( ((1970+(Y))>0) && !((1970+(Y))%4) && ( ((1970+(Y))%100) || !((1970+(Y))%400) ) )
+
+static const uint8_t monthDays[] = {31,28,31,30,31,30,31,31,30,31,30,31};
+
+static void loopBreakTime(uint32_t time, tmElements_t &tm)
+{
+    uint8_t year;
+    uint8_t month, monthLength;
+    unsigned long days;
+
+    tm.Second = time % 60;
+    time /= 60;
+    tm.Minute = time % 60;
+    time /= 60;
+    tm.Hour = time % 24;
+    time /= 24;
+    tm.Wday = ((time + 4) % 7) + 1;
+
+    year = 0;
+    days = 0;
+    while ((unsigned)(days += (LEAP_YEAR(year) ? 366 : 365)) <= time) {
+        year++;
+    }
+    tm.Year = year;
+    days -= LEAP_YEAR(year) ? 366 : 365;
+    time -= days;
+
+    for (month = 0; month < 12; month++) {
+        if (month == 1) {
+            monthLength = LEAP_YEAR(year) ? 29 : 28;
+        } else {
+            monthLength = monthDays[month];
+        }
+        if (time >= monthLength) {
+            time -= monthLength;
+        } else {
+            break;
+        }
+    }
+    tm.Month = month + 1;
+    tm.Day = time + 1;
+}
+
+static uint32_t loopMakeTime(const tmElements_t &tm)
+{
+    int i;
+    uint32_t seconds;
+
+    seconds = tm.Year * (SECS_PER_DAY * 365);
+    for (i = 0; i < tm.Year; i++) {
+        if (LEAP_YEAR(i)) {
+            seconds += SECS_PER_DAY;
+        }
+    }
+    for (i = 1; i < tm.Month; i++) {
+        if ((i == 2) && LEAP_YEAR(tm.Year)) {
+            seconds += SECS_PER_DAY * 29;
+        } else {
+            seconds += SECS_PER_DAY * monthDays[i - 1];
+        }
+    }
+    seconds += (tm.Day - 1) * SECS_PER_DAY;
+    seconds += tm.Hour * SECS_PER_HOUR;
+    seconds += tm.Minute * SECS_PER_MIN;
+    seconds += tm.Second;
+    return seconds;
+}
+
+// now() before the single division, one loop pass per second since the previous call
+static uint32_t loopSysTime = 0;
+static uint32_t loopPrevMillis = 0;
+
+static time_t loopNow()
+{
+    while (millis() - loopPrevMillis >= 1000) {
+        loopSysTime++;
+        loopPrevMillis += 1000;
+    }
+    return (time_t)loopSysTime;
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "leap day of 2000");
+static_assert(daysFromCivil(2106, 2, 7) == LAST_DAY, "end of the 32-bit time_t");
+static_assert(yearFromDays(LAST_DAY) == 2106 && monthFromDays(LAST_DAY) == 2 && dayFromDays(LAST_DAY) == 7, "end of the 32-bit time_t");
+
+static bool SameElements(const tmElements_t& a, const tmElements_t& b)
+{
+    return a.Second == b.Second && a.Minute == b.Minute && a.Hour == b.Hour && a.Wday == b.Wday
+        && a.Day == b.Day && a.Month == b.Month && a.Year == b.Year;
+}
+
+// Every hour of every day, at a minute and second that move along, and the last second of the range
+static void TestAgainstLoops()
+{
+    long mismatches = 0;
+    for (uint32_t day = 0; day <= LAST_DAY; day++)
+    {
+        for (uint32_t hour = 0; hour < 24; hour++)
+        {
+            uint32_t time = day * SECS_PER_DAY + hour * SECS_PER_HOUR + (day * 7 + hour * 13) % SECS_PER_HOUR;
+            if (day == LAST_DAY && time > 0xFFFFFFFFUL - SECS_PER_HOUR)
+            {
+                time = 0xFFFFFFFFUL;
+            }
+            tmElements_t expected;
+            tmElements_t actual;
+            loopBreakTime(time, expected);
+            breakTime(time, actual);
+            if (!SameElements(expected, actual) || (uint32_t)makeTime(actual) != time || loopMakeTime(actual) != time)
+            {
+                if (mismatches++ < 10)
+                {
+                    fprintf(stderr, "mismatch at %u: %u-%u-%u\n", time, tmYearToCalendar(actual.Year), actual.Month, actual.Day);
+                }
+            }
+            if (time == 0xFFFFFFFFUL)
+            {
+                break;
+            }
+        }
+        if (daysFromCivil(yearFromDays(day), monthFromDays(day), dayFromDays(day)) != day)
+        {
+            mismatches++;
+        }
+    }
+    CHECK_EQUAL(0, mismatches);
+}
+
+// Time per call of both versions, the loops get slower the later the date
+static void BenchmarkConversions()
+{
+    const uint32_t step = 997;
+    volatile uint32_t sink = 0;
+    tmElements_t tm;
+    uint32_t calls = 0;
+
+    double start = HostSeconds();
+    for (uint32_t time = 0; time < 0xFFFFFFFFUL - step; time += step, calls++)
+    {
+        breakTime(time, tm);
+        sink += makeTime(tm);
+    }
+    double constant = HostSeconds() - start;
+
+    start = HostSeconds();
+    for (uint32_t time = 0; time < 0xFFFFFFFFUL - step; time += step)
+    {
+        loopBreakTime(time, tm);
+        sink += loopMakeTime(tm);
+    }
+    double loops = HostSeconds() - start;
+
+    (void)sink;
+    printf("breakTime() + makeTime(): %.1f ns, with the loops %.1f ns\n", constant * 1e9 / calls, loops * 1e9 / calls);
+}
+
+// Slowest now() after the loop did not call it for a while, e.g. while blocked in the configuration
+// portal. Up to the wrap around of millis() after 49.7 days.
+static void BenchmarkNowLatency()
+{
+    static const uint32_t kGapSeconds[] = { 1, 3600, 86400, 49 * 86400UL };
+    now();  // warm up, the first call would count the cache misses
+    loopNow();
+    for (uint32_t gap : kGapSeconds)
+    {
+        double worst = 0;
+        double worst_loop = 0;
+        for (int repetition = 0; repetition < NOW_REPETITIONS; repetition++)
+        {
+            HostSetMicros(repetition * 1234567ULL);
+            setTime(0);
+            loopSysTime = 0;
+            loopPrevMillis = millis();
+            HostAdvanceMicros(gap * 1000000ULL + 999000);
+
+            double start = HostSeconds();
+            time_t time = now();
+            double middle = HostSeconds();
+            time_t loop_time = loopNow();
+            double end = HostSeconds();
+
+            CHECK_EQUAL(gap, time);
+            CHECK_EQUAL(gap, loop_time);
+            worst = max(worst, middle - start);
+            worst_loop = max(worst_loop, end - middle);
+        }
+        printf("now() %u s after the previous call: worst %.0f ns, with the loop %.0f ns\n",
+               gap, worst * 1e9, worst_loop * 1e9);
+    }
+}
+
+int main()
+{
+    TestAgainstLoops();
+    BenchmarkConversions();
+    BenchmarkNowLatency();
+    return HostTestResult("TimeLibTest");
+}
@@ -0,0 +1,109 @@
+//
+//  WebRoutesTest.cpp - Every route has a slot of its own, and the hash switch against a list of String compares.
+//  License: MIT
+//
+
+#include <Arduino.h>
+#include <HostTest.h>
+
+#include "WebRoutes.h"
+
+#define ROUTE_PATH(path, handler) path,
+#define ROUTE_COUNT (sizeof(kRoutes) / sizeof(kRoutes[0]))
+#define BENCHMARK_ROUNDS 200000
+
+static const char* const kRoutes[] =
+{
+    WEB_ROUTES(ROUTE_PATH)
+    WEB_ROUTES_UNBUNDLED(ROUTE_PATH)
+};
+
+// HandleRequest() returning the slot of the route instead of calling its handler
+#define ROUTE_SLOT_CASE(path, handler)                                      \
+    case WebRouteSlot(Fnv1a(path, WEB_ROUTE_SEED)):                         \
+        if (hash == Fnv1a(path, WEB_ROUTE_SEED)) { return WebRouteSlot(hash); } \
+        break;
+
+static int DispatchSwitch(const String& uri)
+{
+    uint32_t hash = Fnv1a(uri.c_str(), WEB_ROUTE_SEED);
+    switch (WebRouteSlot(hash))
+    {
+        WEB_ROUTES(ROUTE_SLOT_CASE)
+        WEB_ROUTES_UNBUNDLED(ROUTE_SLOT_CASE)
+    }
+    return -1;
+}
+
+// Like the handler list of ESP8266WebServer, which the switch replaced: one String compare per route
+static int DispatchList(const String& uri, const std::vector<String>& routes)
+{
+    for (size_t idx = 0; idx < routes.size(); idx++)
+    {
+        if (routes[idx] == uri)
+        {
+            return (int)idx;
+        }
+    }
+    return -1;
+}
+
+// "/" and "/index.html" share a handler but still need slots of their own
+static void TestSlots()
+{
+    bool taken[WEB_ROUTE_SLOTS] = { false };
+    CHECK(ROUTE_COUNT <= WEB_ROUTE_SLOTS);
+    for (size_t idx = 0; idx < ROUTE_COUNT; idx++)
+    {
+        uint8_t slot = WebRouteSlot(Fnv1a(kRoutes[idx], WEB_ROUTE_SEED));
+        if (taken[slot])
+        {
+            fprintf(stderr, "%s shares slot %u, pick another WEB_ROUTE_SEED\n", kRoutes[idx], slot);
+        }
+        CHECK(!taken[slot]);
+        taken[slot] = true;
+        CHECK_EQUAL(slot, DispatchSwitch(kRoutes[idx]));
+    }
+    CHECK_EQUAL(-1, DispatchSwitch("/missing.html"));
+    CHECK_EQUAL(-1, DispatchSwitch(""));
+}
+
+static void BenchmarkDispatch()
+{
+    std::vector<String> uris(kRoutes, kRoutes + ROUTE_COUNT);
+    uris.push_back("/favicon.ico");  // the 404 a browser asks for on every page
+    std::vector<String> routes(kRoutes, kRoutes + ROUTE_COUNT);
+    volatile int sink = 0;
+
+    double start = HostSeconds();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        for (const String& uri : uris)
+        {
+            sink += DispatchSwitch(uri);
+        }
+    }
+    double hashed = HostSeconds() - start;
+
+    start = HostSeconds();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        for (const String& uri : uris)
+        {
+            sink += DispatchList(uri, routes);
+        }
+    }
+    double listed = HostSeconds() - start;
+
+    (void)sink;
+    double lookups = (double)BENCHMARK_ROUNDS * uris.size();
+    printf("%u routes, dispatch: %.1f ns with the switch, %.1f ns with the list\n",
+           (unsigned)ROUTE_COUNT, hashed * 1e9 / lookups, listed * 1e9 / lookups);
+}
+
+int main()
+{
+    TestSlots();
+    BenchmarkDispatch();
+    return HostTestResult("WebRoutesTest");
+}
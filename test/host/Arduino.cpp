@@ -0,0 +1,174 @@
+//
+//  Arduino.cpp - Host stand-in for the parts of the ESP8266 Arduino core used by the tested sources.
+//  License: MIT
+//
+
+#include <Arduino.h>
+#include <Ticker.h>
+
+#include "HostClock.h"
+
+HardwareSerial Serial;
+bool HostSerialQuiet = false;
+EspClass ESP;
+
+static uint64_t host_micros = 0;
+static Ticker* tickers = nullptr;
+
+uint64_t HostGetMicros()
+{
+    return host_micros;
+}
+
+void HostSetMicros(uint64_t micros)
+{
+    host_micros = micros;
+}
+
+void HostAdvanceMicros(uint64_t micros)
+{
+    uint64_t until = host_micros + micros;
+    for (Ticker* ticker = Ticker::FindDue(until); ticker != nullptr; ticker = Ticker::FindDue(until))
+    {
+        host_micros = max(host_micros, ticker->GetDueMicros());
+        ticker->Fire();
+    }
+    host_micros = until;
+}
+
+unsigned long millis()
+{
+    return (uint32_t)(host_micros / 1000);
+}
+
+unsigned long micros()
+{
+    return (uint32_t)host_micros;
+}
+
+void delay(unsigned long ms)
+{
+    HostAdvanceMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    HostAdvanceMicros(us);
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    (void)pin;
+    (void)value;
+}
+
+size_t Print::write(const uint8_t* data, size_t length)
+{
+    size_t written = 0;
+    while (length-- > 0)
+    {
+        written += write(*data++);
+    }
+    return written;
+}
+
+size_t Print::printf(const char* format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0)
+    {
+        return 0;
+    }
+    return write((const uint8_t*)buffer, min((size_t)length, sizeof(buffer) - 1));
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length)
+{
+    if (!HostSerialQuiet)
+    {
+        fwrite(data, 1, length, stdout);
+    }
+    return length;
+}
+
+// 80 MHz, derived from the simulated clock
+uint32_t EspClass::getCycleCount()
+{
+    return (uint32_t)(host_micros * 80);
+}
+
+Ticker::Ticker()
+    : next_(nullptr),
+      period_micros_(0),
+      due_micros_(0),
+      callback_(nullptr)
+{
+}
+
+Ticker::~Ticker()
+{
+    detach();
+}
+
+void Ticker::attach(float seconds, callback_t callback)
+{
+    detach();
+    period_micros_ = (uint64_t)(seconds * 1e6);
+    due_micros_ = host_micros + period_micros_;
+    callback_ = callback;
+    next_ = tickers;
+    tickers = this;
+}
+
+void Ticker::detach()
+{
+    for (Ticker** link = &tickers; *link != nullptr; link = &(*link)->next_)
+    {
+        if (*link == this)
+        {
+            *link = next_;
+            break;
+        }
+    }
+    next_ = nullptr;
+    callback_ = nullptr;
+}
+
+// The attached ticker due first, if it is due at or before until_micros
+Ticker* Ticker::FindDue(uint64_t until_micros)
+{
+    Ticker* due = nullptr;
+    for (Ticker* ticker = tickers; ticker != nullptr; ticker = ticker->next_)
+    {
+        if (ticker->due_micros_ <= until_micros && (due == nullptr || ticker->due_micros_ < due->due_micros_))
+        {
+            due = ticker;
+        }
+    }
+    return due;
+}
+
+void Ticker::Fire()
+{
+    due_micros_ += period_micros_;
+    callback_();
+}
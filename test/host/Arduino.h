@@ -0,0 +1,154 @@
+//
+//  Arduino.h - Host stand-in for the parts of the ESP8266 Arduino core used by the tested sources.
+//  License: MIT
+//
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define F(s) (s)
+
+#define HIGH   1
+#define LOW    0
+#define INPUT  0
+#define OUTPUT 1
+#define DEC    10
+#define HEX    16
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+inline uint8_t pgm_read_byte(const void* p) { return *(const uint8_t*)p; }
+inline uint16_t pgm_read_word(const void* p) { return *(const uint16_t*)p; }
+inline uint32_t pgm_read_dword(const void* p) { return *(const uint32_t*)p; }
+inline void* memcpy_P(void* dest, const void* src, size_t n) { return memcpy(dest, src, n); }
+inline int strcmp_P(const char* a, const char* b) { return strcmp(a, b); }
+inline int strncmp_P(const char* a, const char* b, size_t n) { return strncmp(a, b, n); }
+inline size_t strlen_P(const char* s) { return strlen(s); }
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// The clock is simulated, see HostClock.h. micros() and millis() wrap around like on the target.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+class String
+{
+public:
+    String(const char* text = "") : text_(text != nullptr ? text : "") {}
+    String(const std::string& text) : text_(text) {}
+    String(char c) : text_(1, c) {}
+    String(int value) : text_(std::to_string(value)) {}
+    String(unsigned int value) : text_(std::to_string(value)) {}
+    String(long value) : text_(std::to_string(value)) {}
+    String(unsigned long value) : text_(std::to_string(value)) {}
+
+    const char* c_str() const { return text_.c_str(); }
+    unsigned int length() const { return (unsigned int)text_.size(); }
+    bool reserve(unsigned int size) { text_.reserve(size); return true; }
+    long toInt() const { return strtol(text_.c_str(), nullptr, 10); }
+    char operator[](unsigned int idx) const { return idx < text_.size() ? text_[idx] : '\0'; }
+    String substring(unsigned int from) const { return from < text_.size() ? String(text_.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const { return from < to && from < text_.size() ? String(text_.substr(from, to - from)) : String(); }
+    bool concat(const char* data, unsigned int length) { text_.append(data, length); return true; }
+
+    String& operator+=(const String& other) { text_ += other.text_; return *this; }
+    String& operator+=(const char* other) { text_ += other; return *this; }
+    String& operator+=(char c) { text_ += c; return *this; }
+    friend String operator+(const String& a, const String& b) { return String(a.text_ + b.text_); }
+    bool operator==(const String& other) const { return text_ == other.text_; }
+    bool operator==(const char* other) const { return text_ == other; }
+    bool operator!=(const char* other) const { return text_ != other; }
+
+protected:
+    std::string text_;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t length);
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t println() { return write("\n"); }
+    template <typename T> size_t println(const T& value) { return print(value) + println(); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+};
+
+// Goes to stdout, or nowhere while HostSerialQuiet is set
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+extern bool HostSerialQuiet;
+
+// Flash access is served by FlashStandIn, the other members by Arduino.cpp
+class EspClass
+{
+public:
+    uint32_t getCycleCount();
+    uint32_t getFreeHeap() { return 40000; }
+    uint32_t getMaxFreeBlockSize() { return 30000; }
+    void restart() { abort(); }
+
+    bool flashEraseSector(uint32_t sector);
+    bool flashWrite(uint32_t offset, uint32_t* data, size_t size);
+    bool flashRead(uint32_t offset, uint32_t* data, size_t size);
+};
+
+extern EspClass ESP;
+
+#endif // #ifndef HOST_ARDUINO_H
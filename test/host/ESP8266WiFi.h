@@ -0,0 +1,19 @@
+//
+//  ESP8266WiFi.h - Host stand-in, the station is always connected.
+//  License: MIT
+//
+#ifndef HOST_ESP8266WIFI_H
+#define HOST_ESP8266WIFI_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+class ESP8266WiFiClass
+{
+public:
+    bool isConnected() { return true; }
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif // #ifndef HOST_ESP8266WIFI_H
@@ -0,0 +1,171 @@
+//
+//  FlashStandIn.cpp - File backed flash below SPIFFS behind ESP.flashRead/Write/EraseSector, with power cuts.
+//  License: MIT
+//
+
+#include "FlashStandIn.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Stands for the linker symbol, only its address is used
+extern "C" uint32_t _SPIFFS_start __attribute__((aligned(SPI_FLASH_SEC_SIZE)));
+uint32_t _SPIFFS_start;
+
+FlashStandIn HostFlash;
+
+FlashStandIn::FlashStandIn()
+    : file_(-1),
+      base_(0),
+      size_(0),
+      budget_(-1),
+      erase_count_(0)
+{
+}
+
+// A new file starts erased
+bool FlashStandIn::Open(const char* path, uint32_t size)
+{
+    Close();
+    file_ = open(path, O_RDWR | O_CREAT, 0644);
+    if (file_ < 0)
+    {
+        return false;
+    }
+    off_t length = lseek(file_, 0, SEEK_END);
+    if (length < (off_t)size)
+    {
+        uint8_t erased[SPI_FLASH_SEC_SIZE];
+        memset(erased, 0xFF, sizeof(erased));
+        for (off_t offset = length - length % SPI_FLASH_SEC_SIZE; offset < (off_t)size; offset += SPI_FLASH_SEC_SIZE)
+        {
+            if (pwrite(file_, erased, sizeof(erased), offset) != (ssize_t)sizeof(erased))
+            {
+                Close();
+                return false;
+            }
+        }
+    }
+    base_ = ((uint32_t)(uintptr_t)&_SPIFFS_start - 0x40200000UL) - size;
+    size_ = size;
+    budget_ = -1;
+    return true;
+}
+
+void FlashStandIn::Close()
+{
+    if (file_ >= 0)
+    {
+        close(file_);
+        file_ = -1;
+    }
+}
+
+void FlashStandIn::CutPowerAfter(long bytes)
+{
+    budget_ = bytes;
+}
+
+void FlashStandIn::KeepPower()
+{
+    budget_ = -1;
+}
+
+uint32_t FlashStandIn::GetBase()
+{
+    return base_;
+}
+
+uint32_t FlashStandIn::GetEraseCount()
+{
+    return erase_count_;
+}
+
+bool FlashStandIn::Read(uint32_t offset, void* data, size_t size)
+{
+    if (!Contains(offset, size))
+    {
+        return false;
+    }
+    return pread(file_, data, size, offset - base_) == (ssize_t)size;
+}
+
+bool FlashStandIn::Write(uint32_t offset, const void* data, size_t size)
+{
+    if (!Contains(offset, size))
+    {
+        return false;
+    }
+    for (size_t idx = 0; idx < size; idx++)
+    {
+        Spend();
+        uint8_t cell;
+        if (pread(file_, &cell, 1, offset - base_ + idx) != 1)
+        {
+            return false;
+        }
+        cell &= ((const uint8_t*)data)[idx];
+        if (pwrite(file_, &cell, 1, offset - base_ + idx) != 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FlashStandIn::EraseSector(uint32_t sector)
+{
+    uint32_t offset = sector * SPI_FLASH_SEC_SIZE;
+    if (!Contains(offset, SPI_FLASH_SEC_SIZE))
+    {
+        return false;
+    }
+    uint8_t erased[SPI_FLASH_SEC_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    erase_count_++;
+    if (budget_ == 0)
+    {
+        pwrite(file_, erased, SPI_FLASH_SEC_SIZE / 2, offset - base_);
+        throw FlashPowerCut();
+    }
+    Spend();
+    return pwrite(file_, erased, sizeof(erased), offset - base_) == (ssize_t)sizeof(erased);
+}
+
+// Addresses are 32 bit like on the target, the region may wrap around
+bool FlashStandIn::Contains(uint32_t offset, size_t size)
+{
+    if (file_ < 0 || offset % 4 != 0 || size % 4 != 0)
+    {
+        fprintf(stderr, "flash access at 0x%08x of %zu bytes is not aligned or flash is not open\n", offset, size);
+        abort();
+    }
+    return (uint32_t)(offset - base_) < size_ && size <= size_ - (uint32_t)(offset - base_);
+}
+
+void FlashStandIn::Spend()
+{
+    if (budget_ == 0)
+    {
+        throw FlashPowerCut();
+    }
+    if (budget_ > 0)
+    {
+        budget_--;
+    }
+}
+
+bool EspClass::flashEraseSector(uint32_t sector)
+{
+    return HostFlash.EraseSector(sector);
+}
+
+bool EspClass::flashWrite(uint32_t offset, uint32_t* data, size_t size)
+{
+    return HostFlash.Write(offset, data, size);
+}
+
+bool EspClass::flashRead(uint32_t offset, uint32_t* data, size_t size)
+{
+    return HostFlash.Read(offset, data, size);
+}
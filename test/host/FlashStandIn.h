@@ -0,0 +1,51 @@
+//
+//  FlashStandIn.h - File backed flash below SPIFFS behind ESP.flashRead/Write/EraseSector, with power cuts.
+//  License: MIT
+//
+#ifndef HOST_FLASHSTANDIN_H
+#define HOST_FLASHSTANDIN_H
+
+#include <Arduino.h>
+
+// Thrown out of the flash call that is hit by the power cut, the test then "reboots"
+struct FlashPowerCut
+{
+};
+
+// Covers the size bytes right below _SPIFFS_start, as seen by the target. Writes can only clear
+// bits and have to be 4 byte aligned, like on the SPI flash. The file keeps the content across
+// Close() and Open(), e.g. to remount a LogStore as after a reset.
+class FlashStandIn
+{
+public:
+    FlashStandIn();
+
+    bool Open(const char* path, uint32_t size);
+    void Close();
+
+    // The cut hits after bytes more written bytes, every sector erase counts as one. An interrupted
+    // write stops in the middle of the buffer, an interrupted erase leaves part of the sector erased.
+    void CutPowerAfter(long bytes);
+    void KeepPower();
+
+    uint32_t GetBase();
+    uint32_t GetEraseCount();
+
+    bool Read(uint32_t offset, void* data, size_t size);
+    bool Write(uint32_t offset, const void* data, size_t size);
+    bool EraseSector(uint32_t sector);
+
+private:
+    bool Contains(uint32_t offset, size_t size);
+    void Spend();
+
+    int file_;
+    uint32_t base_;
+    uint32_t size_;
+    long budget_;        // -1 while there is no power cut ahead
+    uint32_t erase_count_;
+};
+
+extern FlashStandIn HostFlash;
+
+#endif // #ifndef HOST_FLASHSTANDIN_H
@@ -0,0 +1,17 @@
+//
+//  HostClock.h - Simulated time of the host stand-ins, tests move it forward explicitly.
+//  License: MIT
+//
+#ifndef HOST_HOSTCLOCK_H
+#define HOST_HOSTCLOCK_H
+
+#include <stdint.h>
+
+// 64-bit microseconds since the simulated boot, micros() returns the low 32 bits
+uint64_t HostGetMicros();
+void HostSetMicros(uint64_t micros);
+
+// Moves the clock forward and runs every Ticker callback that falls due on the way, at its due time
+void HostAdvanceMicros(uint64_t micros);
+
+#endif // #ifndef HOST_HOSTCLOCK_H
@@ -0,0 +1,26 @@
+//
+//  HostTest.cpp - Minimal checks for the host tests, a failed check is reported and counted.
+//  License: MIT
+//
+
+#include "HostTest.h"
+
+int HostTestFailures = 0;
+
+int HostTestResult(const char* name)
+{
+    if (HostTestFailures > 0)
+    {
+        printf("%s: %d check(s) FAILED\n", name, HostTestFailures);
+        return 1;
+    }
+    printf("%s: passed\n", name);
+    return 0;
+}
+
+double HostSeconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
@@ -0,0 +1,41 @@
+//
+//  HostTest.h - Minimal checks for the host tests, a failed check is reported and counted.
+//  License: MIT
+//
+#ifndef HOST_HOSTTEST_H
+#define HOST_HOSTTEST_H
+
+#include <stdio.h>
+#include <time.h>
+
+extern int HostTestFailures;
+
+#define CHECK(condition)                                                              \
+    do                                                                                \
+    {                                                                                 \
+        if (!(condition))                                                             \
+        {                                                                             \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            HostTestFailures++;                                                       \
+        }                                                                             \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                                 \
+    do                                                                                \
+    {                                                                                 \
+        long long expected_value = (long long)(expected);                             \
+        long long actual_value = (long long)(actual);                                 \
+        if (expected_value != actual_value)                                           \
+        {                                                                             \
+            fprintf(stderr, "%s:%d: expected %s == %lld, got %lld\n", __FILE__, __LINE__, #actual, expected_value, actual_value); \
+            HostTestFailures++;                                                       \
+        }                                                                             \
+    } while (0)
+
+// Prints the result, the return value is the exit code of the test
+int HostTestResult(const char* name);
+
+// Wall clock of the host, for the benchmarks
+double HostSeconds();
+
+#endif // #ifndef HOST_HOSTTEST_H
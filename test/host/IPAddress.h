@@ -0,0 +1,25 @@
+//
+//  IPAddress.h - Host stand-in for IPv4 addresses, stored in network byte order like lwIP does.
+//  License: MIT
+//
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <stdint.h>
+#include <lwip/dns.h>
+
+class IPAddress
+{
+public:
+    IPAddress() : address_(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : address_((uint32_t)a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+    IPAddress(const ip_addr_t* address) : address_(address->addr) {}
+
+    operator uint32_t() const { return address_; }
+
+private:
+    uint32_t address_;
+};
+
+#endif // #ifndef HOST_IPADDRESS_H
@@ -0,0 +1,108 @@
+//
+//  Network.cpp - Host stand-ins for WiFi, the lwIP resolver and the SDK SNTP client.
+//  License: MIT
+//
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <lwip/dns.h>
+#include <sntp.h>
+
+#include <arpa/inet.h>
+#include <map>
+
+ESP8266WiFiClass WiFi;
+
+struct PendingLookup
+{
+    dns_found_callback found;
+    void* callback_arg;
+    std::string name;
+    bool resolved;
+    ip_addr_t address;
+};
+
+static std::vector<PendingLookup> pending_lookups;
+static std::map<std::string, uint32_t> dns_entries;
+
+void HostAddDnsEntry(const char* hostname, const char* address)
+{
+    struct in_addr numeric;
+    if (inet_aton(address, &numeric) != 0)
+    {
+        dns_entries[hostname] = numeric.s_addr;
+    }
+}
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg)
+{
+    struct in_addr numeric;
+    if (hostname == nullptr || hostname[0] == '\0')
+    {
+        return ERR_ARG;
+    }
+    if (inet_aton(hostname, &numeric) != 0)
+    {
+        addr->addr = numeric.s_addr;
+        return ERR_OK;
+    }
+
+    PendingLookup lookup;
+    lookup.found = found;
+    lookup.callback_arg = callback_arg;
+    lookup.name = hostname;
+    lookup.resolved = false;
+    lookup.address.addr = 0;
+    auto entry = dns_entries.find(hostname);
+    if (entry != dns_entries.end())
+    {
+        lookup.address.addr = entry->second;
+        lookup.resolved = true;
+    }
+    pending_lookups.push_back(lookup);
+    return ERR_INPROGRESS;
+}
+
+void HostRunLwip()
+{
+    std::vector<PendingLookup> lookups;
+    lookups.swap(pending_lookups);
+    for (auto& lookup : lookups)
+    {
+        lookup.found(lookup.name.c_str(), lookup.resolved ? &lookup.address : nullptr, lookup.callback_arg);
+    }
+}
+
+static char* sntp_servers[3];
+
+void sntp_init(void)
+{
+}
+
+void sntp_stop(void)
+{
+}
+
+void sntp_setservername(unsigned char idx, char* server)
+{
+    if (idx < 3)
+    {
+        sntp_servers[idx] = server;
+    }
+}
+
+char* sntp_getservername(unsigned char idx)
+{
+    return idx < 3 ? sntp_servers[idx] : nullptr;
+}
+
+bool sntp_set_timezone(signed char timezone)
+{
+    (void)timezone;
+    return true;
+}
+
+uint32_t sntp_get_current_timestamp(void)
+{
+    return 0;
+}
@@ -0,0 +1,33 @@
+//
+//  Ticker.h - Host stand-in for the Ticker library, callbacks run from HostAdvanceMicros().
+//  License: MIT
+//
+#ifndef HOST_TICKER_H
+#define HOST_TICKER_H
+
+#include <stdint.h>
+
+class Ticker
+{
+public:
+    typedef void (*callback_t)();
+
+    Ticker();
+    ~Ticker();
+
+    void attach(float seconds, callback_t callback);
+    void detach();
+
+    // used by HostAdvanceMicros()
+    static Ticker* FindDue(uint64_t until_micros);
+    void Fire();
+    uint64_t GetDueMicros() const { return due_micros_; }
+
+private:
+    Ticker* next_;
+    uint64_t period_micros_;
+    uint64_t due_micros_;
+    callback_t callback_;
+};
+
+#endif // #ifndef HOST_TICKER_H
@@ -0,0 +1,134 @@
+//
+//  WiFiUdp.cpp - Host stand-in for WiFiUDP on a non-blocking POSIX UDP socket.
+//  License: MIT
+//
+
+#include <WiFiUdp.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+uint16_t WiFiUDP::HostRemotePort = 0;
+
+WiFiUDP::WiFiUDP()
+    : socket_(-1),
+      send_port_(0),
+      send_length_(0),
+      receive_length_(0),
+      receive_position_(0)
+{
+}
+
+WiFiUDP::~WiFiUDP()
+{
+    stop();
+}
+
+// The local port is left to the host, the target port is only a convention of the sketch
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+    (void)port;
+    stop();
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_ < 0)
+    {
+        return 0;
+    }
+    fcntl(socket_, F_SETFL, fcntl(socket_, F_GETFL) | O_NONBLOCK);
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = 0;
+    if (bind(socket_, (struct sockaddr*)&local, sizeof(local)) != 0)
+    {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiUDP::stop()
+{
+    if (socket_ >= 0)
+    {
+        close(socket_);
+        socket_ = -1;
+    }
+}
+
+int WiFiUDP::beginPacket(IPAddress address, uint16_t port)
+{
+    send_address_ = address;
+    send_port_ = (HostRemotePort != 0) ? HostRemotePort : port;
+    send_length_ = 0;
+    return socket_ >= 0 ? 1 : 0;
+}
+
+int WiFiUDP::endPacket()
+{
+    struct sockaddr_in remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_addr.s_addr = (uint32_t)send_address_;
+    remote.sin_port = htons(send_port_);
+    ssize_t sent = sendto(socket_, send_buffer_, send_length_, 0, (struct sockaddr*)&remote, sizeof(remote));
+    return sent == (ssize_t)send_length_ ? 1 : 0;
+}
+
+size_t WiFiUDP::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t WiFiUDP::write(const uint8_t* data, size_t length)
+{
+    length = min(length, sizeof(send_buffer_) - send_length_);
+    memcpy(send_buffer_ + send_length_, data, length);
+    send_length_ += length;
+    return length;
+}
+
+// Like on the target every call drops what is left of the previous packet
+int WiFiUDP::parsePacket()
+{
+    receive_length_ = 0;
+    receive_position_ = 0;
+    if (socket_ < 0)
+    {
+        return 0;
+    }
+    ssize_t received = recv(socket_, receive_buffer_, sizeof(receive_buffer_), 0);
+    if (received <= 0)
+    {
+        return 0;
+    }
+    receive_length_ = (size_t)received;
+    return (int)receive_length_;
+}
+
+int WiFiUDP::available()
+{
+    return (int)(receive_length_ - receive_position_);
+}
+
+int WiFiUDP::read()
+{
+    return available() > 0 ? receive_buffer_[receive_position_++] : -1;
+}
+
+int WiFiUDP::read(uint8_t* data, size_t length)
+{
+    length = min(length, (size_t)available());
+    memcpy(data, receive_buffer_ + receive_position_, length);
+    receive_position_ += length;
+    return (int)length;
+}
+
+int WiFiUDP::peek()
+{
+    return available() > 0 ? receive_buffer_[receive_position_] : -1;
+}
@@ -0,0 +1,45 @@
+//
+//  WiFiUdp.h - Host stand-in for WiFiUDP on a non-blocking POSIX UDP socket.
+//  License: MIT
+//
+#ifndef HOST_WIFIUDP_H
+#define HOST_WIFIUDP_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+#define HOST_UDP_MAX_PACKET 1472
+
+class WiFiUDP : public Stream
+{
+public:
+    WiFiUDP();
+    ~WiFiUDP();
+
+    uint8_t begin(uint16_t port);
+    void stop();
+    int beginPacket(IPAddress address, uint16_t port);
+    int endPacket();
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    int parsePacket();
+    int available() override;
+    int read() override;
+    int read(uint8_t* data, size_t length);
+    int peek() override;
+
+    // The port the target uses is mapped to this one, so tests do not need privileges
+    static uint16_t HostRemotePort;
+
+private:
+    int socket_;
+    IPAddress send_address_;
+    uint16_t send_port_;
+    uint8_t send_buffer_[HOST_UDP_MAX_PACKET];
+    size_t send_length_;
+    uint8_t receive_buffer_[HOST_UDP_MAX_PACKET];
+    size_t receive_length_;
+    size_t receive_position_;
+};
+
+#endif // #ifndef HOST_WIFIUDP_H
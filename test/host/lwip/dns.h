@@ -0,0 +1,31 @@
+//
+//  lwip/dns.h - Host stand-in for the asynchronous lwIP resolver.
+//  License: MIT
+//
+#ifndef HOST_LWIP_DNS_H
+#define HOST_LWIP_DNS_H
+
+#include <stdint.h>
+
+#define LWIP_VERSION_MAJOR 2
+
+typedef int8_t err_t;
+#define ERR_OK          0
+#define ERR_INPROGRESS -5
+#define ERR_ARG        -16
+
+struct ip_addr_t
+{
+    uint32_t addr;   // network byte order
+};
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+// Dotted quads are answered at once. Names are looked up in the entries added by HostAddDnsEntry(),
+// never on the network. The answer, or the failure of an unknown name, reaches the callback only in
+// HostRunLwip(), like lwIP calls back later from its own context.
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
+void HostAddDnsEntry(const char* hostname, const char* address);
+void HostRunLwip();
+
+#endif // #ifndef HOST_LWIP_DNS_H
@@ -0,0 +1,26 @@
+//
+//  sntp.h - Host stand-in for the SDK SNTP client, it only keeps the server names.
+//  License: MIT
+//
+#ifndef HOST_SNTP_H
+#define HOST_SNTP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void sntp_init(void);
+void sntp_stop(void);
+void sntp_setservername(unsigned char idx, char* server);
+char* sntp_getservername(unsigned char idx);
+bool sntp_set_timezone(signed char timezone);
+uint32_t sntp_get_current_timestamp(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifndef HOST_SNTP_H